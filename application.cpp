@@ -1,10 +1,13 @@
 #include "application.h"
 
+#include <algorithm>
 #include <iostream>
+#include <iomanip>
+#include <sstream>
 #include <ctime>
 #include <thread>
+#include <vector>
 
-#include "random.h"
 #include "config.h"
 
 /*!
@@ -47,6 +50,19 @@ Application::Application(const Config& config)
     resetView();
     dragged = false;
     m_window.setFramerateLimit(config.getFrameRate());
+
+    if (config.getTelemetry())
+    {
+        m_telemetry = std::make_unique<Telemetry>();
+        if (!config.getTelemetryFile().empty() && !m_telemetry->openCsv(config.getTelemetryFile()))
+        {
+            std::cout << "Unable to create the telemetry file " << config.getTelemetryFile() << '\n';
+        }
+        if (!config.getFontFile().empty() && !(m_fontLoaded = m_font.loadFromFile(config.getFontFile())))
+        {
+            std::cout << "Unable to load the font " << config.getFontFile() << '\n';
+        }
+    }
 }
 
 void Application::run()
@@ -56,11 +72,27 @@ void Application::run()
 
     while (m_window.isOpen())
     {
-        input (deltaClock.restart().asSeconds());
-        m_automaton->update();
+        Telemetry* telemetry = m_telemetry.get();
+        {
+            Telemetry::Timer timer(telemetry, Telemetry::INPUT);
+            input (deltaClock.restart().asSeconds());
+        }
+        {
+            Telemetry::Timer timer(telemetry, Telemetry::UPDATE);
+            m_automaton->update();
+        }
 
         render  ();
-        pollEvents();
+        {
+            Telemetry::Timer timer(telemetry, Telemetry::EVENTS);
+            pollEvents();
+        }
+
+        if (telemetry)
+        {
+            telemetry->commit(Telemetry::FRAME);
+            telemetry->writeCsv();
+        }
     }
 }
 
@@ -84,6 +116,12 @@ void Application::pollEvents()
             case sf::Event::Closed:
                 m_window.close();
                 break;
+            case sf::Event::KeyPressed:
+                if (e.key.code == sf::Keyboard::F3)
+                {
+                    m_overlay = !m_overlay;
+                }
+                break;
             case sf::Event::MouseButtonPressed:
                 dragged = true;
                 break;
@@ -143,19 +181,122 @@ void Application::input(float dt)
 
 void Application::render()
 {
+    Telemetry* telemetry = m_telemetry.get();
     m_window.setView(m_view);
-    m_window.clear(m_pConfig->getBgColour());
+    {
+        Telemetry::Timer timer(telemetry, Telemetry::COLOURS);
+        m_automaton->prepare(m_window);
+    }
 
-    //Pixels
-    m_window.setView(m_view);
-    m_automaton->render(m_window);
+    {
+        Telemetry::Timer timer(telemetry, Telemetry::DRAW);
+        m_window.clear(m_pConfig->getBgColour());
 
-    //GUI
-    m_window.setView(m_window.getDefaultView());
+        //Pixels
+        m_window.setView(m_view);
+        m_automaton->render(m_window);
+
+        //GUI
+        m_window.setView(m_window.getDefaultView());
+        if (telemetry && m_overlay)
+        {
+            drawOverlay();
+        }
+    }
 
+    // Not timed: waits for the frame rate limit
     m_window.display();
 }
 
+void Application::drawOverlay()
+{
+    static const unsigned FRAMES        = 120;      // number of bars
+    static const float BAR_WIDTH        = 3;        // width of a bar (pixels)
+    static const float PERIOD_HEIGHT    = 100;      // height of a bar lasting a frame period (pixels)
+    static const sf::Color COLOURS[Telemetry::STEP] =
+    {
+        sf::Color(230, 200, 40),                    // input
+        sf::Color(40, 200, 230),                    // update
+        sf::Color(230, 60, 60),                     // colours
+        sf::Color(60, 220, 80),                     // draw
+        sf::Color(200, 80, 230)                     // events
+    };
+
+    std::vector<Telemetry::Sample>& samples = m_overlaySamples;
+    samples.resize(Telemetry::CAPACITY);
+    const float period  = m_pConfig->getFrameRate() ? 1e9f / m_pConfig->getFrameRate() : 1e9f / 60;
+    const float scale   = PERIOD_HEIGHT / period;
+    const sf::Vector2f size = m_window.getDefaultView().getSize();
+    const sf::Vector2f origin(8, size.y - 8);       // bottom left corner of the bars
+
+    std::vector<sf::Vertex>& quads = m_overlayQuads;
+    quads.clear();
+    auto addQuad = [&quads](const float p_left, const float p_top, const float p_width, const float p_height, const sf::Color& p_colour)
+    {
+        const sf::Vector2f corners[4] = { { p_left, p_top }, { p_left + p_width, p_top },
+                                          { p_left + p_width, p_top + p_height }, { p_left, p_top + p_height } };
+        for (const sf::Vector2f& corner : corners)
+        {
+            sf::Vertex vertex;
+            vertex.position = corner;
+            vertex.color    = p_colour;
+            quads.push_back(vertex);
+        }
+    };
+
+    // Background, then a bar per frame with its phases stacked, and the frame period
+    addQuad(origin.x - 4, origin.y - 2 * PERIOD_HEIGHT - 4, FRAMES * BAR_WIDTH + 8, 2 * PERIOD_HEIGHT + 8, sf::Color(0, 0, 0, 160));
+
+    const unsigned frames = m_telemetry->getLatest(Telemetry::FRAME, samples.data(), FRAMES);
+    double totals[Telemetry::PHASE_COUNT] = {};
+    for (unsigned i = 0; i < frames; ++i)
+    {
+        float top = origin.y;
+        for (unsigned phase = 0; phase < Telemetry::STEP; ++phase)
+        {
+            totals[phase] += samples[i].nanos[phase];
+            const float height = std::min(samples[i].nanos[phase] * scale, top - (origin.y - 2 * PERIOD_HEIGHT));
+            top -= height;
+            addQuad(origin.x + (FRAMES - frames + i) * BAR_WIDTH, top, BAR_WIDTH - 1, height, COLOURS[phase]);
+        }
+    }
+    addQuad(origin.x, origin.y - PERIOD_HEIGHT, FRAMES * BAR_WIDTH, 1, sf::Color::White);
+    m_window.draw(quads.data(), quads.size(), sf::Quads);
+
+    if (!m_fontLoaded)
+        return;
+
+    // Average of each phase over the bars, and over the latest generations
+    const unsigned generations = m_telemetry->getLatest(Telemetry::GENERATION, samples.data(), Telemetry::CAPACITY);
+    for (unsigned i = 0; i < generations; ++i)
+    {
+        for (unsigned phase = Telemetry::STEP; phase < Telemetry::PHASE_COUNT; ++phase)
+        {
+            totals[phase] += samples[i].nanos[phase];
+        }
+    }
+
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(2);
+    for (unsigned phase = 0; phase < Telemetry::PHASE_COUNT; ++phase)
+    {
+        const unsigned count = Telemetry::getChannel((Telemetry::Phase)phase) == Telemetry::FRAME ? frames : generations;
+        text << Telemetry::getPhaseName((Telemetry::Phase)phase) << ": "
+             << (count ? totals[phase] / count / 1e6 : 0.) << " ms\n";
+    }
+    text << "frames: " << m_telemetry->getCount(Telemetry::FRAME)
+         << ", generations: " << m_telemetry->getCount(Telemetry::GENERATION) << '\n'
+         << "dropped (CSV): " << m_telemetry->getDropped() << '\n';
+
+    sf::Text label;
+    label.setFont(m_font);
+    label.setString(text.str());
+    label.setCharacterSize(12);
+    label.setFillColor(sf::Color::White);
+    label.setPosition(origin.x + FRAMES * BAR_WIDTH + 12, origin.y - 2 * PERIOD_HEIGHT - 4);
+    m_window.draw(label);
+}
+
 void Application::resetView()
 {
     m_view = sf::View();
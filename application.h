@@ -7,6 +7,7 @@
 #include <SFML/Window/Event.hpp>
 #include <array>
 #include "CellAutomaton.h"
+#include "telemetry.h"
 
 /*!
  * \file application.h
@@ -62,26 +63,53 @@ class Application
     public:
         Application(const Config& config);
 
+        /*!
+         * \function init
+         * \brief Creates the cellular automaton, computed by an engine of type \a T.
+         */
         template<typename T>
         void init()
         {
-            m_automaton = std::make_unique<T>(*m_pConfig, *this);
+            m_automaton = std::make_unique<CellAutomaton>(*m_pConfig, *this, std::make_unique<T>(*m_pConfig));
+        }
+
+        /*!
+         * \function init
+         * \brief Creates the cellular automaton, computed by the given engine.
+         * \param p_engine the engine (see \a Engine::create)
+         */
+        void init(std::unique_ptr<Engine> p_engine)
+        {
+            m_automaton = std::make_unique<CellAutomaton>(*m_pConfig, *this, std::move(p_engine));
         }
 
         void run();
 
         const sf::RenderWindow& getWindow() const;
 
+        /*!
+         * Get the telemetry of the frames and of the generations (nullptr if disabled)
+         */
+        Telemetry* getTelemetry() const { return m_telemetry.get(); }
+
     private:
         void pollEvents();
         void input  (float dt);
         void render ();
 
+        /*!
+         * \function drawOverlay
+         * \brief Draws the durations of the phases of the latest frames, stacked in a bar per frame,
+         * and their averages if a font is loaded.
+         */
+        void drawOverlay();
+
         /*!
          * Resets the view to initial state (center, no zoom)
          */
         void resetView();
 
+        std::unique_ptr<Telemetry> m_telemetry;     /*!< Telemetry (destroyed after the automaton timing its generations) */
         std::unique_ptr<CellAutomaton> m_automaton; /*!< Cellular automaton */
         const Config* m_pConfig = nullptr;          /*!< Configuration of the simulation */
         sf::RenderWindow m_window;                  /*!< Simulation window */
@@ -89,6 +117,11 @@ class Application
         sf::View         m_view;                    /*!< Simulation view */
         bool dragged;                               /*!< true if mouse currently dragged */
         float m_zoom = 1;                           /*!< zoom factor */
+        bool m_overlay = true;                      /*!< true if the telemetry overlay is drawn */
+        sf::Font m_font;                            /*!< Font of the overlay texts */
+        bool m_fontLoaded = false;                  /*!< true if \a m_font was loaded */
+        std::vector<Telemetry::Sample> m_overlaySamples;    /*!< samples drawn by the overlay, allocated once */
+        std::vector<sf::Vertex> m_overlayQuads;     /*!< quads of the overlay, allocated once */
 
 };
 
@@ -0,0 +1,410 @@
+#include "simConfig.h"
+#include "engine.h"
+#include "counterRandom.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/*!
+ * \file bench.cpp
+ * \brief main file of the benchmark suite.
+ * Times every engine on fixed workloads (random soups of several densities, R-pentomino, fields
+ * of Gosper glider guns and empty grids) and grid sizes, and writes the results as JSON.
+ * Each case runs in its own process, so that its peak memory is measured alone and a case
+ * running out of memory does not stop the suite.
+ * Usage: <em> bench [-e engines] [-w workloads] [-g sizes] [-n generations] [-t threads] [-a activeTiles] [-b temporalBlocking] [-r rule] [-s seed] [-o file] </em>
+ * where the lists are separated by commas, for instance <em> bench -e life,bit -g 256,1024 -t 1,0 </em>.
+ * Without \a -n, the number of generations depends on the size of the grid (see \a getGenerations).
+ * Build: the \a Bench target of the project, or with a plain Linux toolchain <em> g++ -std=c++14 -O2 -pthread -o bench bench.cpp
+ * engine.cpp lifeEngine.cpp lifeKernel.cpp bitEngine.cpp hashLife.cpp sparseEngine.cpp rule.cpp ruleKernel.cpp ruleEngine.cpp
+ * lookupEngine.cpp pattern.cpp simConfig.cpp threadPool.cpp </em> (the sources of the engines and of \a Engine::create).
+ * Linux only: the cases are run by \a fork and their peak memory read by \a getrusage.
+ * \author lhm
+ */
+
+#ifdef _WIN32
+
+int main()
+{
+    std::cout << "The benchmark suite runs each case in its own process: it runs on Linux only\n";
+    return 1;
+}
+
+#else
+
+namespace
+{
+    /*!
+     * Settings of one case of the suite
+     */
+    struct Case
+    {
+        std::string engine;
+        std::string workload;
+        unsigned size;
+        unsigned threads;
+        bool activeTiles;
+        unsigned temporalBlocking;
+        unsigned generations;
+    };
+
+    /*!
+     * Settings shared by every case
+     */
+    struct Suite
+    {
+        std::string rule = "B3/S23";
+        std::uint64_t seed = 1;
+    };
+
+    /*!
+     * Glider gun of Gosper (36 x 9 cells)
+     */
+    const char* const GOSPER_GUN[] =
+    {
+        "........................O...........",
+        "......................O.O...........",
+        "............OO......OO............OO",
+        "...........O...O....OO............OO",
+        "OO........O.....O...OO..............",
+        "OO........O...O.OO....O.O...........",
+        "..........O.....O.......O...........",
+        "...........O...O....................",
+        "............OO......................",
+    };
+
+    const unsigned GUN_SPACING = 64;                    /**< distance between two guns of a field */
+
+    void usage(const char* p_name)
+    {
+        std::cout << "Usage: " << p_name << " [-e engines] [-w workloads] [-g sizes] [-n generations] [-t threads]"
+                     " [-a activeTiles] [-b temporalBlocking] [-r rule] [-s seed] [-o file]\n"
+                     "Workloads: soup<percent> (soup10, soup25...), rpentomino, gosper, empty\n";
+    }
+
+    std::vector<std::string> split(const std::string& p_list)
+    {
+        std::vector<std::string> items;
+        std::istringstream in(p_list);
+        std::string item;
+        while (std::getline(in, item, ','))
+        {
+            if (!item.empty())
+                items.push_back(item);
+        }
+        return items;
+    }
+
+    std::vector<unsigned> splitNumbers(const std::string& p_list)
+    {
+        std::vector<unsigned> numbers;
+        for (auto& item : split(p_list))
+        {
+            numbers.push_back((unsigned)std::strtoul(item.c_str(), nullptr, 10));
+        }
+        return numbers;
+    }
+
+    /*!
+     * Number of generations of a grid: about 2^30 cells are computed, between 4 and 4096 generations
+     */
+    unsigned getGenerations(const unsigned p_size)
+    {
+        const double generations = (double)(1u << 30) / ((double)p_size * p_size);
+        return generations < 4 ? 4 : generations > 4096 ? 4096 : (unsigned)generations;
+    }
+
+    /*!
+     * Sets a cell of a bitmap laid out as \a Engine::getCells (ignores the cells outside of the grid)
+     */
+    void setAlive(std::vector<std::uint64_t>& p_bitmap, const unsigned p_size, const unsigned p_x, const unsigned p_y)
+    {
+        if (p_x < p_size && p_y < p_size)
+        {
+            const unsigned wordsPerRow = (p_size + 63) / 64;
+            p_bitmap[(std::size_t)p_y * wordsPerRow + p_x / 64] |= 1ULL << (p_x % 64);
+        }
+    }
+
+    /*!
+     * Builds the cells of a workload, or returns false if the workload is unknown
+     */
+    bool buildWorkload(const Case& p_case, const Suite& p_suite, std::vector<std::uint64_t>& p_bitmap)
+    {
+        const unsigned size = p_case.size;
+        p_bitmap.assign((std::size_t)(size + 63) / 64 * size, 0);
+
+        if (p_case.workload == "empty")
+            return true;
+
+        if (p_case.workload.compare(0, 4, "soup") == 0)
+        {
+            // The soup only depends on the seed: every engine computes the same cells
+            const unsigned percent = (unsigned)std::strtoul(p_case.workload.c_str() + 4, nullptr, 10);
+            const std::uint64_t key = CounterRandom::getKey(p_suite.seed, 0);
+            for (unsigned y = 0; y < size; ++y)
+            {
+                for (unsigned x = 0; x < size; ++x)
+                {
+                    if (CounterRandom::uniformInt(key, (std::uint64_t)y * size + x, 99) < percent)
+                        setAlive(p_bitmap, size, x, y);
+                }
+            }
+            return percent > 0 && percent <= 100;
+        }
+
+        if (p_case.workload == "rpentomino")
+        {
+            const unsigned c = size / 2;
+            setAlive(p_bitmap, size, c,     c - 1);
+            setAlive(p_bitmap, size, c + 1, c - 1);
+            setAlive(p_bitmap, size, c - 1, c);
+            setAlive(p_bitmap, size, c,     c);
+            setAlive(p_bitmap, size, c,     c + 1);
+            return true;
+        }
+
+        if (p_case.workload == "gosper")
+        {
+            for (unsigned y0 = 0; y0 < size; y0 += GUN_SPACING)
+            {
+                for (unsigned x0 = 0; x0 < size; x0 += GUN_SPACING)
+                {
+                    for (unsigned y = 0; y < sizeof(GOSPER_GUN) / sizeof(GOSPER_GUN[0]); ++y)
+                    {
+                        for (unsigned x = 0; GOSPER_GUN[y][x]; ++x)
+                        {
+                            if (GOSPER_GUN[y][x] == 'O')
+                                setAlive(p_bitmap, size, x0 + x, y0 + y);
+                        }
+                    }
+                }
+            }
+            return true;
+        }
+
+        return false;
+    }
+
+    /*!
+     * Writes the settings of a case as the first members of a JSON object
+     */
+    void writeCase(std::ostream& p_out, const Case& p_case)
+    {
+        p_out << "{\"engine\": \"" << p_case.engine << "\", \"workload\": \"" << p_case.workload
+              << "\", \"size\": " << p_case.size << ", \"threads\": " << p_case.threads
+              << ", \"activeTiles\": " << (p_case.activeTiles ? "true" : "false")
+              << ", \"temporalBlocking\": " << p_case.temporalBlocking
+              << ", \"generations\": " << p_case.generations;
+    }
+
+    /*!
+     * Runs a case, and writes its result as a JSON object
+     */
+    void runCase(const Case& p_case, const Suite& p_suite, std::ostream& p_out)
+    {
+        SimConfig conf(p_case.size, p_case.size);
+        conf.setEngine(p_case.engine);
+        conf.setRule(p_suite.rule);
+        conf.setSeed(p_suite.seed);
+        conf.setThreadCount(p_case.threads);
+        conf.setActiveTiles(p_case.activeTiles);
+        conf.setTemporalBlocking(p_case.temporalBlocking);
+        conf.setMiracleProb(0);
+
+        writeCase(p_out, p_case);
+
+        std::vector<std::uint64_t> cells;
+        if (!buildWorkload(p_case, p_suite, cells))
+        {
+            p_out << ", \"error\": \"unknown workload\"}";
+            return;
+        }
+        // No random cells are drawn before the workload: they would count in the peak memory
+        auto engine = Engine::create(conf, cells.data());
+        if (!engine)
+        {
+            p_out << ", \"error\": \"unknown engine\"}";
+            return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        engine->step(p_case.generations);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        // The population lets the engines be compared with each other
+        engine->getCells(cells.data());
+        std::uint64_t population = 0;
+        for (auto word : cells)
+        {
+            population += (std::uint64_t)__builtin_popcountll(word);
+        }
+
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+
+        const double seconds        = elapsed.count() > 0 ? elapsed.count() : 1e-9;
+        const double generations    = (double)p_case.generations;
+        const double cellsPerSecond = generations * p_case.size * p_case.size / seconds;
+        p_out << ", \"seconds\": " << elapsed.count()
+              << ", \"generationsPerSecond\": " << generations / seconds
+              << ", \"cellsPerSecond\": " << cellsPerSecond
+              << ", \"nsPerCell\": " << 1e9 / cellsPerSecond
+              << ", \"peakRssKiB\": " << usage.ru_maxrss
+              << ", \"population\": " << population << '}';
+    }
+
+    /*!
+     * Runs a case in a child process, and returns its result as a JSON object
+     */
+    std::string runProcess(const Case& p_case, const Suite& p_suite)
+    {
+        int fds[2];
+        if (pipe(fds) != 0)
+        {
+            std::ostringstream out;
+            writeCase(out, p_case);
+            out << ", \"error\": \"pipe failed\"}";
+            return out.str();
+        }
+
+        std::cout.flush();
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            // The messages of the engines must not be mixed with the results
+            close(fds[0]);
+            dup2(STDERR_FILENO, STDOUT_FILENO);
+
+            std::ostringstream out;
+            runCase(p_case, p_suite, out);
+            const std::string result = out.str();
+            ssize_t written = write(fds[1], result.data(), result.size());
+            close(fds[1]);
+            _exit(written == (ssize_t)result.size() ? 0 : 1);
+        }
+        close(fds[1]);
+
+        std::string result;
+        char buffer[4096];
+        ssize_t count;
+        while (pid > 0 && (count = read(fds[0], buffer, sizeof(buffer))) > 0)
+        {
+            result.append(buffer, (std::size_t)count);
+        }
+        close(fds[0]);
+
+        int status = 0;
+        if (pid < 0 || waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || result.empty())
+        {
+            std::ostringstream out;
+            writeCase(out, p_case);
+            if (pid > 0 && WIFSIGNALED(status))
+                out << ", \"error\": \"terminated by signal " << WTERMSIG(status) << "\"}";
+            else
+                out << ", \"error\": \"failed\"}";
+            return out.str();
+        }
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> engines    = { "life", "bit", "rule", "lookup", "hashlife", "sparse" };
+    std::vector<std::string> workloads  = { "soup10", "soup25", "soup50", "rpentomino", "gosper", "empty" };
+    std::vector<unsigned> sizes         = { 256, 1024, 4096, 16384 };
+    std::vector<unsigned> threads       = { 1 };
+    std::vector<unsigned> activeTiles   = { 1 };
+    std::vector<unsigned> blocking      = { 1 };
+    unsigned generations = 0;
+    const char* outFile = nullptr;
+    Suite suite;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (i + 1 < argc && !std::strcmp(argv[i], "-e"))
+            engines = split(argv[++i]);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-w"))
+            workloads = split(argv[++i]);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-g"))
+            sizes = splitNumbers(argv[++i]);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-n"))
+            generations = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-t"))
+            threads = splitNumbers(argv[++i]);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-a"))
+            activeTiles = splitNumbers(argv[++i]);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-b"))
+            blocking = splitNumbers(argv[++i]);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-r"))
+            suite.rule = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-s"))
+            suite.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-o"))
+            outFile = argv[++i];
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::ofstream file;
+    if (outFile)
+    {
+        file.open(outFile);
+        if (!file.is_open())
+        {
+            std::cout << "Unable to open " << outFile << '\n';
+            return 1;
+        }
+    }
+    std::ostream& out = outFile ? file : std::cout;
+
+    out << "{\n  \"rule\": \"" << suite.rule << "\",\n  \"seed\": " << suite.seed
+        << ",\n  \"hardwareThreads\": " << std::thread::hardware_concurrency() << ",\n  \"results\": [";
+
+    bool first = true;
+    for (auto size : sizes)
+    {
+        for (auto& workload : workloads)
+        {
+            for (auto& engine : engines)
+            {
+                for (auto threadCount : threads)
+                {
+                    for (auto tiles : activeTiles)
+                    {
+                        for (auto blocks : blocking)
+                        {
+                            Case c { engine, workload, size, threadCount, tiles != 0, blocks,
+                                     generations ? generations : getGenerations(size) };
+                            std::cerr << engine << ' ' << workload << ' ' << size << " x " << size << "...\n";
+
+                            out << (first ? "\n    " : ",\n    ") << runProcess(c, suite);
+                            out.flush();
+                            first = false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    out << "\n  ]\n}\n";
+}
+
+#endif // _WIN32
@@ -0,0 +1,334 @@
+#include "bitEngine.h"
+#include "simConfig.h"
+#include "bitKernel.h"
+#include <algorithm>
+
+/**
+ * \file bitEngine.cpp
+ * \brief Implementation of the functions defined in \a bitEngine.h
+ * \author lhm
+ */
+
+BitEngine::BitEngine(const SimConfig& p_config)
+    :   Engine          (p_config)
+    ,   m_wordsPerRow   ((p_config.getSimX() + 63) / 64)
+    ,   m_lastWordMask  (p_config.getSimX() % 64 ? (1ULL << (p_config.getSimX() % 64)) - 1 : ~0ULL)
+    ,   m_temporalBlocking (std::min(std::max(p_config.getTemporalBlocking(), 1u), (unsigned)MAX_BLOCKED_GENERATIONS))
+    ,   m_words         ((std::size_t)m_wordsPerRow * p_config.getSimY())
+    ,   m_next          (m_words.size())
+    ,   m_deadRow       (m_wordsPerRow)
+{
+}
+
+Cell BitEngine::getCell(const unsigned p_x, const unsigned p_y) const
+{
+    auto word = m_words[(std::size_t)p_y * m_wordsPerRow + p_x / 64];
+    return (word >> (p_x % 64)) & 1 ? Cell::ON : Cell::OFF;
+}
+
+void BitEngine::setCell(const unsigned p_x, const unsigned p_y, const Cell p_cell)
+{
+    auto& word = m_words[(std::size_t)p_y * m_wordsPerRow + p_x / 64];
+    auto  bit  = 1ULL << (p_x % 64);
+    word = p_cell == Cell::ON ? word | bit : word & ~bit;
+    markTileChanged(p_x, p_y);
+}
+
+void BitEngine::getRows(std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd) const
+{
+    // The cells are already stored as the bitmap
+    std::copy(m_words.begin() + (std::size_t)p_yBegin * m_wordsPerRow, m_words.begin() + (std::size_t)p_yEnd * m_wordsPerRow, p_bitmap);
+}
+
+void BitEngine::setRows(const std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd)
+{
+    // A word is a tile wide
+    for (unsigned y = p_yBegin; y < p_yEnd; ++y)
+    {
+        const std::uint64_t* words = p_bitmap + (std::size_t)(y - p_yBegin) * m_wordsPerRow;
+        std::uint64_t* row = &m_words[(std::size_t)y * m_wordsPerRow];
+        for (unsigned w = 0; w < m_wordsPerRow; ++w)
+        {
+            const std::uint64_t word = words[w] & (w + 1 == m_wordsPerRow ? m_lastWordMask : ~0ULL);
+            if (row[w] != word)
+            {
+                row[w] = word;
+                markTileChanged(w * 64, y);
+            }
+        }
+    }
+}
+
+void BitEngine::step(unsigned p_generations)
+{
+    // The miracles and the changes are drawn and tracked generation by generation
+    if (m_temporalBlocking < 2 || isTrackingChanges() || getMiracleProbability() > 0 || m_words.empty())
+    {
+        Engine::step(p_generations);
+        return;
+    }
+
+    const unsigned blocksX = (m_wordsPerRow + BLOCK_WORDS - 1) / BLOCK_WORDS;
+    const unsigned blocksY = (m_simY + BLOCK_ROWS - 1) / BLOCK_ROWS;
+    for (unsigned done = 0; done < p_generations; )
+    {
+        const unsigned generations = std::min(m_temporalBlocking, p_generations - done);
+        forEachBand(blocksY, [this, blocksX, generations](unsigned p_begin, unsigned p_end)
+        {
+            std::vector<std::uint64_t> block;
+            std::vector<std::uint64_t> next;
+            for (unsigned by = p_begin; by < p_end; ++by)
+            {
+                for (unsigned bx = 0; bx < blocksX; ++bx)
+                {
+                    updateBlock(by * BLOCK_ROWS, bx * BLOCK_WORDS, generations, block, next);
+                }
+            }
+        });
+        m_words.swap(m_next);
+        m_generation += generations;
+        done += generations;
+    }
+
+    // The activity of the tiles is unknown
+    markAllTilesChanged();
+}
+
+void BitEngine::update()
+{
+    if (m_words.empty())
+        return;
+
+    if (useActiveTiles())
+    {
+        forEachBand(getTilesY(), [this](unsigned p_begin, unsigned p_end)
+        {
+            updateTiles(p_begin, p_end);
+        });
+    }
+    else
+    {
+        forEachRows([this](unsigned p_begin, unsigned p_end)
+        {
+            for (unsigned y = p_begin; y < p_end; ++y)
+            {
+                updateWords(y, 0, m_wordsPerRow);
+            }
+        });
+    }
+    m_words.swap(m_next);
+}
+
+void BitEngine::updateTiles(const unsigned p_tyBegin, const unsigned p_tyEnd)
+{
+    static_assert(TILE_SIZE == 64, "A tile of the bit engine is one word wide");
+
+    for (unsigned ty = p_tyBegin; ty < p_tyEnd; ++ty)
+    {
+        if (!isTileRowActive(ty))
+            continue;
+
+        const unsigned yEnd = std::min((ty + 1) * TILE_SIZE, m_simY);
+        for (unsigned y = ty * TILE_SIZE; y < yEnd; ++y)
+        {
+            for (unsigned tx = 0; tx < m_wordsPerRow; ++tx)
+            {
+                if (isTileActive(tx, ty) && updateWords(y, tx, tx + 1))
+                {
+                    setTileChanged(tx, ty);
+                }
+            }
+        }
+    }
+}
+
+std::uint64_t BitEngine::updateEdgeWord(const std::uint64_t* p_above, const std::uint64_t* p_row, const std::uint64_t* p_below,
+                                        const unsigned p_w) const
+{
+    // Words around the word in each row, completed by the cells of the opposite edge
+    const unsigned lastWord = m_wordsPerRow - 1;
+    const unsigned lastBit  = (m_simX - 1) % 64;
+    const std::uint64_t* rows[3] = { p_above, p_row, p_below };
+    std::uint64_t words[3][3];
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        const std::uint64_t* row = rows[i];
+        words[i][0] = p_w > 0        ? row[p_w - 1] : 0;
+        words[i][1] = row[p_w];
+        words[i][2] = p_w < lastWord ? row[p_w + 1] : 0;
+
+        // The cell right of the last one is the first bit past it, in the last word or in the next one
+        if (p_w == 0)
+            words[i][0] |= ((row[lastWord] >> lastBit) & 1) << 63;
+        if (p_w == lastWord && lastBit < 63)
+            words[i][1] |= (row[0] & 1) << (lastBit + 1);
+        else if (p_w == lastWord)
+            words[i][2] |= row[0] & 1;
+    }
+
+    const std::uint64_t result = lifeWord(words[0][0], words[0][1], words[0][2],
+                                          words[1][0], words[1][1], words[1][2],
+                                          words[2][0], words[2][1], words[2][2]);
+    return result & (p_w == lastWord ? m_lastWordMask : ~0ULL);
+}
+
+std::uint64_t BitEngine::updateWords(const unsigned p_y, const unsigned p_wBegin, const unsigned p_wEnd)
+{
+    // The first and last rows are neighbours on a torus
+    const std::uint64_t* deadRow = m_deadRow.data();
+    const std::uint64_t* first = &m_words[0];
+    const std::uint64_t* last  = &m_words[(std::size_t)(m_simY - 1) * m_wordsPerRow];
+    const std::uint64_t* row   = &m_words[(std::size_t)p_y * m_wordsPerRow];
+    const std::uint64_t* above = p_y > 0          ? row - m_wordsPerRow : isToroidal() ? last  : deadRow;
+    const std::uint64_t* below = p_y + 1 < m_simY ? row + m_wordsPerRow : isToroidal() ? first : deadRow;
+    std::uint64_t*       next  = &m_next[(std::size_t)p_y * m_wordsPerRow];
+    std::uint64_t*       changes = m_trackChanges ? &m_changes[(std::size_t)p_y * m_wordsPerRow] : nullptr;
+
+    // The words past the edges of the rows are masked as dead cells
+    for (unsigned w = p_wBegin; w < p_wEnd; ++w)
+    {
+        const unsigned prev = w > 0                 ? w - 1 : w;
+        const unsigned succ = w + 1 < m_wordsPerRow ? w + 1 : w;
+        const std::uint64_t prevMask = w > 0                 ? ~0ULL : 0;
+        const std::uint64_t succMask = w + 1 < m_wordsPerRow ? ~0ULL : 0;
+        std::uint64_t result = lifeWord(above[prev] & prevMask, above[w], above[succ] & succMask,
+                                        row  [prev] & prevMask, row  [w], row  [succ] & succMask,
+                                        below[prev] & prevMask, below[w], below[succ] & succMask);
+        next[w] = result & (w + 1 == m_wordsPerRow ? m_lastWordMask : ~0ULL);
+    }
+
+    // On a torus, the edge words are computed again with the cells of the opposite edges
+    if (isToroidal())
+    {
+        if (p_wBegin == 0 && p_wEnd > 0)
+            next[0] = updateEdgeWord(above, row, below, 0);
+        if (p_wEnd == m_wordsPerRow && m_wordsPerRow > 1)
+            next[m_wordsPerRow - 1] = updateEdgeWord(above, row, below, m_wordsPerRow - 1);
+    }
+
+    // Dead cell not born from its neighbours: may get a miracle
+    forEachMiracle(p_y, p_wBegin * 64, std::min(p_wEnd * 64, m_simX), [row, next](unsigned p_x)
+    {
+        next[p_x / 64] |= ~row[p_x / 64] & (1ULL << (p_x % 64));
+    });
+
+    std::uint64_t changed = 0;
+    for (unsigned w = p_wBegin; w < p_wEnd; ++w)
+    {
+        changed |= next[w] ^ row[w];
+        if (changes)
+        {
+            changes[w] |= next[w] ^ row[w];
+        }
+    }
+    return changed;
+}
+
+void BitEngine::updateBlock(const unsigned p_y, const unsigned p_w, const unsigned p_generations,
+                            std::vector<std::uint64_t>& p_block, std::vector<std::uint64_t>& p_next)
+{
+    // The block is surrounded by p_generations rows and by one word on each side
+    const unsigned rows   = std::min((unsigned)BLOCK_ROWS, m_simY - p_y);
+    const unsigned words  = std::min((unsigned)BLOCK_WORDS, m_wordsPerRow - p_w);
+    const unsigned height = rows + 2 * p_generations;
+    const unsigned stride = words + 2;
+    p_block.resize((std::size_t)height * stride);
+    p_next.resize(p_block.size());
+
+    // Cells of the grid in each word of the rows of the block, kept dead outside of a dead boundary
+    std::uint64_t columnMasks[BLOCK_WORDS + 2];
+    for (unsigned lw = 0; lw < stride; ++lw)
+    {
+        const std::int64_t x = ((std::int64_t)p_w + lw - 1) * 64;
+        columnMasks[lw] = isToroidal() ? ~0ULL : x < 0 || x >= m_simX ? 0 : x + 64 > m_simX ? m_lastWordMask : ~0ULL;
+    }
+    auto isRowInGrid = [this, p_y, p_generations](unsigned p_ly)
+    {
+        const std::int64_t y = (std::int64_t)p_y + p_ly - p_generations;
+        return isToroidal() || (y >= 0 && y < m_simY);
+    };
+
+    for (unsigned ly = 0; ly < height; ++ly)
+    {
+        std::uint64_t* block = &p_block[(std::size_t)ly * stride];
+        const std::int64_t y = (std::int64_t)p_y + ly - p_generations;
+        if (!isRowInGrid(ly))
+        {
+            std::fill(block, block + stride, 0);
+            continue;
+        }
+
+        const std::uint64_t* row = &m_words[(std::size_t)((y % m_simY + m_simY) % m_simY) * m_wordsPerRow];
+        for (unsigned lw = 0; lw < stride; ++lw)
+        {
+            block[lw] = readCells(row, ((std::int64_t)p_w + lw - 1) * 64);
+        }
+    }
+
+    // Each generation loses the outer rows, and the outer cells of the side words, of the previous one
+    for (unsigned g = 1; g <= p_generations; ++g)
+    {
+        for (unsigned ly = g; ly < height - g; ++ly)
+        {
+            const std::uint64_t* above = &p_block[(std::size_t)(ly - 1) * stride];
+            const std::uint64_t* row   = above + stride;
+            const std::uint64_t* below = row + stride;
+            std::uint64_t*       next  = &p_next[(std::size_t)ly * stride];
+            if (!isRowInGrid(ly))
+            {
+                std::fill(next, next + stride, 0);
+                continue;
+            }
+
+            next[0] = lifeWord(0, above[0], above[1], 0, row[0], row[1], 0, below[0], below[1]) & columnMasks[0];
+            for (unsigned lw = 1; lw + 1 < stride; ++lw)
+            {
+                next[lw] = lifeWord(above[lw - 1], above[lw], above[lw + 1],
+                                    row  [lw - 1], row  [lw], row  [lw + 1],
+                                    below[lw - 1], below[lw], below[lw + 1]) & columnMasks[lw];
+            }
+            const unsigned last = stride - 1;
+            next[last] = lifeWord(above[last - 1], above[last], 0, row[last - 1], row[last], 0,
+                                  below[last - 1], below[last], 0) & columnMasks[last];
+        }
+        p_block.swap(p_next);
+    }
+
+    for (unsigned r = 0; r < rows; ++r)
+    {
+        const std::uint64_t* block = &p_block[(std::size_t)(r + p_generations) * stride + 1];
+        std::uint64_t*       next  = &m_next[(std::size_t)(p_y + r) * m_wordsPerRow + p_w];
+        std::copy(block, block + words, next);
+        if (p_w + words == m_wordsPerRow)
+            next[words - 1] &= m_lastWordMask;
+    }
+}
+
+std::uint64_t BitEngine::readCells(const std::uint64_t* p_row, const std::int64_t p_x) const
+{
+    // The words of the grid are aligned on the words of the row, otherwise the cells are read by runs within one word
+    if (p_x >= 0 && p_x % 64 == 0 && p_x + 64 <= m_simX)
+        return p_row[p_x / 64];
+
+    std::uint64_t cells = 0;
+    for (unsigned i = 0; i < 64; )
+    {
+        std::int64_t x = p_x + i;
+        if (isToroidal())
+            x = (x % m_simX + m_simX) % m_simX;
+        else if (x < 0)
+        {
+            i += (unsigned)std::min<std::int64_t>(64 - i, -x);
+            continue;
+        }
+        else if (x >= m_simX)
+            break;
+
+        const unsigned bit   = (unsigned)(x % 64);
+        const unsigned count = (unsigned)std::min<std::int64_t>(std::min(64 - i, 64 - bit), m_simX - x);
+        const std::uint64_t mask = count < 64 ? (1ULL << count) - 1 : ~0ULL;
+        cells |= ((p_row[x / 64] >> bit) & mask) << i;
+        i += count;
+    }
+    return cells;
+}
@@ -0,0 +1,127 @@
+#ifndef BITENGINE_H
+#define BITENGINE_H
+
+#include <cstdint>
+#include <vector>
+#include "engine.h"
+
+/**
+ * \file bitEngine.h
+ * \brief Definition of a "Game of life" engine packing 64 cells in each word.
+ * \author lhm
+ */
+
+/*!
+ * \class BitEngine
+ * \brief Engine storing one bit per cell and computing 64 cells at once.
+ * Each row of the grid is stored in \a m_wordsPerRow words, the cell of abscissa \a x
+ * being the bit <em> x % 64 </em> of the word <em> x / 64 </em> (1 meaning alive).
+ * The neighbours of a whole word are counted with bit-sliced adders, without any branch.
+ * The words past the edges of the rows are dead cells; on a torus, the first and last words of
+ * each row are computed again with the cells of the opposite edge.
+ * With temporal blocking (key <em>"temporalBlocking"</em> of the configuration), several generations
+ * of each block of the grid are computed while it is in the cache, from the block and a halo as wide
+ * as the number of generations: the grid only goes through the memory once every few generations.
+ */
+class BitEngine : public Engine
+{
+    public:
+        /*!
+         * \function BitEngine
+         * \brief Creates the engine, with dead cells (see \a Engine::create).
+         * \param p_config The configuration of the simulation.
+         */
+        explicit BitEngine(const SimConfig& p_config);
+
+        Cell getCell(const unsigned p_x, const unsigned p_y) const override;
+
+        void setCell(const unsigned p_x, const unsigned p_y, const Cell p_cell) override;
+
+        void getRows(std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd) const override;
+
+        void setRows(const std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd) override;
+
+        /*!
+         * \function step
+         * \brief Advances the simulation by the requested number of generations, by blocks of the grid
+         * if temporal blocking is enabled. The generations are the same as the ones of \a Engine::step.
+         * Temporal blocking is not used with miracles, nor when the changes are tracked (see \a Engine::getChanges).
+         * \param p_generations the number of generations to compute.
+         */
+        void step(unsigned p_generations = 1) override;
+
+    protected:
+        static const unsigned BLOCK_ROWS  = 128;        /**< rows of a block of the temporal blocking */
+        static const unsigned BLOCK_WORDS = 64;         /**< words of each row of a block of the temporal blocking */
+        static const unsigned MAX_BLOCKED_GENERATIONS = 64;    /**< generations computed at once: the halo of a block is one word wide */
+
+        /*!
+         * \function update
+         * \brief Computes the next generation into \a m_next, then swaps the buffers.
+         */
+        void update() override;
+
+        /*!
+         * \function updateWords
+         * \brief Computes the next generation of consecutive words of one row.
+         * \param p_y the ordinate of the row
+         * \param p_wBegin the first word to compute
+         * \param p_wEnd the past-the-end word to compute
+         * \return the cells of the computed words that changed.
+         */
+        std::uint64_t updateWords(const unsigned p_y, const unsigned p_wBegin, const unsigned p_wEnd);
+
+        /*!
+         * \function updateEdgeWord
+         * \brief Computes the next generation of the first or the last word of a row on a torus.
+         * \param p_above the row above (the last row for the first row)
+         * \param p_row the row
+         * \param p_below the row below (the first row for the last row)
+         * \param p_w the word, 0 or <em> m_wordsPerRow - 1 </em>
+         * \return the next generation of the word.
+         */
+        std::uint64_t updateEdgeWord(const std::uint64_t* p_above, const std::uint64_t* p_row, const std::uint64_t* p_below,
+                                     const unsigned p_w) const;
+
+        /*!
+         * \function updateTiles
+         * \brief Computes the next generation of the active tiles of a band of rows of tiles.
+         * As \a TILE_SIZE is 64, a tile is one word wide.
+         * \param p_tyBegin the first row of tiles of the band
+         * \param p_tyEnd the past-the-end row of tiles of the band
+         */
+        void updateTiles(const unsigned p_tyBegin, const unsigned p_tyEnd);
+
+        /*!
+         * \function updateBlock
+         * \brief Computes several generations of a block of the grid into \a m_next.
+         * The block and its halo are copied into \a p_block, where the generations are computed:
+         * each generation computes one row and one cell less on each side than the previous one.
+         * \param p_y the first row of the block
+         * \param p_w the first word of each row of the block
+         * \param p_generations the number of generations to compute, at most \a MAX_BLOCKED_GENERATIONS
+         * \param p_block buffer of the block
+         * \param p_next buffer of the next generation of the block
+         */
+        void updateBlock(const unsigned p_y, const unsigned p_w, const unsigned p_generations,
+                         std::vector<std::uint64_t>& p_block, std::vector<std::uint64_t>& p_next);
+
+        /*!
+         * \function readCells
+         * \brief Returns the 64 cells of a row from an abscissa, that may be outside of the grid:
+         * the cells outside are dead, or the cells of the opposite edge on a torus.
+         * \param p_row the row
+         * \param p_x the abscissa of the first cell
+         */
+        std::uint64_t readCells(const std::uint64_t* p_row, const std::int64_t p_x) const;
+
+    private:
+        const unsigned m_wordsPerRow;                   /**< number of words in a row */
+        const std::uint64_t m_lastWordMask;             /**< valid cells of the last word of a row */
+        const unsigned m_temporalBlocking;              /**< generations computed on each block at once (1 for none) */
+        std::vector<std::uint64_t> m_words;             /**< current generation */
+        std::vector<std::uint64_t> m_next;              /**< next generation */
+        std::vector<std::uint64_t> m_deadRow;           /**< row of dead cells, neighbour of the first and last rows */
+};
+
+#endif // BITENGINE_H
@@ -0,0 +1,62 @@
+#ifndef BITKERNEL_H
+#define BITKERNEL_H
+
+#include <cstdint>
+
+/**
+ * \file bitKernel.h
+ * \brief Word kernel of the "Game of life" for grids storing one bit per cell.
+ * A word holds 64 consecutive cells of a row, the cell of abscissa \a x being its bit
+ * <em> x % 64 </em> (1 meaning alive).
+ * \author lhm
+ */
+
+/*!
+ * \function lifeWord
+ * \brief Computes the next generation of the 64 cells of a word with bit-sliced adders.
+ * The words of the three rows are shifted west and east with the bits of their neighbour
+ * words, then the eight neighbours are summed without any branch.
+ * \param p_nw the word left of the word above
+ * \param p_n the word above
+ * \param p_ne the word right of the word above
+ * \param p_w the word left of the word
+ * \param p_c the word to compute
+ * \param p_e the word right of the word
+ * \param p_sw the word left of the word below
+ * \param p_s the word below
+ * \param p_se the word right of the word below
+ * \return the next generation of the word.
+ */
+inline std::uint64_t lifeWord(std::uint64_t p_nw, std::uint64_t p_n, std::uint64_t p_ne,
+                              std::uint64_t p_w,  std::uint64_t p_c, std::uint64_t p_e,
+                              std::uint64_t p_sw, std::uint64_t p_s, std::uint64_t p_se)
+{
+    std::uint64_t aW = (p_n << 1) | (p_nw >> 63);
+    std::uint64_t aE = (p_n >> 1) | (p_ne << 63);
+    std::uint64_t rW = (p_c << 1) | (p_w  >> 63);
+    std::uint64_t rE = (p_c >> 1) | (p_e  << 63);
+    std::uint64_t bW = (p_s << 1) | (p_sw >> 63);
+    std::uint64_t bE = (p_s >> 1) | (p_se << 63);
+
+    // Count of each row as a 2 bits number (ones, twos), the centre cell excluded
+    std::uint64_t aOnes = aW ^ p_n ^ aE;
+    std::uint64_t aTwos = (aW & p_n) | (aE & (aW ^ p_n));
+    std::uint64_t rOnes = rW ^ rE;
+    std::uint64_t rTwos = rW & rE;
+    std::uint64_t bOnes = bW ^ p_s ^ bE;
+    std::uint64_t bTwos = (bW & p_s) | (bE & (bW ^ p_s));
+
+    // Sum of the ones: bit of weight 1 and carry of weight 2
+    std::uint64_t ones  = aOnes ^ rOnes ^ bOnes;
+    std::uint64_t carry = (aOnes & rOnes) | (bOnes & (aOnes ^ rOnes));
+
+    // Exactly one of the four bits of weight 2 is set: 2 or 3 neighbours
+    std::uint64_t p = aTwos ^ rTwos;
+    std::uint64_t q = bTwos ^ carry;
+    std::uint64_t twoOrThree = (p ^ q) & ~(aTwos & rTwos) & ~(bTwos & carry);
+
+    // Alive cell survives with 2 or 3 neighbours, dead cell is born with 3 neighbours
+    return twoOrThree & (ones | p_c);
+}
+
+#endif // BITKERNEL_H
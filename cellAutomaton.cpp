@@ -1,4 +1,8 @@
 #include "CellAutomaton.h"
+#include "application.h"
+#include "checkpoint.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 /**
@@ -7,38 +11,80 @@
  * \author lhm
  */
 
-CellAutomaton::CellAutomaton(const Config& p_config, const Application& p_app)
+CellAutomaton::CellAutomaton(const Config& p_config, const Application& p_app, std::unique_ptr<Engine> p_engine)
     :   m_pConfig   (&p_config)
     ,   m_pApplication  (&p_app)
-    ,   m_cells(p_config.getSimX() * p_config.getSimY())
+    ,   m_simulation(std::make_unique<SimThread>(std::move(p_engine), p_config.getGenerationRate(), p_app.getTelemetry()))
+    ,   m_pyramid   (p_config.getSimX(), p_config.getSimY())
 {
-    m_random = &Random::get();
-    // Creation of the cellular automaton GUI grid
-    m_cellVertexPoints.reserve(p_config.getSimX() * p_config.getSimY() * 4);
-    for (unsigned y = 0; y < p_config.getSimY(); ++y)
+    // Colour of each density: dead cells are drawn with the foreground colour, alive ones with the background colour
+    const sf::Color& dead  = p_config.getFgColour();
+    const sf::Color& alive = p_config.getBgColour();
+    for (unsigned density = 0; density < m_palette.size(); ++density)
     {
-        for (unsigned x = 0; x < p_config.getSimX(); ++x)
+        auto mix = [density](const sf::Uint8 p_dead, const sf::Uint8 p_alive)
         {
-            addQuad(x, y);
-        }
+            return (sf::Uint8)((p_dead * (255 - density) + p_alive * density + 127) / 255);
+        };
+        m_palette[density] = sf::Color(mix(dead.r, alive.r), mix(dead.g, alive.g), mix(dead.b, alive.b), mix(dead.a, alive.a));
     }
 
-    // Random initialization of the state of each cell
-    std::mt19937 rng((unsigned)std::time(nullptr));
-    cellForEach([&](unsigned x, unsigned y)
+    if (!p_config.getRecordFile().empty())
     {
-        unsigned index = getCellIndex(x, y);
-        std::uniform_int_distribution<int> dist(0, 1);
+        m_simulation->record(p_config.getRecordFile(), p_config, p_config.getKeyframeInterval());
+    }
+    m_simulation->detectCycles(CycleDetector::getAction(p_config), p_config.getCycleHistory());
 
-        auto& cell = m_cells[index];
-        cell = (Cell)dist(rng);
-        setCellColour(x, y, cell == Cell::ON ? sf::Color::Black : m_pConfig->getFgColour());
-    });
+    // The snapshot of the initial generation is published before the simulation starts
+    m_simulation->updateSnapshot();
+    m_simulation->start();
+}
+
+void CellAutomaton::prepare(const sf::RenderWindow& p_window)
+{
+    Region region = getVisibleRegion(p_window);
+    if (region.xBegin >= region.xEnd || region.yBegin >= region.yEnd)
+    {
+        m_region = region;
+        return;
+    }
+
+    // Cell by cell, a new generation of the same region only colours the changed cells again
+    if (m_regionStale && region == m_region && region.level == 0)
+    {
+        updateRegion(region);
+        m_regionStale = false;
+    }
+    else if (m_regionStale || !(region == m_region))
+    {
+        drawRegion(region);
+        if (region.level == 0)
+        {
+            keepDrawnCells(region);
+        }
+        m_region      = region;
+        m_regionStale = false;
+    }
 }
 
 void CellAutomaton::render(sf::RenderWindow & p_window)
 {
-    p_window.draw(m_cellVertexPoints.data(), m_cellVertexPoints.size(), sf::Quads);
+    if (m_region.xBegin >= m_region.xEnd || m_region.yBegin >= m_region.yEnd)
+        return;
+
+    p_window.draw(m_sprite);
+}
+
+void CellAutomaton::input(const sf::Event& p_event)
+{
+    if (p_event.type != sf::Event::KeyPressed || p_event.key.code != sf::Keyboard::F5)
+        return;
+
+    const auto& snapshot = m_simulation->getSnapshot();
+    if (Checkpoint(*m_pConfig, snapshot.generation, snapshot.cells.data()).save(m_pConfig->getCheckpointFile()))
+    {
+        std::cout << "Generation " << snapshot.generation << " saved to " << m_pConfig->getCheckpointFile() << '\n';
+    }
 }
 
 unsigned CellAutomaton::getCellIndex(const unsigned p_x, const unsigned p_y)
@@ -46,111 +92,179 @@ unsigned CellAutomaton::getCellIndex(const unsigned p_x, const unsigned p_y)
     return p_x + p_y * m_pConfig->getSimX();
 }
 
-void CellAutomaton::setCellColour(const int        p_x,
-                                  const int        p_y,
-                                  const sf::Color& p_colour)
+CellAutomaton::Region CellAutomaton::getVisibleRegion(const sf::RenderWindow& p_window) const
 {
-    auto index = getCellIndex(p_x, p_y) * 4;
-    for (int i = 0; i < 4; i++)
+    const sf::View& view      = p_window.getView();
+    const sf::FloatRect port  = view.getViewport();
+    const float cellSize      = (float)m_pConfig->getCellSize();
+    const sf::Vector2f size   = view.getSize();
+    const sf::Vector2f corner = view.getCenter() - size / 2.f;
+
+    // Lowest level whose blocks are at least one pixel wide
+    const float pixelsX = std::max(1.f, port.width  * p_window.getSize().x);
+    const float pixelsY = std::max(1.f, port.height * p_window.getSize().y);
+    const float cellsPerPixel = std::max(std::abs(size.x) / cellSize / pixelsX, std::abs(size.y) / cellSize / pixelsY);
+
+    Region region;
+    while (region.level + 1 < m_pyramid.getLevelCount() && (float)(1u << region.level) < cellsPerPixel)
     {
-        m_cellVertexPoints[index + i].color = p_colour;
+        ++region.level;
     }
+
+    // Cells inside the view, then blocks holding them
+    auto clamp = [](const float p_value, const unsigned p_max)
+    {
+        return (unsigned)std::min((float)p_max, std::max(0.f, p_value));
+    };
+    const unsigned block = 1u << region.level;
+    region.xBegin = clamp(std::floor(corner.x / cellSize),          m_pConfig->getSimX()) / block;
+    region.yBegin = clamp(std::floor(corner.y / cellSize),          m_pConfig->getSimY()) / block;
+    region.xEnd   = (clamp(std::ceil((corner.x + size.x) / cellSize), m_pConfig->getSimX()) + block - 1) / block;
+    region.yEnd   = (clamp(std::ceil((corner.y + size.y) / cellSize), m_pConfig->getSimY()) + block - 1) / block;
+    return region;
 }
 
-void CellAutomaton::addQuad(const unsigned p_x, const unsigned p_y)
+void CellAutomaton::drawRegion(const Region& p_region)
 {
-    float cellSize = (float)m_pConfig->getCellSize();
-    sf::Vertex topLeft;
-    sf::Vertex topRight;
-    sf::Vertex bottomLeft;
-    sf::Vertex bottomRight;
-
-    float pixelX = p_x * cellSize;
-    float pixelY = p_y * cellSize;
-
-    topLeft     .position = { pixelX,               pixelY };
-    topRight    .position = { pixelX + cellSize,    pixelY };
-    bottomLeft  .position = { pixelX,               pixelY + cellSize };
-    bottomRight .position = { pixelX + cellSize,    pixelY + cellSize };
-
-    topLeft     .color = m_pConfig->getFgColour();
-    topRight    .color = m_pConfig->getFgColour();
-    bottomLeft  .color = m_pConfig->getFgColour();
-    bottomRight .color = m_pConfig->getFgColour();
-
-    m_cellVertexPoints.push_back(topLeft);
-    m_cellVertexPoints.push_back(bottomLeft);
-    m_cellVertexPoints.push_back(bottomRight);
-    m_cellVertexPoints.push_back(topRight);
+    const unsigned width    = p_region.xEnd - p_region.xBegin;
+    const unsigned height   = p_region.yEnd - p_region.yBegin;
+    const auto& cells       = m_simulation->getSnapshot().cells;
+    const auto wordsPerRow  = m_simulation->getWordsPerRow();
+    m_pixels.resize((std::size_t)width * height * 4);
+
+    if (p_region.level == 0)
+    {
+        for (unsigned y = 0; y < height; ++y)
+        {
+            const std::uint64_t* row = &cells[(std::size_t)(p_region.yBegin + y) * wordsPerRow];
+            for (unsigned x = 0; x < width; ++x)
+            {
+                const unsigned cell = p_region.xBegin + x;
+                setPixel((std::size_t)y * width + x, (row[cell / 64] >> (cell % 64)) & 1 ? 255 : 0);
+            }
+        }
+    }
+    else if (p_region.level < DensityPyramid::FIRST_LEVEL)
+    {
+        // Blocks of 2 x 2 cells are counted on the fly
+        const std::uint64_t none = 0;
+        for (unsigned y = 0; y < height; ++y)
+        {
+            const unsigned cellY = 2 * (p_region.yBegin + y);
+            const std::uint64_t* above = &cells[(std::size_t)cellY * wordsPerRow];
+            const std::uint64_t* below = cellY + 1 < m_pConfig->getSimY() ? above + wordsPerRow : nullptr;
+            for (unsigned x = 0; x < width; ++x)
+            {
+                const unsigned cell = 2 * (p_region.xBegin + x);
+                unsigned count = __builtin_popcountll((above[cell / 64] >> (cell % 64)) & 3)
+                               + __builtin_popcountll(((below ? below[cell / 64] : none) >> (cell % 64)) & 3);
+                setPixel((std::size_t)y * width + x, (std::uint8_t)((count * 255 + 2) / 4));
+            }
+        }
+    }
+    else
+    {
+        m_pyramid.refresh(cells.data(), p_region.level, p_region.xBegin, p_region.yBegin, p_region.xEnd, p_region.yEnd);
+        for (unsigned y = 0; y < height; ++y)
+        {
+            const std::uint8_t* row = m_pyramid.getRow(p_region.level, p_region.yBegin + y) + p_region.xBegin;
+            for (unsigned x = 0; x < width; ++x)
+            {
+                setPixel((std::size_t)y * width + x, row[x]);
+            }
+        }
+    }
+
+    // The texture only grows: a region never needs more pixels than the window, plus a block per side
+    const sf::Vector2u textureSize = m_texture.getSize();
+    if (textureSize.x < width || textureSize.y < height)
+    {
+        if (!m_texture.create(std::max(textureSize.x, width), std::max(textureSize.y, height)))
+        {
+            std::cout << "Unable to create a texture of " << width << " x " << height << " pixels\n";
+            return;
+        }
+        m_sprite.setTexture(m_texture);
+    }
+    m_texture.update(m_pixels.data(), width, height, 0, 0);
+
+    const float blockSize = (float)(1u << p_region.level) * m_pConfig->getCellSize();
+    m_sprite.setTextureRect(sf::IntRect(0, 0, (int)width, (int)height));
+    m_sprite.setPosition(p_region.xBegin * blockSize, p_region.yBegin * blockSize);
+    m_sprite.setScale(blockSize, blockSize);
 }
 
-void CellAutomaton::update()
+void CellAutomaton::updateRegion(const Region& p_region)
 {
-    std::vector<std::pair<sf::Vector2i, Cell>> updates;
-    cellForEach([&](unsigned x, unsigned y)
+    const unsigned width    = p_region.xEnd - p_region.xBegin;
+    const unsigned height   = p_region.yEnd - p_region.yBegin;
+    const auto& cells       = m_simulation->getSnapshot().cells;
+    const auto wordsPerRow  = m_simulation->getWordsPerRow();
+    const unsigned wBegin   = p_region.xBegin / 64;
+    const unsigned wEnd     = (p_region.xEnd + 63) / 64;
+    m_dirtyRows.assign(height, 0);
+
+    for (unsigned y = 0; y < height; ++y)
     {
-        sf::Vector2i loc(x, y);
-        unsigned count = 0;
-        for (int nX = -1; nX <= 1; nX++)
+        const std::size_t offset = (std::size_t)(p_region.yBegin + y) * wordsPerRow;
+        for (unsigned w = wBegin; w < wEnd; ++w)
         {
-            for (int nY = -1; nY <= 1; nY++)
+            // Only the cells of the region are coloured
+            std::uint64_t word = cells[offset + w] ^ m_drawnCells[offset + w];
+            if (w * 64 < p_region.xBegin)
+                word &= ~0ull << (p_region.xBegin % 64);
+            if (w * 64 + 64 > p_region.xEnd)
+                word &= ~0ull >> (64 - p_region.xEnd % 64);
+            m_drawnCells[offset + w] = cells[offset + w];
+            m_dirtyRows[y] |= word != 0;
+
+            while (word)
             {
-                int newX = nX + x;
-                int newY = nY + y;
-
-                if (newX == -1 || newX == (int)m_pConfig->getSimX() ||
-                    newY == -1 || newY == (int)m_pConfig->getSimX()||
-                   (nX == 0 && nY == 0)
-                   )
-                {
-                    continue;
-                }
-
-                auto cell = m_cells[getCellIndex(newX, newY)];
-                if (cell == Cell::ON)
-                    count++;
+                const unsigned bit = __builtin_ctzll(word);
+                word &= word - 1;
+                setPixel((std::size_t)y * width + w * 64 + bit - p_region.xBegin, (cells[offset + w] >> bit) & 1 ? 255 : 0);
             }
         }
+    }
 
-        int index = getCellIndex(x, y);
-        auto cell = m_cells[index];
-        switch (cell)
+    // Consecutive dirty rows are uploaded at once
+    unsigned y = 0;
+    while (y < height)
+    {
+        if (!m_dirtyRows[y])
         {
-            // Alive cell: Dies if (not enough) OR (too many) alive neighbors
-            case Cell::ON:
-                if(count < 2 || count > 3)
-                {
-                    updates.emplace_back(loc, Cell::OFF);
-                }
-                break;
-            // Dead cell: Goes live if (exactly 3 neighbors) alive OR
-            // get a miracle
-            case Cell::OFF:
-                if(count == 3)
-                {
-                    updates.emplace_back(loc, Cell::ON);
-                }
-                else
-                {
-                    unsigned l_rand = m_random->rand_int(0,100);
-
-                    if(l_rand < m_pConfig->getMiracleProb())
-                    {
-                        updates.emplace_back(loc, Cell::ON);
-                    }
-                }
-                break;
-            default:
-                break;
+            ++y;
+            continue;
         }
-    });
 
-    for (auto& update : updates)
-    {
-        m_cells[getCellIndex(update.first.x, update.first.y)] = update.second;
+        unsigned yEnd = y + 1;
+        while (yEnd < height && m_dirtyRows[yEnd])
+        {
+            ++yEnd;
+        }
+        m_texture.update(&m_pixels[(std::size_t)y * width * 4], width, yEnd - y, 0, y);
+        y = yEnd;
+    }
+}
 
-        setCellColour(update.first.x,
-                      update.first.y,
-                      update.second == Cell::ON ? m_pConfig->getBgColour() : m_pConfig->getFgColour());
+void CellAutomaton::keepDrawnCells(const Region& p_region)
+{
+    const auto& cells       = m_simulation->getSnapshot().cells;
+    const auto wordsPerRow  = m_simulation->getWordsPerRow();
+    m_drawnCells.resize(cells.size());
+    for (unsigned y = p_region.yBegin; y < p_region.yEnd; ++y)
+    {
+        const std::size_t offset = (std::size_t)y * wordsPerRow;
+        std::copy(cells.begin() + offset + p_region.xBegin / 64, cells.begin() + offset + (p_region.xEnd + 63) / 64,
+                  m_drawnCells.begin() + offset + p_region.xBegin / 64);
     }
 }
+
+void CellAutomaton::update()
+{
+    if (!m_simulation->updateSnapshot())
+        return;
+
+    m_pyramid.invalidate();
+    m_regionStale = true;
+}
@@ -1,9 +1,13 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <array>
+#include <memory>
 #include <vector>
 #include "config.h"
-#include "random.h"
+#include "engine.h"
+#include "densityPyramid.h"
+#include "simThread.h"
 
 /**
  * \file cellAutomaton.h
@@ -13,19 +17,18 @@
 
 class Application;
 
-/*!
- * \enum Cell
- * \brief Enumerate containing the possible states of a cell (dead or alive).
- */
-enum Cell
-{
-    ON,
-    OFF
-};
-
 /*!
  * \class CellAutomaton
- * \brief Cellular automaton containing the rules of the simulation.
+ * \brief Renderer of the cellular automaton: draws the cells of an \a Engine advanced by a \a SimThread.
+ * Only the cells inside the view are drawn: the visible region is written in \a m_pixels, one RGBA
+ * pixel per block of cells, uploaded to \a m_texture and drawn as a single scaled sprite.
+ * When zoomed out so that several cells are drawn on a pixel, a block of <em> 2^level x 2^level </em>
+ * cells is drawn with the density of its alive cells (see \a DensityPyramid), so that the cost of
+ * a frame depends on the size of the window and not on the size of the grid.
+ * When a cell is drawn per block, a new generation only colours again the cells of the region that
+ * changed, and only the rows of pixels holding them are uploaded.
+ * The generations are computed on their own thread: a slow drawing never slows the simulation
+ * down, and the latest generation published is drawn at each frame.
  */
 class CellAutomaton
 {
@@ -35,8 +38,9 @@ class CellAutomaton
          * \brief Creates a cellular automaton for the "Game of life".
          * \param p_config The GUI configuration of the automaton.
          * \param p_app The application
+         * \param p_engine The engine computing the generations, started on its own thread
          */
-        CellAutomaton(const Config& p_config, const Application& p_app);
+        CellAutomaton(const Config& p_config, const Application& p_app, std::unique_ptr<Engine> p_engine);
 
         /*!
          * Default destructor
@@ -46,25 +50,83 @@ class CellAutomaton
         /*!
          * \function input
          * \brief Called when a SFML event occurs ( see \a sf::Event ).
+         * F5 saves the latest generation drawn to the checkpoint file of the configuration.
          * \param p_event the event
          */
-        void input(const sf::Event& p_event){};
+        void input(const sf::Event& p_event);
 
         /*!
          * \function update
-         * \brief Called to get the next cellular automaton state
+         * \brief Called to get the latest cellular automaton state published by the simulation thread.
          * \author lhm
          */
         void update();
 
+        /*!
+         * \function prepare
+         * \brief Writes the colours of the region seen through the view of the window, if it
+         * changed since the last call (or if the cells did).
+         * \param p_window the window, with the view of the cells
+         */
+        void prepare(const sf::RenderWindow& p_window);
+
         /*!
          * \function render
-         * \brief Displays the application to the window.
+         * \brief Displays the region written by \a prepare to the window.
          * \param p_window the window
          */
         void render(sf::RenderWindow& p_window);
 
     protected:
+        /*!
+         * \struct Region
+         * \brief Blocks of cells of a level drawn on the screen.
+         */
+        struct Region
+        {
+            unsigned level  = 0;                        /**< blocks of 2^level x 2^level cells */
+            unsigned xBegin = 0;                        /**< first block abscissa */
+            unsigned yBegin = 0;                        /**< first block ordinate */
+            unsigned xEnd   = 0;                        /**< past-the-end block abscissa */
+            unsigned yEnd   = 0;                        /**< past-the-end block ordinate */
+
+            bool operator==(const Region& p_other) const
+            {
+                return level == p_other.level && xBegin == p_other.xBegin && yBegin == p_other.yBegin
+                    && xEnd == p_other.xEnd && yEnd == p_other.yEnd;
+            }
+        };
+
+        /*!
+         * \function getVisibleRegion
+         * \brief Returns the blocks of cells seen through the view of the window.
+         * The level is the lowest one whose blocks are at least one pixel wide.
+         * \param p_window the window
+         */
+        Region getVisibleRegion(const sf::RenderWindow& p_window) const;
+
+        /*!
+         * \function drawRegion
+         * \brief Writes the colour of the blocks of the region, and uploads them to the texture.
+         * \param p_region the region
+         */
+        void drawRegion(const Region& p_region);
+
+        /*!
+         * \function updateRegion
+         * \brief Colours again the cells of the region (of level 0) that changed since they were drawn,
+         * and uploads the rows of pixels holding them.
+         * \param p_region the region, the one already in the texture
+         */
+        void updateRegion(const Region& p_region);
+
+        /*!
+         * \function keepDrawnCells
+         * \brief Copies the words of the cells of the region (of level 0) to \a m_drawnCells.
+         * \param p_region the region
+         */
+        void keepDrawnCells(const Region& p_region);
+
 
         /*!
          * \function getCellIndex
@@ -76,21 +138,20 @@ class CellAutomaton
         unsigned getCellIndex(const unsigned p_x, const unsigned p_y);
 
         /*!
-         * \function setCellColour
-         * \brief Set a colour to the requested cell.
-         * \param p_x the requested abscissa
-         * \param p_y the requested ordinate
-         * \param p_colour the requested colour.
-         */
-        void setCellColour(const int p_x, const int p_y, const sf::Color& p_colour);
-
-        /*!
-         * \function addQuad
-         * \brief Creates a quad at the requested indexes.
-         * \param p_x the requested abscissa
-         * \param p_y the requested ordinate
+         * \function setPixel
+         * \brief Writes the colour of a density of alive cells to a pixel of \a m_pixels.
+         * \param p_index the index of the pixel
+         * \param p_density the density, from 0 (dead) to 255 (alive)
          */
-        void addQuad(const unsigned p_x, const unsigned p_y);
+        void setPixel(const std::size_t p_index, const std::uint8_t p_density)
+        {
+            const sf::Color& colour = m_palette[p_density];
+            sf::Uint8* pixel = &m_pixels[p_index * 4];
+            pixel[0] = colour.r;
+            pixel[1] = colour.g;
+            pixel[2] = colour.b;
+            pixel[3] = colour.a;
+        }
 
         template<typename Func>
         void cellForEach(Func function);
@@ -98,9 +159,16 @@ class CellAutomaton
     private:
         const Application* const m_pApplication;        /**< application associated to the cellular automaton */
         const Config* const m_pConfig;                  /**< configuration associated to the cellular automaton */
-        std::vector<sf::Vertex> m_cellVertexPoints;     /**< vector containing the cells of the cellular automaton */
-        std::vector<Cell> m_cells;                      /**< vector containing the cells of the cellular automaton */
-        Random*     m_random;                           /**< Random numbers generator */
+        std::unique_ptr<SimThread> m_simulation;        /**< thread computing the generations */
+        DensityPyramid m_pyramid;                       /**< density of the blocks of cells, when zoomed out */
+        std::array<sf::Color, 256> m_palette;           /**< colour of each density, from dead to alive */
+        Region m_region;                                /**< region in \a m_texture */
+        bool m_regionStale = true;                      /**< the cells changed since the region was drawn */
+        std::vector<sf::Uint8> m_pixels;                /**< colour of each block of the region (RGBA) */
+        std::vector<std::uint64_t> m_drawnCells;        /**< alive cells drawn, laid out as the snapshot (words of the region of level 0 only) */
+        std::vector<std::uint8_t> m_dirtyRows;          /**< rows of the region coloured again since the last upload */
+        sf::Texture m_texture;                          /**< texture of the region, one pixel per block */
+        sf::Sprite m_sprite;                            /**< sprite drawing the region, scaled by the size of a block */
 };
 
 template<typename Func>
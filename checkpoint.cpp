@@ -0,0 +1,368 @@
+#include "checkpoint.h"
+#include "engine.h"
+#include "mappedFile.h"
+#include "rule.h"
+#include "simConfig.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+/**
+ * \file checkpoint.cpp
+ * \brief Implementation of the functions defined in \a checkpoint.h
+ * \author lhm
+ */
+
+namespace
+{
+    const char MAGIC[8] = { 'C', 'E', 'L', 'L', 'C', 'K', 'P', 'T' };
+
+    template<typename T>
+    void put(std::vector<std::uint8_t>& p_out, const T p_value)
+    {
+        const std::uint8_t* bytes = (const std::uint8_t*)&p_value;
+        p_out.insert(p_out.end(), bytes, bytes + sizeof(T));
+    }
+
+    /*!
+     * Reads a value, moving the cursor past it. Returns false past the end of the buffer.
+     */
+    template<typename T>
+    bool get(const std::uint8_t*& p_in, const std::uint8_t* p_end, T& p_value)
+    {
+        if ((std::size_t)(p_end - p_in) < sizeof(T))
+            return false;
+        std::memcpy(&p_value, p_in, sizeof(T));
+        p_in += sizeof(T);
+        return true;
+    }
+
+    void putToken(std::vector<std::uint8_t>& p_out, const Checkpoint::Token p_kind, const std::size_t p_count)
+    {
+        std::uint64_t value = (std::uint64_t)p_count << 2 | p_kind;
+        while (value >= 0x80)
+        {
+            p_out.push_back((std::uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        p_out.push_back((std::uint8_t)value);
+    }
+
+    bool getToken(const std::uint8_t*& p_in, const std::uint8_t* p_end, std::uint64_t& p_value)
+    {
+        p_value = 0;
+        for (unsigned shift = 0; p_in < p_end && shift < 64; shift += 7)
+        {
+            const std::uint8_t byte = *p_in++;
+            p_value |= (std::uint64_t)(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    /*!
+     * Counts the words of compressed words without decoding them. Returns false if they are invalid.
+     */
+    bool countWords(const std::uint8_t* p_in, const std::size_t p_size, std::uint64_t& p_count)
+    {
+        const std::uint8_t* end = p_in + p_size;
+        p_count = 0;
+        while (p_in < end)
+        {
+            std::uint64_t token = 0;
+            if (!getToken(p_in, end, token))
+                return false;
+
+            const std::uint64_t count = token >> 2;
+            if (count == 0 || count > Checkpoint::MAX_WORDS - p_count || (token & 3) > Checkpoint::LITERAL)
+                return false;
+            if ((token & 3) == Checkpoint::LITERAL)
+            {
+                if (count > (std::uint64_t)(end - p_in) / sizeof(std::uint64_t))
+                    return false;
+                p_in += count * sizeof(std::uint64_t);
+            }
+            p_count += count;
+        }
+        return true;
+    }
+
+    Checkpoint::Token getKind(const std::uint64_t p_word)
+    {
+        return p_word == 0 ? Checkpoint::ZERO : ~p_word == 0 ? Checkpoint::FULL : Checkpoint::LITERAL;
+    }
+}
+
+Checkpoint::Checkpoint(const SimConfig& p_config, const std::uint64_t p_generation, const std::uint64_t* p_cells,
+                       const unsigned p_planes)
+    :   m_simX          (p_config.getSimX())
+    ,   m_simY          (p_config.getSimY())
+    ,   m_generation    (p_generation)
+    ,   m_seed          (p_config.getSeed())
+    ,   m_miracleProb   (p_config.getMiracleProb())
+    ,   m_rule          (p_config.getRule())
+    ,   m_planes        (p_planes)
+    ,   m_cells         (p_cells, p_cells + (std::size_t)(m_simX + 63) / 64 * m_simY * (1 + p_planes))
+{
+}
+
+Checkpoint::Checkpoint(const SimConfig& p_config, const Engine& p_engine)
+    :   m_simX          (p_engine.getSimX())
+    ,   m_simY          (p_engine.getSimY())
+    ,   m_generation    (p_engine.getGeneration())
+    ,   m_seed          (p_config.getSeed())
+    ,   m_miracleProb   (p_config.getMiracleProb())
+    ,   m_rule          (p_config.getRule())
+    ,   m_planes        (getPlaneCount(m_rule))
+    ,   m_cells         ((std::size_t)p_engine.getChangesWordsPerRow() * m_simY * (1 + m_planes))
+{
+    const std::size_t words = (std::size_t)p_engine.getChangesWordsPerRow() * m_simY;
+    p_engine.getCells(m_cells.data());
+    p_engine.getStates(m_cells.data() + words, m_planes);
+}
+
+unsigned Checkpoint::getPlaneCount(const std::string& p_rule)
+{
+    Rule rule;
+    return rule.parse(p_rule) && rule.states > 2 ? rule.getStateBits() : 0;
+}
+
+bool Checkpoint::save(const std::string& p_file) const
+{
+    if (m_planes < getPlaneCount(m_rule))
+    {
+        std::cout << "The checkpoint " << p_file << " is not saved: the states of the cells of " << m_rule
+                  << " are not known\n";
+        return false;
+    }
+
+    std::vector<std::uint8_t> data;
+    data.reserve(64 + m_rule.size() + m_cells.size() * 9);
+
+    // Header: its size is patched once known, the payload is aligned on 8 bytes
+    data.insert(data.end(), MAGIC, MAGIC + sizeof(MAGIC));
+    put<std::uint32_t>(data, VERSION);
+    put<std::uint32_t>(data, 0);
+    put<std::uint32_t>(data, m_simX);
+    put<std::uint32_t>(data, m_simY);
+    put<std::uint64_t>(data, m_generation);
+    put<std::uint64_t>(data, m_seed);
+    put<double>       (data, m_miracleProb);
+    const std::size_t payloadSizeOffset = data.size();
+    put<std::uint64_t>(data, 0);
+    put<std::uint64_t>(data, getChecksum());
+    put<std::uint32_t>(data, m_planes);
+    put<std::uint32_t>(data, (std::uint32_t)m_rule.size());
+    data.insert(data.end(), m_rule.begin(), m_rule.end());
+    data.resize((data.size() + 7) / 8 * 8, 0);
+
+    const std::uint32_t headerSize = (std::uint32_t)data.size();
+    std::memcpy(&data[12], &headerSize, sizeof(headerSize));
+    encode(m_cells.data(), m_cells.size(), data);
+    const std::uint64_t payloadSize = data.size() - headerSize;
+    std::memcpy(&data[payloadSizeOffset], &payloadSize, sizeof(payloadSize));
+
+    // Written aside, so that an interrupted save does not destroy the previous checkpoint
+    const std::string temporary = p_file + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out.write((const char*)data.data(), (std::streamsize)data.size()) || !out.flush())
+        {
+            std::cout << "Unable to write the checkpoint " << temporary << '\n';
+            return false;
+        }
+    }
+#ifdef _WIN32
+    std::remove(p_file.c_str());
+#endif
+    if (std::rename(temporary.c_str(), p_file.c_str()) != 0)
+    {
+        std::cout << "Unable to replace the checkpoint " << p_file << '\n';
+        return false;
+    }
+    return true;
+}
+
+bool Checkpoint::load(const std::string& p_file)
+{
+    MappedFile file(p_file);
+    if (!file.getData())
+    {
+        std::cout << "Unable to open the checkpoint " << p_file << '\n';
+        return false;
+    }
+
+    const std::uint8_t* in  = file.getData();
+    const std::uint8_t* end = in + file.getSize();
+    if (file.getSize() < sizeof(MAGIC) || std::memcmp(in, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        std::cout << p_file << " is not a checkpoint\n";
+        return false;
+    }
+    in += sizeof(MAGIC);
+
+    std::uint32_t version = 0, headerSize = 0, planes = 0, ruleSize = 0;
+    std::uint64_t payloadSize = 0, checksum = 0;
+    bool valid = get(in, end, version) && (version == 1 || version == VERSION);
+    if (!valid)
+    {
+        std::cout << "Unsupported version of the checkpoint " << p_file << ": " << version << '\n';
+        return false;
+    }
+
+    // The payload starts past the fields read, aligned on 8 bytes
+    valid = get(in, end, headerSize) && get(in, end, m_simX) && get(in, end, m_simY)
+         && get(in, end, m_generation) && get(in, end, m_seed) && get(in, end, m_miracleProb)
+         && get(in, end, payloadSize) && get(in, end, checksum) && (version == 1 || get(in, end, planes))
+         && get(in, end, ruleSize) && planes <= MAX_PLANES && ruleSize <= (std::size_t)(end - in)
+         && headerSize % 8 == 0 && headerSize >= (std::size_t)(in + ruleSize - file.getData())
+         && headerSize <= file.getSize() && payloadSize == file.getSize() - headerSize;
+
+    // The cells are only allocated once the payload is known to hold them all
+    std::uint64_t words = 0;
+    const std::uint64_t expected = ((std::uint64_t)m_simX + 63) / 64 * m_simY * (1 + planes);
+    valid = valid && countWords(file.getData() + headerSize, (std::size_t)payloadSize, words) && words == expected;
+    if (valid)
+    {
+        m_rule.assign((const char*)in, ruleSize);
+        m_planes = planes;
+        m_cells.resize((std::size_t)expected);
+        valid = decode(file.getData() + headerSize, (std::size_t)payloadSize, m_cells.data(), m_cells.size())
+             && getChecksum() == checksum;
+    }
+    if (!valid)
+    {
+        std::cout << "The checkpoint " << p_file << " is corrupted\n";
+        m_cells.clear();
+    }
+    return valid;
+}
+
+void Checkpoint::configure(SimConfig& p_config) const
+{
+    p_config.setSimX(m_simX);
+    p_config.setSimY(m_simY);
+    p_config.setRule(m_rule);
+    p_config.setSeed(m_seed);
+    p_config.setMiracleProb(m_miracleProb);
+}
+
+void Checkpoint::restore(Engine& p_engine) const
+{
+    const std::size_t words = (std::size_t)(m_simX + 63) / 64 * m_simY;
+    if (m_planes > 0)
+        p_engine.setStates(m_cells.data() + words, m_planes);
+    else
+        p_engine.setCells(m_cells.data());
+    p_engine.setGeneration(m_generation);
+}
+
+std::unique_ptr<Engine> Checkpoint::resume(const std::string& p_file, SimConfig& p_config)
+{
+    Checkpoint checkpoint;
+    if (!checkpoint.load(p_file))
+        return nullptr;
+
+    checkpoint.configure(p_config);
+    auto engine = Engine::create(p_config, nullptr);
+    if (engine)
+    {
+        checkpoint.restore(*engine);
+    }
+    return engine;
+}
+
+void Checkpoint::encode(const std::uint64_t* p_words, const std::size_t p_count, std::vector<std::uint8_t>& p_out)
+{
+    std::size_t begin = 0;
+    while (begin < p_count)
+    {
+        // Longest run of words of the same kind
+        const Token kind = getKind(p_words[begin]);
+        std::size_t end = begin + 1;
+        while (end < p_count && getKind(p_words[end]) == kind)
+        {
+            ++end;
+        }
+
+        putToken(p_out, kind, end - begin);
+        if (kind == LITERAL)
+        {
+            const std::uint8_t* bytes = (const std::uint8_t*)&p_words[begin];
+            p_out.insert(p_out.end(), bytes, bytes + (end - begin) * sizeof(std::uint64_t));
+        }
+        begin = end;
+    }
+}
+
+bool Checkpoint::decode(const std::uint8_t* p_in, const std::size_t p_size,
+                        std::uint64_t* p_words, const std::size_t p_count, const bool p_xor)
+{
+    const std::uint8_t* end = p_in + p_size;
+    std::size_t word = 0;
+    while (p_in < end)
+    {
+        std::uint64_t token = 0;
+        if (!getToken(p_in, end, token))
+            return false;
+
+        const std::uint64_t count = token >> 2;
+        if (count == 0 || count > p_count - word)
+            return false;
+
+        std::uint64_t* words = p_words + word;
+        switch (token & 3)
+        {
+            case ZERO:
+                if (!p_xor)
+                    std::fill_n(words, count, 0);
+                break;
+
+            case FULL:
+                if (p_xor)
+                    std::transform(words, words + count, words, [](const std::uint64_t p_word) { return ~p_word; });
+                else
+                    std::fill_n(words, count, ~0ULL);
+                break;
+
+            case LITERAL:
+                if (count > (std::uint64_t)(end - p_in) / sizeof(std::uint64_t))
+                    return false;
+                if (p_xor)
+                {
+                    for (std::uint64_t i = 0; i < count; ++i)
+                    {
+                        std::uint64_t literal;
+                        std::memcpy(&literal, p_in + i * sizeof(std::uint64_t), sizeof(literal));
+                        words[i] ^= literal;
+                    }
+                }
+                else
+                {
+                    std::memcpy(words, p_in, count * sizeof(std::uint64_t));
+                }
+                p_in += count * sizeof(std::uint64_t);
+                break;
+
+            default:
+                return false;
+        }
+        word += count;
+    }
+    return word == p_count;
+}
+
+std::uint64_t Checkpoint::getChecksum() const
+{
+    // FNV-1a on words rather than bytes, fast enough not to show next to the copy of the cells
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const std::uint64_t word : m_cells)
+    {
+        hash = (hash ^ word) * 0x100000001b3ULL;
+    }
+    return hash ^ m_cells.size();
+}
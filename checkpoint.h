@@ -0,0 +1,195 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * \file checkpoint.h
+ * \brief Definition of the checkpoint files, saving the exact state of a simulation.
+ * \author lhm
+ */
+
+class Engine;
+class SimConfig;
+
+/*!
+ * \class Checkpoint
+ * \brief State of a simulation: size of the grid, rule, seed and probability of the miracles,
+ * generation and cells, with the dying states of the cells for the "Generations" rules. The random numbers only depend on the seed and on the generation
+ * (see \a CounterRandom), so that a simulation resumed from a checkpoint computes exactly the
+ * same generations as the one saved.
+ * The file holds a header followed by the cells, laid out as \a Engine::getCells, then for the
+ * rules of more than two states by the bit planes of the states (see \a Engine::getStates), all
+ * compressed by runs of words:
+ * <ul>
+ * <li> Header (little endian): "CELLCKPT", version, size of the header, simX, simY, generation,
+ * seed, miracle probability, size of the payload, checksum of the cells, number of state planes,
+ * length of the rule, rule (version 1 has no state planes)
+ * <li> Payload: tokens <em> count << 2 | kind </em> (LEB128), followed for the \a LITERAL tokens
+ * by their \a count words, the other kinds being runs of \a count \a ZERO or \a FULL words
+ * </ul>
+ * Saving only encodes the bitmap once, and loading maps the file and decodes it in place.
+ * The unbounded engines (hashlife, sparse) only save the cells of their window.
+ */
+class Checkpoint
+{
+    public:
+        static const std::uint32_t VERSION = 2;         /**< version of the files written */
+        static const std::uint64_t MAX_WORDS = 1ULL << 32;  /**< words of cells read at most (32 GiB), by a checkpoint or a recording */
+        static const unsigned MAX_PLANES = 8;           /**< state planes of the rules of 256 states */
+
+        /*!
+         * \enum Token
+         * \brief Kinds of runs of words of the payload.
+         */
+        enum Token
+        {
+            ZERO,                                       /**< words without alive cell */
+            FULL,                                       /**< words of alive cells only */
+            LITERAL                                     /**< words stored as is */
+        };
+
+        Checkpoint() = default;
+
+        /*!
+         * \function Checkpoint
+         * \brief Copies the state of a simulation.
+         * \param p_config the configuration of the simulation (size, rule, seed, miracles)
+         * \param p_generation the generation of the cells
+         * \param p_cells the bitmap of the alive cells, laid out as \a Engine::getCells, followed by
+         * \a p_planes bit planes of the states
+         * \param p_planes the number of state planes (0 for the alive cells only)
+         */
+        Checkpoint(const SimConfig& p_config, const std::uint64_t p_generation, const std::uint64_t* p_cells,
+                   const unsigned p_planes = 0);
+
+        /*!
+         * \function Checkpoint
+         * \brief Copies the state of an engine.
+         * \param p_config the configuration of the engine
+         * \param p_engine the engine
+         */
+        Checkpoint(const SimConfig& p_config, const Engine& p_engine);
+
+        /*!
+         * \function save
+         * \brief Writes the checkpoint to a file. The file is replaced once completely written.
+         * The checkpoint of a rule of more than two states without its state planes is not written:
+         * the dying cells would be lost.
+         * \param p_file the file
+         * \return true if the file was written.
+         */
+        bool save(const std::string& p_file) const;
+
+        /*!
+         * \function load
+         * \brief Reads a checkpoint file, mapped in memory.
+         * \param p_file the file
+         * \return true if the file is a valid checkpoint.
+         */
+        bool load(const std::string& p_file);
+
+        /*!
+         * \function configure
+         * \brief Replaces the size of the grid, the rule, the seed and the miracle probability
+         * of a configuration by the ones of the checkpoint.
+         * \param p_config the configuration
+         */
+        void configure(SimConfig& p_config) const;
+
+        /*!
+         * \function restore
+         * \brief Sets the cells and the generation of an engine created from a configuration
+         * given to \a configure.
+         * \param p_engine the engine
+         */
+        void restore(Engine& p_engine) const;
+
+        /*!
+         * \function resume
+         * \brief Loads a checkpoint file, configures the simulation and creates its engine with the
+         * state of the checkpoint.
+         * \param p_file the checkpoint file
+         * \param p_config the configuration (the engine keeps a reference to it)
+         * \return the engine, or nullptr if the file or the engine name is invalid.
+         */
+        static std::unique_ptr<Engine> resume(const std::string& p_file, SimConfig& p_config);
+
+        /*!
+         * Get the abscissa of the grid
+         */
+        unsigned getSimX() const { return m_simX; }
+
+        /*!
+         * Get the ordinate of the grid
+         */
+        unsigned getSimY() const { return m_simY; }
+
+        /*!
+         * Get the generation of the cells
+         */
+        std::uint64_t getGeneration() const { return m_generation; }
+
+        /*!
+         * Get the bitmap of the alive cells, laid out as \a Engine::getCells, followed by the state planes
+         */
+        const std::vector<std::uint64_t>& getCells() const { return m_cells; }
+
+        /*!
+         * Get the number of bit planes of the states following the alive cells (0 for the rules of two states)
+         */
+        unsigned getStatePlanes() const { return m_planes; }
+
+        /*!
+         * \function getPlaneCount
+         * \brief Returns the number of bit planes saved for the states of the cells of a rule: none
+         * for the rules of two states, whose alive cells are their states.
+         * \param p_rule the rulestring
+         */
+        static unsigned getPlaneCount(const std::string& p_rule);
+
+        /*!
+         * \function encode
+         * \brief Appends words to a buffer, compressed by runs as the payload of a checkpoint.
+         * \param p_words the words
+         * \param p_count the number of words
+         * \param p_out the buffer
+         */
+        static void encode(const std::uint64_t* p_words, const std::size_t p_count, std::vector<std::uint8_t>& p_out);
+
+        /*!
+         * \function decode
+         * \brief Decompresses words written by \a encode.
+         * \param p_in the compressed words
+         * \param p_size the size of the compressed words, in bytes
+         * \param p_words the words, replaced by the decompressed ones or, if \a p_xor, combined with them
+         * by an exclusive or (the runs of \a ZERO words are then skipped)
+         * \param p_count the number of words
+         * \param p_xor true to combine the words instead of replacing them
+         * \return false if the compressed words are invalid or are not exactly \a p_count words.
+         */
+        static bool decode(const std::uint8_t* p_in, const std::size_t p_size,
+                           std::uint64_t* p_words, const std::size_t p_count, const bool p_xor = false);
+
+    protected:
+        /*!
+         * \function getChecksum
+         * \brief Returns the checksum of the cells, stored in the header.
+         */
+        std::uint64_t getChecksum() const;
+
+    private:
+        unsigned m_simX = 0;                            /**< abscissa of the grid */
+        unsigned m_simY = 0;                            /**< ordinate of the grid */
+        std::uint64_t m_generation = 0;                 /**< generation of the cells */
+        std::uint64_t m_seed = 0;                       /**< seed of the random numbers */
+        double m_miracleProb = 0;                       /**< probability (%) of the miracles */
+        std::string m_rule;                             /**< rulestring */
+        unsigned m_planes = 0;                          /**< number of state planes */
+        std::vector<std::uint64_t> m_cells;             /**< alive cells, then the state planes */
+};
+
+#endif // CHECKPOINT_H
@@ -14,72 +14,80 @@ void Config::init()
     windowSize.x -= windowSize.x % cellSize;
     windowSize.y -= windowSize.y % cellSize;
 
-    simSize.x = windowSize.x / cellSize;
-    simSize.y = windowSize.y / cellSize;
+    setSimX(windowSize.x / cellSize);
+    setSimY(windowSize.y / cellSize);
 }
 
-void Config::loadConfig()
+void Config::loadDefaults()
 {
-    std::ifstream inFile("config.txt");
-    if (!inFile.is_open())
-    {
-        std::cout << "Unable to load config, making default settings\n";
-        setFrameRate(15);
-        setSimX(1280);
-        setSimY(720);
-        setCellSize(2);
-        setMiracleProb(5);
-
-        return;
-    }
+    SimConfig::loadDefaults();
+    setFrameRate(15);
+    setSimX(1280);
+    setSimY(720);
+    setCellSize(2);
+}
 
-    std::string line;
+bool Config::parseEntry(const std::string& p_key, std::istream& p_in)
+{
     unsigned tmp;
-    while (std::getline(inFile, line))
+    if (p_key == "winx")
+    {
+        p_in >> tmp;
+        setWindowSizeX(tmp);
+    }
+    else if (p_key == "winy")
+    {
+        p_in >> tmp;
+        setWindowSizeY(tmp);
+    }
+    else if (p_key == "cellsize")
+    {
+        p_in >> tmp;
+        setCellSize(tmp);
+    }
+    else if (p_key == "bgcol")
     {
-        if (line == "winx")
-        {
-            inFile >> tmp;
-            setWindowSizeX(tmp);
-        }
-        else if (line == "winy")
-        {
-            inFile >> tmp;
-            setWindowSizeY(tmp);
-        }
-        else if (line == "cellsize")
-        {
-            inFile >> tmp;
-            setCellSize(tmp);
-        }
-        else if (line == "bgcol")
-        {
-            unsigned r, g, b;
-            sf::Color l_color;
+        unsigned r, g, b;
+        sf::Color l_color;
 
-            inFile >> r;
-            inFile >> g;
-            inFile >> b;
+        p_in >> r;
+        p_in >> g;
+        p_in >> b;
 
-            l_color = sf::Color(r, g, b);
-            setBgColour(l_color);
-        }
-        else if (line == "fgcol")
-        {
-            unsigned r, g, b;
-            sf::Color l_color;
-            inFile >> r;
-            inFile >> g;
-            inFile >> b;
+        l_color = sf::Color(r, g, b);
+        setBgColour(l_color);
+    }
+    else if (p_key == "fgcol")
+    {
+        unsigned r, g, b;
+        sf::Color l_color;
+        p_in >> r;
+        p_in >> g;
+        p_in >> b;
 
-            l_color = sf::Color(r, g, b);
-            setFgColour(l_color);
-        }
-        else if (line == "miracleProb")
-        {
-            inFile >> tmp;
-            setMiracleProb(tmp);
-        }
+        l_color = sf::Color(r, g, b);
+        setFgColour(l_color);
+    }
+    else if (p_key == "telemetry")
+    {
+        p_in >> tmp;
+        setTelemetry(tmp != 0);
+    }
+    else if (p_key == "telemetryFile")
+    {
+        std::string l_file;
+        p_in >> l_file;
+        setTelemetryFile(l_file);
+    }
+    else if (p_key == "fontFile")
+    {
+        std::string l_file;
+        p_in >> l_file;
+        setFontFile(l_file);
+    }
+    else
+    {
+        return SimConfig::parseEntry(p_key, p_in);
     }
-    init();
+    return true;
 }
@@ -10,12 +10,15 @@
 
 #include <SFML/Graphics.hpp>
 #include <iostream>
+#include <string>
+#include "simConfig.h"
 
 /*!
  * \class Config
  * \brief Configuration class containing customized elements of the simulation.
+ * The settings of the simulation engine itself are inherited from \a SimConfig.
  */
-class Config
+class Config : public SimConfig
 {
     public:
         Config() = default;
@@ -33,16 +36,6 @@ class Config
             init();
         }
 
-        /*!
-         * Get the simulation abscissa
-         */
-        const unsigned& getSimX() const { return simSize.x; }
-
-        /*!
-         * Get the simulation ordinate
-         */
-        const unsigned& getSimY() const { return simSize.y; }
-
         /*!
          * Get the foreground colour
          */
@@ -74,19 +67,19 @@ class Config
          const unsigned& getFrameRate() const { return frameRate; }
 
         /*!
-         * Get the probability of cell "miracle" apparition
+         * Get whether the durations of the phases of the frames are measured
          */
-         const unsigned& getMiracleProb() const { return miracle_prob; }
+        bool getTelemetry() const { return telemetry || !telemetryFile.empty(); }
 
         /*!
-         * Set the simulation abscissa
+         * Get the CSV file the durations of the phases are written to (empty for none)
          */
-        void setSimX(const unsigned p_x) { simSize.x = p_x; }
+        const std::string& getTelemetryFile() const { return telemetryFile; }
 
         /*!
-         * Set the simulation ordinate
+         * Get the font of the texts of the telemetry overlay (empty for none)
          */
-        void setSimY(const unsigned p_y) { simSize.y = p_y; }
+        const std::string& getFontFile() const { return fontFile; }
 
         /*!
          * Set the foreground colour
@@ -119,32 +112,52 @@ class Config
          void setFrameRate(const unsigned& p_frameRate) { frameRate = p_frameRate; }
 
         /*!
-         * Set the probability of cell "miracle" apparition
+         * Set whether the durations of the phases of the frames are measured
+         */
+        void setTelemetry(const bool p_telemetry) { telemetry = p_telemetry; }
+
+        /*!
+         * Set the CSV file the durations of the phases are written to (enables the telemetry)
+         */
+        void setTelemetryFile(const std::string& p_file) { telemetryFile = p_file; }
+
+        /*!
+         * Set the font of the texts of the telemetry overlay
          */
-         void setMiracleProb(const unsigned& p_miracleProb) { miracle_prob = p_miracleProb; }
+        void setFontFile(const std::string& p_file) { fontFile = p_file; }
 
+    protected:
         /*!
          * \function init
          * \brief performs the initialization step of a \a Config object.
          */
-        void init();
+        void init() override;
 
         /*!
-         * \function loadConfig
-         * \brief load configuration parameters from <em>"config.txt"</em> file.
+         * \function parseEntry
+         * \brief Reads the value(s) of a display key, or forwards it to \a SimConfig.
+         * \param p_key the key read on the current line.
+         * \param p_in the stream to read the value(s) from.
+         * \return true if the key is known, false otherwise.
          */
-        void loadConfig();
+        bool parseEntry(const std::string& p_key, std::istream& p_in) override;
+
+        /*!
+         * \function loadDefaults
+         * \brief Called when the configuration file cannot be opened.
+         */
+        void loadDefaults() override;
 
     private:
         sf::Vector2u windowSize = { 1280, 720 };        /**< Dimensions of the display window */
-        sf::Vector2u simSize;                           /**< Size of the simulation */
         unsigned cellSize = 4;                          /**< Size of a cell */
         unsigned frameRate = 15;                        /**< Maximum framerate for the simulation */
+        bool telemetry = false;                         /**< Measure the durations of the phases */
+        std::string telemetryFile;                      /**< CSV file of the durations of the phases */
+        std::string fontFile;                           /**< Font of the telemetry overlay */
 
         sf::Color bgColour = { 150, 150, 150 };         /**< Default background colour */
         sf::Color fgColour = { 25, 25, 25 };            /**< Default foreground colour */
-
-        unsigned miracle_prob = 5;                      /**< Probability a cell appears for no apparent reason */
 };
 
 #endif // CONFIG_H
@@ -0,0 +1,85 @@
+#ifndef COUNTERRANDOM_H
+#define COUNTERRANDOM_H
+
+#include <cstdint>
+
+/**
+ * \file counterRandom.h
+ * \brief Counter-based random numbers, used by the random operations of the engines.
+ * \author lhm
+ */
+
+/*!
+ * \class CounterRandom
+ * \brief Stateless random numbers generator (SplitMix64 finaliser applied to a counter).
+ * The number drawn for a cell only depends on the seed, the generation and the index of
+ * the cell: it can be computed from any thread and in any order, so that a simulation
+ * gives the same results for a given seed whatever the number of threads.
+ * <ul>
+ * <li> Get the key of a generation with \a getKey
+ * <li> Draw the number of a cell with \a get, \a uniformInt or \a uniformReal
+ * </ul>
+ */
+class CounterRandom
+{
+    public:
+        /*!
+         * \function getKey
+         * \brief Returns the key of the numbers drawn during a generation.
+         * \param p_seed the seed of the simulation
+         * \param p_generation the generation being computed
+         */
+        static std::uint64_t getKey(const std::uint64_t p_seed, const std::uint64_t p_generation)
+        {
+            return mix(p_seed ^ mix(p_generation + GOLDEN_GAMMA));
+        }
+
+        /*!
+         * \function get
+         * \brief Returns the 64 bits random number of a cell.
+         * \param p_key the key of the generation (see \a getKey)
+         * \param p_index the index of the cell
+         */
+        static std::uint64_t get(const std::uint64_t p_key, const std::uint64_t p_index)
+        {
+            return mix(p_key + p_index * GOLDEN_GAMMA);
+        }
+
+        /*!
+         * \function uniformInt
+         * \brief Returns a random integer of [0, p_max] for a cell.
+         * \param p_key the key of the generation (see \a getKey)
+         * \param p_index the index of the cell
+         * \param p_max the greatest value returned
+         */
+        static unsigned uniformInt(const std::uint64_t p_key, const std::uint64_t p_index, const unsigned p_max)
+        {
+            return (unsigned)(((get(p_key, p_index) >> 32) * ((std::uint64_t)p_max + 1)) >> 32);
+        }
+
+        /*!
+         * \function uniformReal
+         * \brief Returns a random real of (0, 1] for a cell.
+         * \param p_key the key of the generation (see \a getKey)
+         * \param p_index the index of the cell
+         */
+        static double uniformReal(const std::uint64_t p_key, const std::uint64_t p_index)
+        {
+            return (double)((get(p_key, p_index) >> 11) + 1) * (1.0 / 9007199254740992.0);
+        }
+
+    private:
+        static const std::uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ULL;  /**< increment of SplitMix64 */
+
+        /*!
+         * Finaliser of SplitMix64: every bit of the result depends on every bit of \a p_z
+         */
+        static std::uint64_t mix(std::uint64_t p_z)
+        {
+            p_z = (p_z ^ (p_z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            p_z = (p_z ^ (p_z >> 27)) * 0x94D049BB133111EBULL;
+            return p_z ^ (p_z >> 31);
+        }
+};
+
+#endif // COUNTERRANDOM_H
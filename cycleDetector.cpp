@@ -0,0 +1,149 @@
+#include "cycleDetector.h"
+#include "counterRandom.h"
+#include "engine.h"
+#include "rule.h"
+#include "simConfig.h"
+
+#include <algorithm>
+#include <iostream>
+
+/**
+ * \file cycleDetector.cpp
+ * \brief Implementation of the functions defined in \a cycleDetector.h
+ * \author lhm
+ */
+
+namespace
+{
+    const char* const ACTION_NAMES[] = { "off", "detect", "stop", "skip" };
+
+    const std::uint64_t HASH_KEY = CounterRandom::getKey(0x5A0B7157C0FFEEULL, 0);    /**< key of the numbers of the cells */
+}
+
+CycleDetector::Action CycleDetector::getAction(const SimConfig& p_config)
+{
+    for (unsigned action = OFF; action <= SKIP; ++action)
+    {
+        if (p_config.getCycle() != ACTION_NAMES[action])
+            continue;
+
+        if (action != OFF && p_config.getMiracleProb() > 0)
+        {
+            std::cout << "The cycles are not detected with miracles: the simulation is not deterministic\n";
+            return OFF;
+        }
+        Rule rule;
+        if (action != OFF && rule.parse(p_config.getRule()) && rule.states > 2)
+        {
+            std::cout << "The cycles of " << p_config.getRule() << " are not detected: only the alive cells are hashed,"
+                         " not the dying states\n";
+            return OFF;
+        }
+        if (action == SKIP && (p_config.getEngine() == "hashlife" || p_config.getEngine() == "sparse"))
+        {
+            std::cout << "The " << p_config.getEngine() << " engine computes the cells outside of its window:"
+                         " the periods are not skipped\n";
+            return DETECT;
+        }
+        return (Action)action;
+    }
+
+    std::cout << "Unknown cycle action " << p_config.getCycle() << ", the cycles are not detected\n";
+    return OFF;
+}
+
+CycleDetector::CycleDetector(const unsigned p_history)
+    :   m_history   (std::max(2u, p_history), 0)
+{
+}
+
+void CycleDetector::reset(Engine& p_engine)
+{
+    p_engine.setTrackChanges(true);
+    m_period = 0;
+    restart(p_engine);
+}
+
+bool CycleDetector::update(const Engine& p_engine)
+{
+    if (p_engine.getGeneration() != m_generation + 1 || !p_engine.isTrackingChanges())
+    {
+        restart(p_engine);
+        return false;
+    }
+
+    // The changed cells are exactly the ones whose number enters or leaves the hash
+    const auto& changes = p_engine.getChanges();
+    m_hash ^= hashCells(changes.data(), changes.size());
+    m_generation = p_engine.getGeneration();
+    return push();
+}
+
+void CycleDetector::restart(const Engine& p_engine)
+{
+    m_cells.resize((std::size_t)p_engine.getChangesWordsPerRow() * p_engine.getSimY());
+    p_engine.getCells(m_cells.data());
+    m_hash       = hashCells(m_cells.data(), m_cells.size());
+    m_generation = p_engine.getGeneration();
+    m_first      = m_generation;
+    m_candidate  = 0;
+    m_latest.clear();
+    push();
+}
+
+std::uint64_t CycleDetector::hashCells(const std::uint64_t* p_words, const std::size_t p_count)
+{
+    std::uint64_t hash = 0;
+    for (std::size_t i = 0; i < p_count; ++i)
+    {
+        for (std::uint64_t word = p_words[i]; word; word &= word - 1)
+        {
+            hash ^= CounterRandom::get(HASH_KEY, i * 64 + (std::uint64_t)__builtin_ctzll(word));
+        }
+    }
+    return hash;
+}
+
+bool CycleDetector::push()
+{
+    const std::size_t size = m_history.size();
+    std::uint64_t& slot = m_history[m_generation % size];
+
+    // The slot held the generation leaving the history
+    if (m_generation >= m_first + size)
+    {
+        auto latest = m_latest.find(slot);
+        if (latest != m_latest.end() && latest->second == m_generation - size)
+            m_latest.erase(latest);
+    }
+
+    // A candidate period is confirmed once every generation of a whole period repeated
+    bool found = false;
+    const unsigned period = m_period ? m_period : m_candidate;
+    if (period && m_hash != m_history[(m_generation - period) % size])
+    {
+        m_period    = 0;
+        m_candidate = 0;
+    }
+    else if (m_candidate && m_generation == m_candidateStart + 2 * (std::uint64_t)m_candidate)
+    {
+        m_period     = m_candidate;
+        m_cycleStart = m_candidateStart;
+        m_candidate  = 0;
+        found = true;
+    }
+
+    if (!m_period && !m_candidate)
+    {
+        auto latest = m_latest.find(m_hash);
+        if (latest != m_latest.end())
+        {
+            m_candidate      = (unsigned)(m_generation - latest->second);
+            m_candidateStart = latest->second;
+        }
+    }
+
+    slot = m_hash;
+    m_latest[m_hash] = m_generation;
+    return found;
+}
@@ -0,0 +1,140 @@
+#ifndef CYCLEDETECTOR_H
+#define CYCLEDETECTOR_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \file cycleDetector.h
+ * \brief Definition of the detection of the still lifes and oscillators reached by a simulation.
+ * \author lhm
+ */
+
+class Engine;
+class SimConfig;
+
+/*!
+ * \class CycleDetector
+ * \brief Detects that the grid came back to a previous state, from a hash of the grid.
+ * The hash is the exclusive or of a random number per alive cell (Zobrist hashing, the numbers
+ * being drawn from \a CounterRandom): it is updated from the cells changed by each generation
+ * (see \a Engine::getChanges), at a cost proportional to their number.
+ * The hashes of the last \a getHistory generations are kept, so that the cycles of up to
+ * <em> getHistory() - 1 </em> generations are found (a still life is a cycle of 1 generation).
+ * A cycle is only reported once the hashes repeated during a whole period, which makes the
+ * collisions of the hash negligible.
+ * The next generations only repeat the cycle if the simulation is deterministic: without miracles.
+ * The unbounded engines (hashlife, sparse) only hash the cells of their window: the cells outside of
+ * it may still change, so that their periods are not skipped.
+ */
+class CycleDetector
+{
+    public:
+        static const unsigned DEFAULT_HISTORY = 1024;   /**< default number of hashes kept */
+
+        /*!
+         * \enum Action
+         * \brief What to do once a cycle is found (key \a cycle of the configuration).
+         */
+        enum Action
+        {
+            OFF,                                        /**< no detection */
+            DETECT,                                     /**< reports the cycle */
+            STOP,                                       /**< stops the simulation */
+            SKIP                                        /**< skips the whole periods left to compute */
+        };
+
+        /*!
+         * \function getAction
+         * \brief Returns the action configured, \a OFF with miracles (the simulation is not deterministic)
+         * or for the "Generations" rules (the dying states are not hashed), and \a DETECT instead of
+         * \a SKIP for the unbounded engines.
+         * \param p_config the configuration of the simulation
+         */
+        static Action getAction(const SimConfig& p_config);
+
+        /*!
+         * \function CycleDetector
+         * \brief Creates a detector of the cycles of up to <em> p_history - 1 </em> generations.
+         * \param p_history the number of hashes kept
+         */
+        explicit CycleDetector(const unsigned p_history = DEFAULT_HISTORY);
+
+        /*!
+         * \function reset
+         * \brief Hashes every cell of an engine, and forgets the previous generations.
+         * The changes of the engine are tracked from now on.
+         * \param p_engine the engine
+         */
+        void reset(Engine& p_engine);
+
+        /*!
+         * \function update
+         * \brief Updates the hash, to be called after each generation of the engine given to \a reset.
+         * The hash is computed again from every cell if generations were skipped.
+         * \param p_engine the engine
+         * \return true if the generation completes the first period of a cycle.
+         */
+        bool update(const Engine& p_engine);
+
+        /*!
+         * Returns true if a cycle was found
+         */
+        bool isCycling() const { return m_period != 0; }
+
+        /*!
+         * Get the number of generations of the cycle found (0 if none)
+         */
+        unsigned getPeriod() const { return m_period; }
+
+        /*!
+         * Get the first generation known to belong to the cycle found
+         */
+        std::uint64_t getCycleStart() const { return m_cycleStart; }
+
+        /*!
+         * Get the hash of the current generation
+         */
+        std::uint64_t getHash() const { return m_hash; }
+
+        /*!
+         * Get the number of hashes kept
+         */
+        unsigned getHistory() const { return (unsigned)m_history.size(); }
+
+    protected:
+        /*!
+         * \function restart
+         * \brief Hashes every cell of the engine, and forgets the previous generations.
+         */
+        void restart(const Engine& p_engine);
+
+        /*!
+         * \function hashCells
+         * \brief Returns the exclusive or of the numbers of the cells set in a bitmap laid out as \a Engine::getChanges.
+         */
+        static std::uint64_t hashCells(const std::uint64_t* p_words, const std::size_t p_count);
+
+        /*!
+         * \function push
+         * \brief Adds the hash of the current generation to the history, and looks for a cycle.
+         * \return true if the generation completes the first period of a cycle.
+         */
+        bool push();
+
+    private:
+        std::uint64_t m_hash = 0;                       /**< hash of the current generation */
+        std::uint64_t m_generation = 0;                 /**< current generation */
+        std::uint64_t m_first = 0;                      /**< first generation of the history */
+        std::vector<std::uint64_t> m_history;           /**< hash of each generation, at index generation % size */
+        std::unordered_map<std::uint64_t, std::uint64_t> m_latest;  /**< last generation of each hash of the history */
+        std::vector<std::uint64_t> m_cells;             /**< cells, when hashed again */
+        unsigned m_candidate = 0;                       /**< period being confirmed (0 if none) */
+        std::uint64_t m_candidateStart = 0;             /**< generation whose state repeated first */
+        unsigned m_period = 0;                          /**< period of the cycle found (0 if none) */
+        std::uint64_t m_cycleStart = 0;                 /**< first generation of the cycle found */
+};
+
+#endif // CYCLEDETECTOR_H
@@ -0,0 +1,229 @@
+#include "densityPyramid.h"
+#include <algorithm>
+
+/**
+ * \file densityPyramid.cpp
+ * \brief Implementation of the functions defined in \a densityPyramid.h
+ * The blocks of a tile are computed from exact counts of alive cells: the 4 x 4 and 8 x 8 blocks are
+ * counted 8 at a time in the bytes of a word, then each level sums the 4 blocks below. Above the tiles,
+ * the density of a block is the mean of the densities of its 4 blocks.
+ * \author lhm
+ */
+
+DensityPyramid::DensityPyramid(const unsigned p_simX, const unsigned p_simY)
+    :   m_simX          (p_simX)
+    ,   m_simY          (p_simY)
+    ,   m_wordsPerRow   ((p_simX + 63) / 64)
+    ,   m_tileCells     ((std::size_t)m_wordsPerRow * p_simY)
+{
+    // The last level holds a single block, and the levels of a tile always exist
+    m_levelCount = TILE_LEVEL;
+    while ((1ULL << m_levelCount) < std::max(p_simX, p_simY))
+    {
+        ++m_levelCount;
+    }
+    ++m_levelCount;
+
+    m_levels.resize(m_levelCount);
+    m_stale.resize(m_levelCount);
+    for (unsigned level = FIRST_LEVEL; level < m_levelCount; ++level)
+    {
+        m_levels[level].assign((std::size_t)getWidth(level) * getHeight(level), 0);
+        if (level > TILE_LEVEL)
+        {
+            m_stale[level].assign(m_levels[level].size(), 0);
+        }
+    }
+
+    m_tileStale.assign((std::size_t)getWidth(TILE_LEVEL) * getHeight(TILE_LEVEL), 1);
+    m_tileOutdated.assign(m_tileStale.size(), 0);
+}
+
+void DensityPyramid::invalidate()
+{
+    std::fill(m_tileStale.begin(), m_tileStale.end(), 1);
+}
+
+void DensityPyramid::refresh(const std::uint64_t* p_cells,
+                             const unsigned p_level,
+                             const unsigned p_xBegin,
+                             const unsigned p_yBegin,
+                             const unsigned p_xEnd,
+                             const unsigned p_yEnd)
+{
+    // Region of each level, down to the tiles
+    auto scale = [&](const unsigned p_value, const unsigned p_to, const unsigned p_limit)
+    {
+        std::uint64_t cells = (std::uint64_t)p_value << p_level;
+        return (unsigned)std::min<std::uint64_t>(p_limit, (cells + (1ULL << p_to) - 1) >> p_to);
+    };
+
+    const unsigned tilesX  = getWidth(TILE_LEVEL);
+    const unsigned txBegin = ((std::uint64_t)p_xBegin << p_level) >> TILE_LEVEL;
+    const unsigned txEnd   = scale(p_xEnd, TILE_LEVEL, tilesX);
+    const unsigned tyEnd   = scale(p_yEnd, TILE_LEVEL, getHeight(TILE_LEVEL));
+    const unsigned first   = std::min(p_level, TILE_LEVEL);
+    const std::uint8_t levels = (std::uint8_t)((2u << TILE_LEVEL) - (1u << first));
+    std::vector<std::uint8_t> changed(tilesX);
+    for (unsigned ty = ((std::uint64_t)p_yBegin << p_level) >> TILE_LEVEL; ty < tyEnd; ++ty)
+    {
+        std::uint8_t* stale    = &m_tileStale[(std::size_t)ty * tilesX];
+        std::uint8_t* outdated = &m_tileOutdated[(std::size_t)ty * tilesX];
+        if (std::find(stale + txBegin, stale + txEnd, 1) == stale + txEnd
+         && std::none_of(outdated + txBegin, outdated + txEnd, [&](std::uint8_t p_levels) { return p_levels & levels; }))
+            continue;
+
+        // Only the tiles whose cells changed are computed again (the rows are read in order)
+        std::fill(changed.begin(), changed.end(), 0);
+        for (unsigned y = ty * TILE_SIZE; y < m_simY && y < (ty + 1) * TILE_SIZE; ++y)
+        {
+            const std::size_t row = (std::size_t)y * m_wordsPerRow;
+            for (unsigned tx = txBegin; tx < txEnd; ++tx)
+            {
+                if (stale[tx] && m_tileCells[row + tx] != p_cells[row + tx])
+                {
+                    changed[tx] = 1;
+                    m_tileCells[row + tx] = p_cells[row + tx];
+                }
+            }
+        }
+
+        // Only the requested level and the ones above are computed: the levels below stay outdated
+        for (unsigned tx = txBegin; tx < txEnd; ++tx)
+        {
+            stale[tx] = 0;
+            if (changed[tx])
+                outdated[tx] = ALL_TILE_LEVELS;
+            if (!(outdated[tx] & levels))
+                continue;
+
+            refreshTile(tx, ty, first);
+            outdated[tx] &= (std::uint8_t)~levels;
+            if (TILE_LEVEL + 1 < m_levelCount)
+            {
+                m_stale[TILE_LEVEL + 1][(std::size_t)(ty / 2) * getWidth(TILE_LEVEL + 1) + tx / 2] = 1;
+            }
+        }
+    }
+
+    for (unsigned level = TILE_LEVEL + 1; level <= p_level && level < m_levelCount; ++level)
+    {
+        const unsigned width = getWidth(level);
+        const unsigned xEnd  = scale(p_xEnd, level, width);
+        const unsigned yEnd  = scale(p_yEnd, level, getHeight(level));
+        for (unsigned y = ((std::uint64_t)p_yBegin << p_level) >> level; y < yEnd; ++y)
+        {
+            for (unsigned x = ((std::uint64_t)p_xBegin << p_level) >> level; x < xEnd; ++x)
+            {
+                auto& stale = m_stale[level][(std::size_t)y * width + x];
+                if (!stale)
+                    continue;
+                stale = 0;
+
+                refreshBlock(level, x, y);
+                if (level + 1 < m_levelCount)
+                {
+                    m_stale[level + 1][(std::size_t)(y / 2) * getWidth(level + 1) + x / 2] = 1;
+                }
+            }
+        }
+    }
+}
+
+void DensityPyramid::refreshTile(const unsigned p_tx, const unsigned p_ty, const unsigned p_first)
+{
+    // Alive cells of each nibble of each group of 4 rows: the even nibbles are summed in the bytes of even, the odd ones in odd
+    const unsigned groups = TILE_SIZE / 4;
+    std::uint64_t even[groups];
+    std::uint64_t odd[groups];
+
+    const std::uint64_t m1 = 0x5555555555555555ULL;
+    const std::uint64_t m2 = 0x3333333333333333ULL;
+    const std::uint64_t m4 = 0x0F0F0F0F0F0F0F0FULL;
+    for (unsigned g = 0; g < groups; ++g)
+    {
+        even[g] = 0;
+        odd[g]  = 0;
+        for (unsigned r = 0; r < 4; ++r)
+        {
+            const unsigned y = p_ty * TILE_SIZE + g * 4 + r;
+            std::uint64_t word = y < m_simY ? m_tileCells[(std::size_t)y * m_wordsPerRow + p_tx] : 0;
+            word = word - ((word >> 1) & m1);
+            word = (word & m2) + ((word >> 2) & m2);
+            even[g] += word & m4;
+            odd[g]  += (word >> 4) & m4;
+        }
+    }
+
+    // Alive cells of each block of the tile, from the 4 x 4 blocks to the whole tile
+    std::uint16_t counts[TILE_LEVEL + 1][groups * groups];
+    for (unsigned g = 0; g < groups && p_first <= 2; ++g)
+    {
+        for (unsigned i = 0; i < 8; ++i)
+        {
+            counts[2][g * 16 + 2 * i]     = (std::uint16_t)((even[g] >> (8 * i)) & 0xFF);
+            counts[2][g * 16 + 2 * i + 1] = (std::uint16_t)((odd[g]  >> (8 * i)) & 0xFF);
+        }
+    }
+    for (unsigned g = 0; g < groups; g += 2)
+    {
+        // A 8 x 8 block is the byte of both nibbles of 2 groups
+        const std::uint64_t sum = even[g] + odd[g] + even[g + 1] + odd[g + 1];
+        for (unsigned i = 0; i < 8; ++i)
+        {
+            counts[3][g / 2 * 8 + i] = (std::uint16_t)((sum >> (8 * i)) & 0xFF);
+        }
+    }
+
+    for (unsigned level = FIRST_LEVEL; level <= TILE_LEVEL; ++level)
+    {
+        const unsigned size = TILE_SIZE >> level;
+        if (level > 3)
+        {
+            const std::uint16_t* below = counts[level - 1];
+            for (unsigned y = 0; y < size; ++y)
+            {
+                for (unsigned x = 0; x < size; ++x)
+                {
+                    counts[level][y * size + x] = below[(2 * y) * 2 * size + 2 * x]     + below[(2 * y) * 2 * size + 2 * x + 1]
+                                                + below[(2 * y + 1) * 2 * size + 2 * x] + below[(2 * y + 1) * 2 * size + 2 * x + 1];
+                }
+            }
+        }
+        if (level < p_first)
+            continue;
+
+        // Density of the blocks inside the grid
+        const unsigned shift  = 2 * level;
+        const unsigned width  = getWidth(level);
+        const unsigned xBegin = p_tx * size;
+        const unsigned yBegin = p_ty * size;
+        const unsigned xEnd   = std::min(width, xBegin + size);
+        const unsigned yEnd   = std::min(getHeight(level), yBegin + size);
+        for (unsigned y = yBegin; y < yEnd; ++y)
+        {
+            std::uint8_t* row = &m_levels[level][(std::size_t)y * width];
+            for (unsigned x = xBegin; x < xEnd; ++x)
+            {
+                row[x] = (std::uint8_t)((counts[level][(y - yBegin) * size + x - xBegin] * 255u + (1u << shift) / 2) >> shift);
+            }
+        }
+    }
+}
+
+void DensityPyramid::refreshBlock(const unsigned p_level, const unsigned p_x, const unsigned p_y)
+{
+    const auto& below  = m_levels[p_level - 1];
+    const unsigned width  = getWidth(p_level - 1);
+    const unsigned height = getHeight(p_level - 1);
+
+    unsigned sum = 0;
+    for (unsigned y = 2 * p_y; y < 2 * p_y + 2 && y < height; ++y)
+    {
+        for (unsigned x = 2 * p_x; x < 2 * p_x + 2 && x < width; ++x)
+        {
+            sum += below[(std::size_t)y * width + x];
+        }
+    }
+    m_levels[p_level][(std::size_t)p_y * getWidth(p_level) + p_x] = (std::uint8_t)((sum + 2) / 4);
+}
@@ -0,0 +1,118 @@
+#ifndef DENSITYPYRAMID_H
+#define DENSITYPYRAMID_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * \file densityPyramid.h
+ * \brief Definition of the mipmap of the density of alive cells, drawn when zoomed out.
+ * \author lhm
+ */
+
+/*!
+ * \class DensityPyramid
+ * \brief Density of alive cells in blocks of <em> 2^level x 2^level </em> cells, from 0 (no alive
+ * cell) to 255 (every cell alive), for each level from \a FIRST_LEVEL up to a single block.
+ * The cells are read from a bitmap laid out as \a Engine::getChanges.
+ * The pyramid is updated lazily by tiles of 64 x 64 cells: once the cells changed (see \a invalidate),
+ * \a refresh only computes again the tiles of the requested region whose cells actually changed,
+ * from the requested level up, then the blocks of the upper levels containing them.
+ */
+class DensityPyramid
+{
+    public:
+        static const unsigned FIRST_LEVEL = 2;          /**< first level stored (the lower ones are cheap to compute) */
+        static const unsigned TILE_LEVEL  = 6;          /**< level of the blocks of a single tile */
+        static const unsigned TILE_SIZE   = 1u << TILE_LEVEL;   /**< size of a tile, in cells */
+        static const std::uint8_t ALL_TILE_LEVELS = (2u << TILE_LEVEL) - (1u << FIRST_LEVEL);   /**< bits of the levels of a tile */
+
+        /*!
+         * \function DensityPyramid
+         * \brief Creates the pyramid of a grid. Every tile is computed by the first \a refresh.
+         * \param p_simX the abscissa of the grid
+         * \param p_simY the ordinate of the grid
+         */
+        DensityPyramid(const unsigned p_simX, const unsigned p_simY);
+
+        /*!
+         * \function invalidate
+         * \brief Records that the cells changed: the tiles are checked again by the next \a refresh.
+         */
+        void invalidate();
+
+        /*!
+         * \function refresh
+         * \brief Brings up to date the blocks of a region of a level.
+         * \param p_cells the bitmap of the alive cells
+         * \param p_level the level of the region (at least \a FIRST_LEVEL)
+         * \param p_xBegin the first block abscissa of the region
+         * \param p_yBegin the first block ordinate of the region
+         * \param p_xEnd the past-the-end block abscissa of the region
+         * \param p_yEnd the past-the-end block ordinate of the region
+         */
+        void refresh(const std::uint64_t* p_cells,
+                     const unsigned p_level,
+                     const unsigned p_xBegin,
+                     const unsigned p_yBegin,
+                     const unsigned p_xEnd,
+                     const unsigned p_yEnd);
+
+        /*!
+         * Get the number of levels, the last one being a single block
+         */
+        unsigned getLevelCount() const { return m_levelCount; }
+
+        /*!
+         * Get the number of blocks of a row of a level
+         */
+        unsigned getWidth(const unsigned p_level) const { return (m_simX + (1u << p_level) - 1) >> p_level; }
+
+        /*!
+         * Get the number of rows of blocks of a level
+         */
+        unsigned getHeight(const unsigned p_level) const { return (m_simY + (1u << p_level) - 1) >> p_level; }
+
+        /*!
+         * \function getRow
+         * \brief Returns the densities of a row of blocks of a level (see \a refresh).
+         * \param p_level the level (at least \a FIRST_LEVEL)
+         * \param p_y the ordinate of the row
+         */
+        const std::uint8_t* getRow(const unsigned p_level, const unsigned p_y) const
+        {
+            return &m_levels[p_level][(std::size_t)p_y * getWidth(p_level)];
+        }
+
+    protected:
+        /*!
+         * \function refreshTile
+         * \brief Computes the blocks of the levels \a p_first to \a TILE_LEVEL of a tile, from \a m_tileCells.
+         * \param p_tx the abscissa of the tile
+         * \param p_ty the ordinate of the tile
+         * \param p_first the first level to compute
+         */
+        void refreshTile(const unsigned p_tx, const unsigned p_ty, const unsigned p_first);
+
+        /*!
+         * \function refreshBlock
+         * \brief Computes a block of a level above \a TILE_LEVEL from its 4 blocks of the level below.
+         * \param p_level the level of the block
+         * \param p_x the abscissa of the block
+         * \param p_y the ordinate of the block
+         */
+        void refreshBlock(const unsigned p_level, const unsigned p_x, const unsigned p_y);
+
+    private:
+        const unsigned m_simX;                          /**< abscissa of the grid */
+        const unsigned m_simY;                          /**< ordinate of the grid */
+        const unsigned m_wordsPerRow;                   /**< number of words of a row of the bitmap */
+        unsigned m_levelCount;                          /**< number of levels */
+        std::vector<std::vector<std::uint8_t>> m_levels;    /**< densities of each level (the first ones are empty) */
+        std::vector<std::vector<std::uint8_t>> m_stale;     /**< blocks above \a TILE_LEVEL to compute again */
+        std::vector<std::uint8_t> m_tileStale;          /**< tiles whose cells may have changed */
+        std::vector<std::uint8_t> m_tileOutdated;       /**< levels of each tile not computed from \a m_tileCells */
+        std::vector<std::uint64_t> m_tileCells;         /**< cells the tiles were computed from */
+};
+
+#endif // DENSITYPYRAMID_H
@@ -0,0 +1,328 @@
+#include "simConfig.h"
+#include "engine.h"
+#include "checkpoint.h"
+#include "pattern.h"
+#include "domainWorker.h"
+#include "shmTransport.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/*!
+ * \file distributed.cpp
+ * \brief main file of the distributed runner.
+ * Splits the grid into bands of rows (sub-domains), each computed by its own worker process
+ * (see \a DomainWorker), so that no process holds the engine of the whole grid. The workers
+ * exchange the rows of the edges of their bands at every generation through shared memory
+ * (see \a ShmTransport); this process is the coordinator: it sends the initial cells to the
+ * workers, sums their statistics and saves the checkpoints.
+ * The statistics of every \a interval generations (population) are written to a CSV file (-S, -i).
+ * The simulation can be resumed from a checkpoint (-l), saved to a checkpoint at the end of the
+ * run and every \a interval generations (-o, -k). Only the coordinator holds the whole grid, one
+ * bit per cell, to start and save the simulation.
+ * Only the bounded engines (life, bit, rule, lookup) can compute a band. The generations, miracles
+ * included, are exactly the ones of a single process (see \a headless.cpp).
+ * Usage: <em> distributed [-w workers] [-n generations] [-x simX] [-y simY] [-e engine] [-r rule] [-s seed]
+ * [-t threads per worker] [-c config file] [-l checkpoint] [-o checkpoint] [-k interval] [-S statistics file] [-i interval] </em>
+ * Linux only: the workers are run by \a fork and exchange their rows through POSIX shared memory.
+ * \author lhm
+ */
+
+#ifdef _WIN32
+
+int main()
+{
+    std::cout << "The distributed runner runs its workers in processes sharing memory: it runs on Linux only\n";
+    return 1;
+}
+
+#else
+
+namespace
+{
+    void usage(const char* p_name)
+    {
+        std::cout << "Usage: " << p_name << " [-w workers] [-n generations] [-x simX] [-y simY] [-e engine] [-r rule] [-s seed]"
+                  << " [-t threads per worker] [-c config file] [-l checkpoint] [-o checkpoint] [-k interval]"
+                  << " [-S statistics file] [-i interval]\n";
+    }
+
+    /*!
+     * Processes of the workers, and their status once ended
+     */
+    struct Workers
+    {
+        unsigned running = 0;                           /**< number of workers not ended */
+        bool failed = false;                            /**< true if a worker failed */
+
+        /*!
+         * Collects the ended workers, waiting for them if requested; returns false if one failed
+         */
+        bool collect(const bool p_wait)
+        {
+            int status = 0;
+            pid_t pid;
+            while (running > 0 && (pid = waitpid(-1, &status, p_wait ? 0 : WNOHANG)) > 0)
+            {
+                --running;
+                failed |= !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+            }
+            return !failed;
+        }
+    };
+
+    /*!
+     * Receives the rows of the band of a worker into the bitmap of the grid
+     */
+    bool receiveBand(Transport& p_transport, const unsigned p_worker, const unsigned p_simY, const unsigned p_wordsPerRow,
+                     std::vector<std::uint64_t>& p_cells)
+    {
+        const unsigned begin = DomainWorker::getBandBegin(p_simY, p_transport.getWorkerCount(), p_worker);
+        const unsigned end   = DomainWorker::getBandBegin(p_simY, p_transport.getWorkerCount(), p_worker + 1);
+        return p_transport.receiveFrom(p_worker, &p_cells[(std::size_t)begin * p_wordsPerRow], (std::size_t)(end - begin) * p_wordsPerRow);
+    }
+
+    /*!
+     * Sends the generation and the rows of its band to each worker
+     */
+    bool sendBands(Transport& p_transport, std::uint64_t p_generation, const unsigned p_simY, const unsigned p_wordsPerRow,
+                   const std::vector<std::uint64_t>& p_cells)
+    {
+        for (unsigned worker = 0; worker < p_transport.getWorkerCount(); ++worker)
+        {
+            const unsigned begin = DomainWorker::getBandBegin(p_simY, p_transport.getWorkerCount(), worker);
+            const unsigned end   = DomainWorker::getBandBegin(p_simY, p_transport.getWorkerCount(), worker + 1);
+            if (!p_transport.sendTo(worker, &p_generation, 1)
+             || !p_transport.sendTo(worker, &p_cells[(std::size_t)begin * p_wordsPerRow], (std::size_t)(end - begin) * p_wordsPerRow))
+                return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const char* configFile = "config.txt";
+    unsigned workerCount = std::max(1u, std::thread::hardware_concurrency());
+    unsigned generations = 1000;
+    unsigned simX = 0;
+    unsigned simY = 0;
+    const char* engineName = nullptr;
+    const char* rule = nullptr;
+    unsigned threads = 1;
+    const char* seed = nullptr;
+    const char* resume = nullptr;
+    const char* checkpoint = nullptr;
+    unsigned interval = 0;
+    const char* statisticsFile = nullptr;
+    unsigned reportInterval = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (i + 1 < argc && !std::strcmp(argv[i], "-w"))
+            workerCount = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-n"))
+            generations = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-x"))
+            simX = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-y"))
+            simY = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-e"))
+            engineName = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-r"))
+            rule = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-s"))
+            seed = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-t"))
+            threads = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-c"))
+            configFile = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-l"))
+            resume = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-o"))
+            checkpoint = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-k"))
+            interval = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-S"))
+            statisticsFile = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-i"))
+            reportInterval = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    SimConfig conf;
+    conf.loadConfig(configFile);
+    if (simX)
+        conf.setSimX(simX);
+    if (simY)
+        conf.setSimY(simY);
+    if (engineName)
+        conf.setEngine(engineName);
+    if (rule)
+        conf.setRule(rule);
+    if (seed)
+        conf.setSeed(std::strtoull(seed, nullptr, 10));
+    conf.setThreadCount(threads);
+    if (resume)
+        conf.setResumeFile(resume);
+
+    if (conf.getEngine() != "life" && conf.getEngine() != "bit" && conf.getEngine() != "rule" && conf.getEngine() != "lookup")
+    {
+        std::cout << "The " << conf.getEngine() << " engine cannot compute a band of the grid (life, bit, rule or lookup)\n";
+        return 1;
+    }
+
+    // The initial cells: the ones of the checkpoint, of the pattern or the random ones of Engine::create.
+    // No engine of the whole grid is created: the coordinator only holds a bit per cell
+    std::vector<std::uint64_t> cells;
+    std::uint64_t generation = 0;
+    if (!conf.getResumeFile().empty())
+    {
+        Checkpoint state;
+        if (!state.load(conf.getResumeFile()))
+            return 1;
+        state.configure(conf);
+        cells = state.getCells();
+        generation = state.getGeneration();
+    }
+    else
+    {
+        cells.assign((std::size_t)(conf.getSimX() + 63) / 64 * conf.getSimY(), 0);
+        if (!conf.getPatternFile().empty())
+            Pattern::load(conf.getPatternFile(), conf.getPatternX(), conf.getPatternY(), conf.getSimX(), conf.getSimY(), cells.data());
+        else
+            Engine::getRandomCells(conf.getSeed(), conf.getSimX(), conf.getSimY(), cells.data());
+    }
+
+    // The workers only send the alive cells of their bands: the dying states would be lost
+    if ((checkpoint || !conf.getResumeFile().empty()) && Checkpoint::getPlaneCount(conf.getRule()) > 0)
+    {
+        std::cout << "The checkpoints of the distributed runner only hold the alive cells: " << conf.getRule()
+                  << " has dying states\n";
+        return 1;
+    }
+
+    const unsigned wordsPerRow = (conf.getSimX() + 63) / 64;
+    workerCount = std::max(1u, std::min(workerCount, conf.getSimY()));
+    if (cells.empty())
+    {
+        std::cout << "The grid is empty\n";
+        return 1;
+    }
+
+    // A ring holds at least the rows of two generations (see DomainWorker::exchangeHalo)
+    ShmTransport transport;
+    const std::size_t ringWords = std::max((std::size_t)ShmTransport::DEFAULT_RING_WORDS, 2 * (std::size_t)wordsPerRow);
+    if (!transport.create("/cellAutomaton-" + std::to_string(getpid()), workerCount, ringWords))
+        return 1;
+
+    std::cout << "Engine:         " << conf.getEngine() << '\n';
+    std::cout << "Rule:           " << conf.getRule() << '\n';
+    std::cout << "Workers:        " << workerCount << '\n';
+    std::cout.flush();
+
+    Workers workers;
+    for (unsigned i = 0; i < workerCount; ++i)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            transport.setWorker(i);
+            DomainWorker worker(conf, transport, i);
+            const bool done = worker.run(generations, reportInterval, checkpoint ? interval : 0, checkpoint != nullptr);
+            std::cout.flush();
+            _exit(done ? 0 : 1);
+        }
+        if (pid < 0)
+        {
+            std::cout << "Unable to start worker " << i << '\n';
+            transport.abort();
+            break;
+        }
+        ++workers.running;
+    }
+
+    // A worker that died would never send its rows
+    transport.setWaitHook([&workers]() { return workers.collect(false); });
+
+    std::ofstream statistics;
+    if (statisticsFile)
+    {
+        statistics.open(statisticsFile);
+        statistics << "generation,population\n";
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool valid = workers.running == workerCount && sendBands(transport, generation, conf.getSimY(), wordsPerRow, cells);
+
+    // Without generation, the cells are the initial ones; the grid is only needed again to save it
+    std::uint64_t population = 0;
+    if (generations == 0)
+    {
+        for (const std::uint64_t word : cells)
+            population += (std::uint64_t)__builtin_popcountll(word);
+    }
+    if (!checkpoint)
+        std::vector<std::uint64_t>().swap(cells);
+
+    for (std::uint64_t done = 1; valid && done <= generations; ++done)
+    {
+        if (!DomainWorker::isReported(done, generations, reportInterval, checkpoint ? interval : 0))
+            continue;
+
+        bool hasCells = false;
+        population = 0;
+        for (unsigned worker = 0; valid && worker < workerCount; ++worker)
+        {
+            DomainWorker::Report report;
+            valid = transport.receiveFrom(worker, reinterpret_cast<std::uint64_t*>(&report), DomainWorker::REPORT_WORDS)
+                 && (!report.cells || receiveBand(transport, worker, conf.getSimY(), wordsPerRow, cells));
+            population += report.population;
+            generation  = report.generation;
+            hasCells   |= report.cells != 0;
+        }
+
+        if (valid && statistics.is_open())
+            statistics << generation << ',' << population << '\n';
+        if (valid && hasCells && Checkpoint(conf, generation, cells.data()).save(checkpoint))
+            std::cout << "Checkpoint:     " << checkpoint << " (generation " << generation << ")\n";
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    // The workers waiting for a failed one are released
+    if (!valid)
+        transport.abort();
+    if (!workers.collect(true) || !valid)
+    {
+        std::cout << "The simulation failed\n";
+        return 1;
+    }
+
+    double seconds = elapsed.count() > 0 ? elapsed.count() : 1e-9;
+    std::cout << "Grid:           " << conf.getSimX() << " x " << conf.getSimY() << '\n';
+    std::cout << "Generations:    " << generation << '\n';
+    std::cout << "Population:     " << population << '\n';
+    std::cout << "Elapsed (s):    " << elapsed.count() << '\n';
+    std::cout << "Generations/s:  " << generations / seconds << '\n';
+    std::cout << "Cells/s:        " << generations * (double)conf.getSimX() * conf.getSimY() / seconds << '\n';
+    if (generations == 0 && checkpoint && Checkpoint(conf, generation, cells.data()).save(checkpoint))
+        std::cout << "Checkpoint:     " << checkpoint << " (generation " << generation << ")\n";
+}
+
+#endif // _WIN32
@@ -0,0 +1,111 @@
+#include "domainWorker.h"
+
+#include <algorithm>
+#include <iostream>
+
+/**
+ * \file domainWorker.cpp
+ * \brief Implementation of the functions defined in \a domainWorker.h
+ * \author lhm
+ */
+
+DomainWorker::DomainWorker(const SimConfig& p_config, Transport& p_transport, const unsigned p_worker)
+    :   m_config    (p_config)
+    ,   m_transport (p_transport)
+    ,   m_worker    (p_worker)
+    ,   m_bandBegin (getBandBegin(p_config.getSimY(), p_transport.getWorkerCount(), p_worker))
+    ,   m_rows      (getBandBegin(p_config.getSimY(), p_transport.getWorkerCount(), p_worker + 1) - m_bandBegin)
+    ,   m_hasAbove  (p_worker > 0 || p_config.getBoundary() == "torus")
+    ,   m_hasBelow  (p_worker + 1 < p_transport.getWorkerCount() || p_config.getBoundary() == "torus")
+{
+    // The cells come from the coordinator
+    m_config.setSimY(m_rows + 2);
+    m_config.setPatternFile("");
+    m_config.setResumeFile("");
+    m_config.setRecordFile("");
+}
+
+bool DomainWorker::run(const std::uint64_t p_generations, const unsigned p_reportInterval, const unsigned p_cellsInterval, const bool p_lastCells)
+{
+    // Dead cells until the band is received
+    m_engine = Engine::create(m_config, nullptr);
+    if (!m_engine)
+    {
+        std::cout << "Worker " << m_worker << ": unknown engine " << m_config.getEngine() << '\n';
+        m_transport.abort();
+        return false;
+    }
+
+    // The band is received between the rows of the halo
+    const unsigned wordsPerRow = m_engine->getChangesWordsPerRow();
+    std::uint64_t generation = 0;
+    m_row.assign(wordsPerRow, 0);
+    m_band.assign((std::size_t)wordsPerRow * (m_rows + 2), 0);
+    if (!m_transport.receive(Transport::COORDINATOR, &generation, 1)
+     || !m_transport.receive(Transport::COORDINATOR, &m_band[wordsPerRow], (std::size_t)wordsPerRow * m_rows))
+        return false;
+    m_engine->setCells(m_band.data());
+    m_engine->setGeneration(generation);
+
+    // The row 0 of the engine is the halo above the band
+    m_engine->setRowOrigin((int)m_bandBegin - 1);
+
+    for (std::uint64_t done = 0; done < p_generations; )
+    {
+        if (!exchangeHalo())
+            return false;
+        m_engine->step(1);
+        ++done;
+
+        if (!isReported(done, p_generations, p_reportInterval, p_cellsInterval))
+            continue;
+        const bool cells = (p_cellsInterval && done % p_cellsInterval == 0) || (done == p_generations && p_lastCells);
+        if (!report(cells))
+            return false;
+    }
+    return true;
+}
+
+bool DomainWorker::exchangeHalo()
+{
+    // Every row is sent before any is received: the neighbours do the same
+    if (m_hasAbove)
+    {
+        m_engine->getRows(m_row.data(), 1, 2);
+        if (!m_transport.send(Transport::ABOVE, m_row.data(), m_row.size()))
+            return false;
+    }
+    if (m_hasBelow)
+    {
+        m_engine->getRows(m_row.data(), m_rows, m_rows + 1);
+        if (!m_transport.send(Transport::BELOW, m_row.data(), m_row.size()))
+            return false;
+    }
+
+    // The halo of a dead edge is set back to dead cells, as the engine computed them
+    std::fill(m_row.begin(), m_row.end(), 0);
+    if (m_hasAbove && !m_transport.receive(Transport::ABOVE, m_row.data(), m_row.size()))
+        return false;
+    m_engine->setRows(m_row.data(), 0, 1);
+
+    std::fill(m_row.begin(), m_row.end(), 0);
+    if (m_hasBelow && !m_transport.receive(Transport::BELOW, m_row.data(), m_row.size()))
+        return false;
+    m_engine->setRows(m_row.data(), m_rows + 1, m_rows + 2);
+    return true;
+}
+
+bool DomainWorker::report(const bool p_cells)
+{
+    const std::size_t words = (std::size_t)m_engine->getChangesWordsPerRow() * m_rows;
+    m_engine->getRows(m_band.data(), 1, m_rows + 1);
+
+    Report report { m_engine->getGeneration(), 0, p_cells ? 1u : 0u };
+    for (std::size_t i = 0; i < words; ++i)
+    {
+        report.population += (std::uint64_t)__builtin_popcountll(m_band[i]);
+    }
+
+    return m_transport.send(Transport::COORDINATOR, reinterpret_cast<const std::uint64_t*>(&report), REPORT_WORDS)
+        && (!p_cells || m_transport.send(Transport::COORDINATOR, m_band.data(), words));
+}
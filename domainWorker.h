@@ -0,0 +1,127 @@
+#ifndef DOMAINWORKER_H
+#define DOMAINWORKER_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "engine.h"
+#include "simConfig.h"
+#include "transport.h"
+
+/**
+ * \file domainWorker.h
+ * \brief Definition of the workers of a distributed simulation, each computing a band of rows of the grid.
+ * \author lhm
+ */
+
+/*!
+ * \class DomainWorker
+ * \brief Computes a band of rows of the grid (a sub-domain) with its own engine, the rest of the
+ * grid being computed by other workers (see \a distributed.cpp).
+ * The engine holds the band and a row above and below it: the halo, received from the workers of
+ * the neighbour bands before each generation (dead cells at the edges of a dead boundary). The
+ * cells of the rows of the halo computed by the engine are discarded.
+ * The messages exchanged through the \a Transport are, in words:
+ * <ul>
+ * <li> From the coordinator, once: the generation, then the rows of the band (laid out as \a Engine::getCells)
+ * <li> To the workers of the neighbour bands, before each generation: the first row of the band
+ * to the band above, and its last row to the band below
+ * <li> To the coordinator, after each reported generation (see \a isReported): a \a Report, followed
+ * by the rows of the band if \a Report::cells is set
+ * </ul>
+ * The miracles of the band are drawn from the rows of the whole grid (see \a Engine::setRowOrigin):
+ * the generations are exactly the ones of a single engine, whatever the number of workers.
+ */
+class DomainWorker
+{
+    public:
+        /*!
+         * \struct Report
+         * \brief Statistics of the band after a generation, sent to the coordinator.
+         */
+        struct Report
+        {
+            std::uint64_t generation;                   /**< generation of the cells */
+            std::uint64_t population;                   /**< number of alive cells of the band */
+            std::uint64_t cells;                        /**< 1 if the rows of the band follow */
+        };
+
+        static const std::size_t REPORT_WORDS = sizeof(Report) / sizeof(std::uint64_t);   /**< words of a report */
+
+        /*!
+         * \function DomainWorker
+         * \brief Creates the worker of a band: its engine is created by \a run.
+         * \param p_config the configuration of the whole grid
+         * \param p_transport the endpoint of the worker
+         * \param p_worker the index of the worker, 0 for the band at the top of the grid
+         */
+        DomainWorker(const SimConfig& p_config, Transport& p_transport, const unsigned p_worker);
+
+        /*!
+         * \function getBandBegin
+         * \brief Returns the first row of the band of a worker, the bands being as even as possible.
+         * \param p_simY the number of rows of the grid
+         * \param p_workers the number of workers, at most \a p_simY
+         * \param p_worker the worker (\a p_workers for the past-the-end row of the last band)
+         */
+        static unsigned getBandBegin(const unsigned p_simY, const unsigned p_workers, const unsigned p_worker)
+        {
+            return (unsigned)((std::uint64_t)p_simY * p_worker / p_workers);
+        }
+
+        /*!
+         * \function isReported
+         * \brief Returns true if a report is sent after a generation: the last one, and the ones of the
+         * statistics and of the cells requested.
+         * \param p_done the number of generations computed by the run
+         * \param p_generations the number of generations of the run
+         * \param p_reportInterval the number of generations between two reports (0 for the last one only)
+         * \param p_cellsInterval the number of generations between two reports holding the cells (0 for none)
+         */
+        static bool isReported(const std::uint64_t p_done, const std::uint64_t p_generations,
+                               const unsigned p_reportInterval, const unsigned p_cellsInterval)
+        {
+            return p_done == p_generations || (p_reportInterval && p_done % p_reportInterval == 0)
+                || (p_cellsInterval && p_done % p_cellsInterval == 0);
+        }
+
+        /*!
+         * \function run
+         * \brief Receives the band, then computes the generations and sends the reports.
+         * \param p_generations the number of generations to compute
+         * \param p_reportInterval the number of generations between two reports (0 for the last one only)
+         * \param p_cellsInterval the number of generations between two reports holding the cells (0 for none)
+         * \param p_lastCells true if the report of the last generation holds the cells
+         * \return false if the engine cannot be created or the simulation was aborted.
+         */
+        bool run(const std::uint64_t p_generations, const unsigned p_reportInterval, const unsigned p_cellsInterval, const bool p_lastCells);
+
+    protected:
+        /*!
+         * \function exchangeHalo
+         * \brief Sends the edge rows of the band to the neighbour bands, and receives the halo from them.
+         * \return false if the simulation was aborted.
+         */
+        bool exchangeHalo();
+
+        /*!
+         * \function report
+         * \brief Sends the report of the current generation, followed by the rows of the band if requested.
+         * \return false if the simulation was aborted.
+         */
+        bool report(const bool p_cells);
+
+    private:
+        SimConfig m_config;                             /**< configuration of the engine: the band and its halo */
+        Transport& m_transport;                         /**< endpoint of the worker */
+        const unsigned m_worker;                        /**< index of the worker */
+        const unsigned m_bandBegin;                     /**< first row of the band in the grid */
+        const unsigned m_rows;                          /**< number of rows of the band */
+        const bool m_hasAbove;                          /**< true if a band is above (on a torus, the last band is above the first one) */
+        const bool m_hasBelow;                          /**< true if a band is below */
+        std::unique_ptr<Engine> m_engine;               /**< engine of the band and of its halo */
+        std::vector<std::uint64_t> m_row;               /**< row exchanged with a neighbour band */
+        std::vector<std::uint64_t> m_band;              /**< rows of the band, as sent to the coordinator */
+};
+
+#endif // DOMAINWORKER_H
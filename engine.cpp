@@ -0,0 +1,315 @@
+#include "engine.h"
+#include "simConfig.h"
+#include "lifeEngine.h"
+#include "bitEngine.h"
+#include "hashLife.h"
+#include "sparseEngine.h"
+#include "ruleEngine.h"
+#include "lookupEngine.h"
+#include "rule.h"
+#include "pattern.h"
+#include "counterRandom.h"
+#include <algorithm>
+#include <iostream>
+
+/**
+ * \file engine.cpp
+ * \brief Implementation of the functions defined in \a engine.h
+ * \author lhm
+ */
+
+Engine::Engine(const SimConfig& p_config)
+    :   m_pConfig   (&p_config)
+    ,   m_simX      (p_config.getSimX())
+    ,   m_simY      (p_config.getSimY())
+    ,   m_toroidal  (p_config.getBoundary() == "torus")
+{
+    if (!m_toroidal && p_config.getBoundary() != "dead")
+    {
+        std::cout << "Unknown boundary " << p_config.getBoundary() << ", using dead cells\n";
+    }
+
+    unsigned threads = p_config.getThreadCount();
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (threads > 1)
+    {
+        m_pool = std::make_unique<ThreadPool>(threads);
+    }
+
+    // Every tile is computed at the first generation
+    m_activeTiles = p_config.getActiveTiles() && p_config.getMiracleProb() == 0;
+    if (m_activeTiles)
+    {
+        m_tileChanged.assign((std::size_t)getTilesX() * getTilesY(), 1);
+        m_nextTileChanged.assign(m_tileChanged.size(), 0);
+        m_tileActive.assign(m_tileChanged.size(), 0);
+        m_tileRowActive.assign(getTilesY(), 0);
+    }
+}
+
+void Engine::step(unsigned p_generations)
+{
+    if (m_trackChanges)
+    {
+        std::fill(m_changes.begin(), m_changes.end(), 0);
+    }
+
+    for (unsigned i = 0; i < p_generations; ++i)
+    {
+        if (m_activeTiles)
+        {
+            updateActiveTiles();
+        }
+        update();
+        ++m_generation;
+
+        if (m_activeTiles)
+        {
+            m_tileChanged.swap(m_nextTileChanged);
+        }
+    }
+}
+
+void Engine::updateActiveTiles()
+{
+    const unsigned tilesX = getTilesX();
+    const unsigned tilesY = getTilesY();
+    // The tiles of the opposite edges are neighbours on a torus (NONE: no neighbour)
+    const unsigned NONE = ~0u;
+    for (unsigned ty = 0; ty < tilesY; ++ty)
+    {
+        const unsigned rows[3] = { ty > 0          ? ty - 1 : m_toroidal ? tilesY - 1 : NONE, ty,
+                                   ty + 1 < tilesY ? ty + 1 : m_toroidal ? 0          : NONE };
+        m_tileRowActive[ty] = 0;
+        for (unsigned tx = 0; tx < tilesX; ++tx)
+        {
+            const unsigned columns[3] = { tx > 0          ? tx - 1 : m_toroidal ? tilesX - 1 : NONE, tx,
+                                          tx + 1 < tilesX ? tx + 1 : m_toroidal ? 0          : NONE };
+            std::uint8_t active = 0;
+            for (const unsigned y : rows)
+            {
+                for (const unsigned x : columns)
+                {
+                    if (y != NONE && x != NONE)
+                        active |= m_tileChanged[(std::size_t)y * tilesX + x];
+                }
+            }
+            m_tileActive[(std::size_t)ty * tilesX + tx] = active;
+            m_tileRowActive[ty] |= active;
+            m_nextTileChanged[(std::size_t)ty * tilesX + tx] = 0;
+        }
+    }
+}
+
+void Engine::wrapHalo(std::uint8_t* p_cells, const std::size_t p_stride) const
+{
+    if (!m_toroidal || m_simX == 0 || m_simY == 0)
+        return;
+
+    for (unsigned y = 0; y < m_simY; ++y)
+    {
+        std::uint8_t* row = p_cells + y * p_stride;
+        row[-1]     = row[m_simX - 1];
+        row[m_simX] = row[0];
+    }
+
+    // The corners come with the rows, whose halo is already wrapped
+    std::copy(p_cells + (m_simY - 1) * p_stride - 1, p_cells + (m_simY - 1) * p_stride + m_simX + 1, p_cells - p_stride - 1);
+    std::copy(p_cells - 1, p_cells + m_simX + 1, p_cells + m_simY * p_stride - 1);
+}
+
+std::uint64_t Engine::getMiracleKey() const
+{
+    return CounterRandom::getKey(m_pConfig->getSeed(), m_generation);
+}
+
+double Engine::getMiracleProbability() const
+{
+    return std::min(std::max(m_pConfig->getMiracleProb() / 100.0, 0.0), 1.0);
+}
+
+void Engine::setTrackChanges(bool p_track)
+{
+    m_trackChanges = p_track;
+    if (m_trackChanges)
+    {
+        m_changes.assign((std::size_t)getChangesWordsPerRow() * m_simY, 0);
+    }
+    else
+    {
+        m_changes.clear();
+        m_changes.shrink_to_fit();
+    }
+}
+
+void Engine::getCells(std::uint64_t* p_bitmap) const
+{
+    getRows(p_bitmap, 0, m_simY);
+}
+
+void Engine::setCells(const std::uint64_t* p_bitmap)
+{
+    setRows(p_bitmap, 0, m_simY);
+}
+
+void Engine::getRows(std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd) const
+{
+    const unsigned wordsPerRow = getChangesWordsPerRow();
+    for (unsigned y = p_yBegin; y < p_yEnd; ++y)
+    {
+        for (unsigned w = 0; w < wordsPerRow; ++w)
+        {
+            std::uint64_t word = 0;
+            for (unsigned x = w * 64; x < m_simX && x < w * 64 + 64; ++x)
+            {
+                if (getCell(x, y) == Cell::ON)
+                    word |= 1ULL << (x % 64);
+            }
+            p_bitmap[(std::size_t)(y - p_yBegin) * wordsPerRow + w] = word;
+        }
+    }
+}
+
+void Engine::setRows(const std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd)
+{
+    const unsigned wordsPerRow = getChangesWordsPerRow();
+    for (unsigned y = p_yBegin; y < p_yEnd; ++y)
+    {
+        for (unsigned x = 0; x < m_simX; ++x)
+        {
+            bool alive = (p_bitmap[(std::size_t)(y - p_yBegin) * wordsPerRow + x / 64] >> (x % 64)) & 1;
+            if (alive != (getCell(x, y) == Cell::ON))
+                setCell(x, y, alive ? Cell::ON : Cell::OFF);
+        }
+    }
+}
+
+void Engine::getStates(std::uint64_t* p_planes, const unsigned p_count) const
+{
+    const std::size_t words = (std::size_t)getChangesWordsPerRow() * m_simY;
+    if (p_count == 0)
+        return;
+    getCells(p_planes);
+    std::fill(p_planes + words, p_planes + p_count * words, 0);
+}
+
+void Engine::setStates(const std::uint64_t* p_planes, const unsigned p_count)
+{
+    // Only the cells of state 1 are alive
+    const std::size_t words = (std::size_t)getChangesWordsPerRow() * m_simY;
+    if (p_count == 0)
+        return;
+    std::vector<std::uint64_t> alive(p_planes, p_planes + words);
+    for (unsigned plane = 1; plane < p_count; ++plane)
+    {
+        for (std::size_t i = 0; i < words; ++i)
+        {
+            alive[i] &= ~p_planes[plane * words + i];
+        }
+    }
+    setCells(alive.data());
+}
+
+void Engine::markAllTilesChanged()
+{
+    std::fill(m_tileChanged.begin(), m_tileChanged.end(), 1);
+}
+
+namespace
+{
+    std::unique_ptr<Engine> createEngine(const SimConfig& p_config)
+    {
+        const auto& name = p_config.getEngine();
+        if (p_config.getTemporalBlocking() > 1 && name != "bit")
+        {
+            std::cout << "Only the bit engine computes several generations per block: the temporal blocking is ignored\n";
+        }
+        if (name == "rule")
+            return std::make_unique<RuleEngine>(p_config);
+        if (name == "lookup")
+        {
+            // The dying states of the "Generations" rules do not fit in a bit
+            Rule rule;
+            if (rule.parse(p_config.getRule()) && rule.states > 2)
+            {
+                std::cout << "The lookup engine only computes the rules of two states: using the rule engine\n";
+                return std::make_unique<RuleEngine>(p_config);
+            }
+            return std::make_unique<LookupEngine>(p_config);
+        }
+        if (name != "life" && name != "bit" && name != "hashlife" && name != "sparse")
+            return nullptr;
+
+        // The other engines only compute the "Game of life"
+        Rule rule;
+        if (!rule.parse(p_config.getRule()))
+        {
+            std::cout << "Invalid rule " << p_config.getRule() << ", using " << rule.toString() << '\n';
+        }
+        else if (!rule.isConway())
+        {
+            std::cout << "The " << name << " engine only computes B3/S23: using the rule engine\n";
+            return std::make_unique<RuleEngine>(p_config);
+        }
+
+        if ((name == "hashlife" || name == "sparse") && p_config.getBoundary() == "torus")
+        {
+            std::cout << "The " << name << " engine computes an unbounded grid: the boundary is ignored\n";
+        }
+
+        if (name == "life")
+            return std::make_unique<LifeEngine>(p_config);
+        if (name == "bit")
+            return std::make_unique<BitEngine>(p_config);
+        if (name == "hashlife")
+            return std::make_unique<HashLife>(p_config);
+        return std::make_unique<SparseEngine>(p_config);
+    }
+}
+
+std::unique_ptr<Engine> Engine::create(const SimConfig& p_config)
+{
+    auto engine = createEngine(p_config);
+
+    // A resumed simulation gets its cells from the checkpoint instead
+    if (engine && p_config.isRandomInit())
+    {
+        std::vector<std::uint64_t> cells((std::size_t)engine->getChangesWordsPerRow() * engine->getSimY());
+        getRandomCells(p_config.getSeed(), engine->getSimX(), engine->getSimY(), cells.data());
+        engine->setCells(cells.data());
+    }
+    else if (engine && !p_config.getPatternFile().empty() && p_config.getResumeFile().empty())
+    {
+        Pattern::load(p_config, *engine);
+    }
+    return engine;
+}
+
+std::unique_ptr<Engine> Engine::create(const SimConfig& p_config, const std::uint64_t* p_cells)
+{
+    auto engine = createEngine(p_config);
+    if (engine && p_cells)
+    {
+        engine->setCells(p_cells);
+    }
+    return engine;
+}
+
+void Engine::getRandomCells(const std::uint64_t p_seed, const unsigned p_simX, const unsigned p_simY, std::uint64_t* p_bitmap)
+{
+    // No generation has this key: the initial cells are not drawn as the miracles of a generation
+    const std::uint64_t key = CounterRandom::getKey(p_seed, ~0ULL);
+    const unsigned wordsPerRow = (p_simX + 63) / 64;
+    const std::uint64_t lastWordMask = p_simX % 64 ? (1ULL << (p_simX % 64)) - 1 : ~0ULL;
+
+    const std::size_t words = (std::size_t)wordsPerRow * p_simY;
+    for (std::size_t i = 0; i < words; ++i)
+    {
+        p_bitmap[i] = CounterRandom::get(key, i);
+        if (i % wordsPerRow == wordsPerRow - 1)
+            p_bitmap[i] &= lastWordMask;
+    }
+}
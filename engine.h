@@ -0,0 +1,457 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <cstddef>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "threadPool.h"
+#include "counterRandom.h"
+
+/**
+ * \file engine.h
+ * \brief Definition of the interface shared by every simulation engine.
+ * An engine only knows about the grid and the rules of the simulation: it has no
+ * dependency on SFML and can be run without any window (see \a headless.cpp).
+ * \author lhm
+ */
+
+class SimConfig;
+
+/*!
+ * \enum Cell
+ * \brief Enumerate containing the possible states of a cell (dead or alive).
+ */
+enum Cell
+{
+    ON,
+    OFF
+};
+
+/*!
+ * \class Engine
+ * \brief Simulation engine: a grid of cells and the rules used to advance it.
+ */
+class Engine
+{
+    public:
+        static const unsigned TILE_SIZE = 64;           /**< size of the tiles whose activity is tracked */
+
+        /*!
+         * \function Engine
+         * \brief Creates an engine for a grid of the configured size.
+         * \param p_config The configuration of the simulation.
+         */
+        explicit Engine(const SimConfig& p_config);
+
+        /*!
+         * Default destructor
+         */
+        virtual ~Engine() = default;
+
+        /*!
+         * \function create
+         * \brief Factory method: creates the engine named in the configuration, with the cells of
+         * the configured pattern (see \a Pattern) or else random cells. The random cells only depend
+         * on the seed (see \a CounterRandom): every engine starts from the same cells.
+         * \param p_config The configuration of the simulation.
+         * \return the engine, or nullptr if the name is unknown.
+         */
+        static std::unique_ptr<Engine> create(const SimConfig& p_config);
+
+        /*!
+         * \function create
+         * \brief Factory method: creates the engine named in the configuration, with the given cells
+         * instead of the ones of the configuration (none are drawn or read).
+         * \param p_config The configuration of the simulation.
+         * \param p_cells the bitmap of the alive cells, laid out as \a getCells (nullptr for dead cells)
+         * \return the engine, or nullptr if the name is unknown.
+         */
+        static std::unique_ptr<Engine> create(const SimConfig& p_config, const std::uint64_t* p_cells);
+
+        /*!
+         * \function getRandomCells
+         * \brief Writes the random initial cells of a grid into a bitmap, each cell being alive with a
+         * probability of 1/2. The cells only depend on the seed: they are the ones set by \a create.
+         * \param p_seed the seed of the simulation
+         * \param p_simX the abscissa of the grid
+         * \param p_simY the ordinate of the grid
+         * \param p_bitmap the bitmap, laid out as \a getCells
+         */
+        static void getRandomCells(const std::uint64_t p_seed, const unsigned p_simX, const unsigned p_simY, std::uint64_t* p_bitmap);
+
+        /*!
+         * Copy constructor is prohibited.
+         */
+        Engine              (const Engine& other)   = delete;
+
+        /*!
+         * Assignment constructor is prohibited.
+         */
+        Engine& operator=   (const Engine& other)   = delete;
+
+        /*!
+         * \function step
+         * \brief Advances the simulation by the requested number of generations.
+         * \param p_generations the number of generations to compute.
+         */
+        virtual void step(unsigned p_generations = 1);
+
+        /*!
+         * \function getCell
+         * \brief Returns the state of the requested cell.
+         * \param p_x the requested abscissa
+         * \param p_y the requested ordinate
+         */
+        virtual Cell getCell(const unsigned p_x, const unsigned p_y) const = 0;
+
+        /*!
+         * \function setCell
+         * \brief Sets the state of the requested cell.
+         * \param p_x the requested abscissa
+         * \param p_y the requested ordinate
+         * \param p_cell the new state of the cell
+         */
+        virtual void setCell(const unsigned p_x, const unsigned p_y, const Cell p_cell) = 0;
+
+        /*!
+         * \function getCells
+         * \brief Writes the state of every cell into a bitmap, laid out as the changes bitmap (see \a getChanges).
+         * A bit is set for each alive cell. The default implementation calls \a getRows for every row.
+         * \param p_bitmap the bitmap, of <em> getChangesWordsPerRow() * getSimY() </em> words
+         */
+        virtual void getCells(std::uint64_t* p_bitmap) const;
+
+        /*!
+         * \function setCells
+         * \brief Sets the state of every cell of the grid from a bitmap laid out as \a getCells.
+         * The default implementation calls \a setRows for every row.
+         * \param p_bitmap the bitmap, of <em> getChangesWordsPerRow() * getSimY() </em> words
+         */
+        virtual void setCells(const std::uint64_t* p_bitmap);
+
+        /*!
+         * \function getRows
+         * \brief Writes the state of the cells of consecutive rows into a bitmap laid out as \a getCells.
+         * The default implementation calls \a getCell for each cell.
+         * \param p_bitmap the bitmap, of <em> getChangesWordsPerRow() * (p_yEnd - p_yBegin) </em> words
+         * \param p_yBegin the first row
+         * \param p_yEnd the past-the-end row
+         */
+        virtual void getRows(std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd) const;
+
+        /*!
+         * \function setRows
+         * \brief Sets the state of the cells of consecutive rows from a bitmap laid out as \a getRows.
+         * Only the tiles whose cells changed are computed again (see \a useActiveTiles), so that
+         * the rows can be set at every generation (the halo of a sub-domain, see \a DomainWorker).
+         * The default implementation calls \a setCell for each cell.
+         * \param p_bitmap the bitmap, of <em> getChangesWordsPerRow() * (p_yEnd - p_yBegin) </em> words
+         * \param p_yBegin the first row
+         * \param p_yEnd the past-the-end row
+         */
+        virtual void setRows(const std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd);
+
+        /*!
+         * \function getStates
+         * \brief Writes the state of every cell into bit planes laid out as \a getCells: the plane \a b
+         * holds the bit \a b of the state of each cell (0 dead, 1 alive, then the dying states of the
+         * "Generations" rules, see \a Rule). The default implementation, for the engines of two states,
+         * calls \a getCells for the first plane and clears the others.
+         * \param p_planes the planes, of <em> getChangesWordsPerRow() * getSimY() </em> words each
+         * \param p_count the number of planes (see \a Rule::getStateBits)
+         */
+        virtual void getStates(std::uint64_t* p_planes, const unsigned p_count) const;
+
+        /*!
+         * \function setStates
+         * \brief Sets the state of every cell from bit planes laid out as \a getStates.
+         * The default implementation, for the engines of two states, calls \a setCells with the cells
+         * of state 1.
+         * \param p_planes the planes, of <em> getChangesWordsPerRow() * getSimY() </em> words each
+         * \param p_count the number of planes
+         */
+        virtual void setStates(const std::uint64_t* p_planes, const unsigned p_count);
+
+        /*!
+         * Get the simulation abscissa
+         */
+        unsigned getSimX() const { return m_simX; }
+
+        /*!
+         * Get the simulation ordinate
+         */
+        unsigned getSimY() const { return m_simY; }
+
+        /*!
+         * Get the number of generations computed so far
+         */
+        std::uint64_t getGeneration() const { return m_generation; }
+
+        /*!
+         * Set the number of generations computed so far (when resuming a simulation, see \a Checkpoint)
+         */
+        void setGeneration(const std::uint64_t p_generation) { m_generation = p_generation; }
+
+        /*!
+         * Set the row of the whole grid holding the first row of the engine, when the engine computes
+         * a band of the grid (see \a DomainWorker): the miracles are drawn from the rows of the whole grid
+         */
+        void setRowOrigin(const int p_rowOrigin) { m_rowOrigin = p_rowOrigin; }
+
+        /*!
+         * \function setTrackChanges
+         * \brief Enables or disables the tracking of the changed cells (see \a getChanges).
+         * \param p_track true to track the changed cells.
+         */
+        void setTrackChanges(bool p_track);
+
+        /*!
+         * Returns true if the changed cells are tracked
+         */
+        bool isTrackingChanges() const { return m_trackChanges; }
+
+        /*!
+         * \function getChanges
+         * \brief Returns the bitmap of the cells changed by the last call to \a step.
+         * Only the cells turning alive or dead are marked: the steps of the dying states of the
+         * "Generations" rules are not changes (see \a getStates).
+         * Each row is stored in \a getChangesWordsPerRow words, the cell of abscissa \a x
+         * being the bit <em> x % 64 </em> of the word <em> x / 64 </em>.
+         * A cell changing several times during the call is marked even if it recovered its state.
+         */
+        const std::vector<std::uint64_t>& getChanges() const { return m_changes; }
+
+        /*!
+         * Get the number of words of a row of the changes bitmap
+         */
+        unsigned getChangesWordsPerRow() const { return (m_simX + 63) / 64; }
+
+    protected:
+        /*!
+         * \function update
+         * \brief Computes the next generation.
+         */
+        virtual void update() = 0;
+
+        /*!
+         * \function updateActiveTiles
+         * \brief Computes the tiles to compute during the next generation (see \a isTileActive).
+         */
+        void updateActiveTiles();
+
+        /*!
+         * \function getMiracleKey
+         * \brief Returns the key of the random numbers of the generation being computed.
+         * The miracles are drawn from this key and from the row of the cells (see \a CounterRandom),
+         * so that they do not depend on the thread computing them.
+         */
+        std::uint64_t getMiracleKey() const;
+
+        /*!
+         * \function getMiracleProbability
+         * \brief Returns the probability of a miracle for each dead cell, between 0 and 1.
+         */
+        double getMiracleProbability() const;
+
+        /*!
+         * \function forEachMiracle
+         * \brief Runs the task on the cells of a span of a row drawn for a miracle.
+         * Each cell of the row is drawn with the configured probability, but the gaps between
+         * two drawn cells are sampled from the geometric distribution: the cost only depends on
+         * the number of drawn cells. The draws of a row do not depend on the span, and are the ones
+         * of the same row of the whole grid (see \a setRowOrigin).
+         * The task must only give birth to the drawn cells that are dead.
+         * \param p_y the ordinate of the row
+         * \param p_xBegin the first cell of the span
+         * \param p_xEnd the past-the-end cell of the span
+         * \param p_task the task, called with the abscissa of each drawn cell
+         */
+        template<typename Func>
+        void forEachMiracle(const unsigned p_y, const unsigned p_xBegin, const unsigned p_xEnd, Func p_task) const
+        {
+            const double probability = getMiracleProbability();
+            if (probability <= 0)
+                return;
+
+            // Gap before the next drawn cell: floor(log(u) / log(1 - p)), u uniform in (0, 1]
+            const std::uint64_t key   = getMiracleKey();
+            const std::uint64_t draws = (std::uint64_t)(std::uint32_t)((int)p_y + m_rowOrigin) << 32;
+            const double scale = probability < 1 ? 1 / std::log1p(-probability) : 0;
+            double x = 0;
+            for (std::uint64_t k = 0; ; ++k)
+            {
+                x += std::floor(std::log(CounterRandom::uniformReal(key, draws + k)) * scale);
+                if (x >= p_xEnd)
+                    break;
+                if (x >= p_xBegin)
+                    p_task((unsigned)x);
+                x += 1;
+            }
+        }
+
+        /*!
+         * \function forEachRows
+         * \brief Runs the task on every band of rows, on every thread of the engine.
+         * \param p_task the task, called with the first and the past-the-end row of a band
+         */
+        template<typename Func>
+        void forEachRows(Func p_task)
+        {
+            forEachBand(m_simY, p_task);
+        }
+
+        /*!
+         * \function forEachBand
+         * \brief Runs the task on every band of [0, p_count), on every thread of the engine.
+         * \param p_count the number of indexes (rows, rows of tiles...) to process
+         * \param p_task the task, called with the first and the past-the-end index of a band
+         */
+        template<typename Func>
+        void forEachBand(const unsigned p_count, Func p_task)
+        {
+            if (m_pool)
+                m_pool->run(p_count, p_task);
+            else
+                p_task(0u, p_count);
+        }
+
+        /*!
+         * \function useActiveTiles
+         * \brief Returns true if the tiles that cannot change are skipped.
+         * Only the tiles that changed during the last generation, or one of whose neighbours
+         * did, are computed. This is only possible without miracles. A skipped tile is unchanged
+         * since (at least) two generations, so both buffers of the engine already hold its state.
+         */
+        bool useActiveTiles() const { return m_activeTiles; }
+
+        /*!
+         * Get the number of tiles in a row of tiles
+         */
+        unsigned getTilesX() const { return (m_simX + TILE_SIZE - 1) / TILE_SIZE; }
+
+        /*!
+         * Get the number of rows of tiles
+         */
+        unsigned getTilesY() const { return (m_simY + TILE_SIZE - 1) / TILE_SIZE; }
+
+        /*!
+         * \function isTileActive
+         * \brief Returns true if the tile, or one of its neighbours, changed during the last generation.
+         * \param p_tx the abscissa of the tile
+         * \param p_ty the ordinate of the tile
+         */
+        bool isTileActive(const unsigned p_tx, const unsigned p_ty) const
+        {
+            return m_tileActive[(std::size_t)p_ty * getTilesX() + p_tx] != 0;
+        }
+
+        /*!
+         * \function isTileRowActive
+         * \brief Returns true if at least one tile of the row of tiles is active.
+         * \param p_ty the ordinate of the row of tiles
+         */
+        bool isTileRowActive(const unsigned p_ty) const
+        {
+            return m_tileRowActive[p_ty] != 0;
+        }
+
+        /*!
+         * \function setTileChanged
+         * \brief Records that a cell of the tile changed during the generation being computed.
+         * \param p_tx the abscissa of the tile
+         * \param p_ty the ordinate of the tile
+         */
+        void setTileChanged(const unsigned p_tx, const unsigned p_ty)
+        {
+            m_nextTileChanged[(std::size_t)p_ty * getTilesX() + p_tx] = 1;
+        }
+
+        /*!
+         * \function hasTileChanged
+         * \brief Returns true if a cell of the tile already changed during the generation being computed.
+         * \param p_tx the abscissa of the tile
+         * \param p_ty the ordinate of the tile
+         */
+        bool hasTileChanged(const unsigned p_tx, const unsigned p_ty) const
+        {
+            return m_nextTileChanged[(std::size_t)p_ty * getTilesX() + p_tx] != 0;
+        }
+
+        /*!
+         * \function markTileChanged
+         * \brief Forces the computation of the tile of a cell (and of its neighbours) at the next generation.
+         * To be called when a cell is modified outside of a generation.
+         * \param p_x the abscissa of the modified cell
+         * \param p_y the ordinate of the modified cell
+         */
+        void markTileChanged(const unsigned p_x, const unsigned p_y)
+        {
+            if (m_activeTiles)
+                m_tileChanged[(std::size_t)(p_y / TILE_SIZE) * getTilesX() + p_x / TILE_SIZE] = 1;
+        }
+
+        /*!
+         * \function markAllTilesChanged
+         * \brief Forces the computation of every tile at the next generation.
+         * To be called when the whole grid is modified outside of a generation.
+         */
+        void markAllTilesChanged();
+
+        /*!
+         * \function markChanged
+         * \brief Marks a cell in the changes bitmap (only if the changes are tracked).
+         * \param p_x the abscissa of the changed cell
+         * \param p_y the ordinate of the changed cell
+         */
+        void markChanged(const unsigned p_x, const unsigned p_y)
+        {
+            m_changes[(std::size_t)p_y * getChangesWordsPerRow() + p_x / 64] |= 1ULL << (p_x % 64);
+        }
+
+        /*!
+         * Returns true if the opposite edges of the grid are neighbours (toroidal boundary)
+         */
+        bool isToroidal() const { return m_toroidal; }
+
+        /*!
+         * \function wrapHalo
+         * \brief Copies the opposite edges of a grid of one byte per cell into its halo: the rows and
+         * columns around the grid, read as the neighbours of the edges (toroidal boundary).
+         * The halo of a dead boundary is never written, and stays dead.
+         * \param p_cells the cell (0, 0) of the grid
+         * \param p_stride the number of cells of a row, halo included (at least <em> getSimX() + 2 </em>)
+         */
+        void wrapHalo(std::uint8_t* p_cells, const std::size_t p_stride) const;
+
+        /*!
+         * \function getCellIndex
+         * \brief Returns the 1D index of the cell at specified 2D indexes.
+         * \param p_x the requested abscissa
+         * \param p_y the requested ordinate
+         * \return the requested index.
+         */
+        std::size_t getCellIndex(const unsigned p_x, const unsigned p_y) const
+        {
+            return p_x + (std::size_t)p_y * m_simX;
+        }
+
+        const SimConfig* const m_pConfig;               /**< configuration associated to the engine */
+        const unsigned m_simX;                          /**< abscissa of the simulation */
+        const unsigned m_simY;                          /**< ordinate of the simulation */
+        std::uint64_t m_generation = 0;                 /**< number of generations computed so far */
+        int m_rowOrigin = 0;                            /**< row of the whole grid holding the first row (see \a setRowOrigin) */
+        std::unique_ptr<ThreadPool> m_pool;             /**< threads computing a generation (none if single threaded) */
+        const bool m_toroidal;                          /**< true if the opposite edges are neighbours */
+        bool m_activeTiles = false;                     /**< true if the inactive tiles are skipped */
+        std::vector<std::uint8_t> m_tileChanged;        /**< tiles changed during the last generation */
+        std::vector<std::uint8_t> m_nextTileChanged;    /**< tiles changed during the generation being computed */
+        std::vector<std::uint8_t> m_tileActive;         /**< tiles to compute during the generation being computed */
+        std::vector<std::uint8_t> m_tileRowActive;      /**< rows of tiles holding at least one tile to compute */
+        bool m_trackChanges = false;                    /**< true if the changed cells are tracked */
+        std::vector<std::uint64_t> m_changes;           /**< cells changed by the last call to \a step */
+};
+
+#endif // ENGINE_H
@@ -0,0 +1,494 @@
+#include "hashLife.h"
+#include "simConfig.h"
+#include <algorithm>
+#include <iostream>
+
+/**
+ * \file hashLife.cpp
+ * \brief Implementation of the functions defined in \a hashLife.h
+ * \author lhm
+ */
+
+namespace
+{
+    const std::size_t MIN_TABLE_SIZE = 1 << 16;
+
+    std::uint64_t hashChildren(std::uint32_t p_nw, std::uint32_t p_ne, std::uint32_t p_sw, std::uint32_t p_se)
+    {
+        std::uint64_t h = p_nw;
+        h = h * 0x9E3779B97F4A7C15ULL + p_ne;
+        h = h * 0x9E3779B97F4A7C15ULL + p_sw;
+        h = h * 0x9E3779B97F4A7C15ULL + p_se;
+        return h ^ (h >> 29);
+    }
+}
+
+HashLife::HashLife(const SimConfig& p_config)
+    :   Engine      (p_config)
+    ,   m_table     (MIN_TABLE_SIZE, NONE)
+    ,   m_maxNodes  ((std::size_t)p_config.getHashLifeMemory() * 1024 * 1024 / (sizeof(Node) + 2 * sizeof(std::uint32_t)))
+{
+    if (p_config.getMiracleProb() > 0)
+    {
+        std::cout << "HashLife only supports deterministic rules: the miracles are ignored\n";
+    }
+
+    // Dead and alive leaves
+    m_nodes.push_back({ NONE, NONE, NONE, NONE, NONE, 0, 0 });
+    m_nodes.push_back({ NONE, NONE, NONE, NONE, NONE, 0, 1 });
+    m_empty.push_back(0);
+
+    // Dead window, whose cells are set by Engine::create
+    m_root = buildWindow(std::vector<std::uint8_t>((std::size_t)m_simX * m_simY));
+}
+
+void HashLife::setCells(const std::uint64_t* p_bitmap)
+{
+    const unsigned wordsPerRow = getChangesWordsPerRow();
+    std::vector<std::uint8_t> cells((std::size_t)m_simX * m_simY);
+    for (unsigned y = 0; y < m_simY; ++y)
+    {
+        for (unsigned x = 0; x < m_simX; ++x)
+        {
+            cells[getCellIndex(x, y)] = (std::uint8_t)((p_bitmap[(std::size_t)y * wordsPerRow + x / 64] >> (x % 64)) & 1);
+        }
+    }
+    m_root = buildWindow(cells);
+}
+
+void HashLife::step(unsigned p_generations)
+{
+    if (m_trackChanges)
+    {
+        std::fill(m_changes.begin(), m_changes.end(), 0);
+        m_previousRoot = m_root;
+    }
+
+    // Largest jumps first: the memoised results are kept between two identical calls
+    for (int k = 31; k >= 0; --k)
+    {
+        if ((p_generations >> k) & 1)
+        {
+            jump((unsigned)k);
+        }
+    }
+
+    if (m_trackChanges)
+    {
+        std::uint32_t previous = m_previousRoot;
+        while (m_nodes[previous].level < m_nodes[m_root].level)
+            previous = expand(previous);
+        while (m_nodes[m_root].level < m_nodes[previous].level)
+            m_root = expand(m_root);
+
+        const std::int64_t half = getRootHalfSize();
+        markChanges(previous, m_root, -half, -half);
+        m_previousRoot = NONE;
+    }
+}
+
+void HashLife::update()
+{
+    jump(0);
+}
+
+void HashLife::jump(const unsigned p_k)
+{
+    if (p_k != m_stepLog2)
+    {
+        setStepLog2(p_k);
+    }
+
+    // The collection only happens between two jumps: a single jump may exceed the limit
+    if (m_nodes.size() > m_maxNodes)
+    {
+        collect();
+    }
+
+    // Every cell must stay in the result: the pattern is moved in the centre quarter of a
+    // root big enough to advance by 2^p_k generations
+    while (m_nodes[m_root].level < p_k + 2 || !isCentred(m_root))
+    {
+        m_root = expand(m_root);
+    }
+    m_root = expand(m_root);
+    m_root = getResult(m_root);
+
+    m_generation += (std::uint64_t)1 << p_k;
+}
+
+Cell HashLife::getCell(const unsigned p_x, const unsigned p_y) const
+{
+    std::int64_t half = getRootHalfSize();
+    std::int64_t x = (std::int64_t)p_x + half;
+    std::int64_t y = (std::int64_t)p_y + half;
+    if (x >= 2 * half || y >= 2 * half)
+    {
+        return Cell::OFF;
+    }
+
+    std::uint32_t node = m_root;
+    while (m_nodes[node].level > 0)
+    {
+        const Node& n = m_nodes[node];
+        if (n.population == 0)
+        {
+            return Cell::OFF;
+        }
+
+        half = (std::int64_t)1 << (n.level - 1);
+        if (y < half)
+            node = x < half ? n.nw : n.ne;
+        else
+            node = x < half ? n.sw : n.se;
+        x %= half;
+        y %= half;
+    }
+    return node == 1 ? Cell::ON : Cell::OFF;
+}
+
+void HashLife::setCell(const unsigned p_x, const unsigned p_y, const Cell p_cell)
+{
+    while ((std::int64_t)std::max(p_x, p_y) >= getRootHalfSize())
+    {
+        m_root = expand(m_root);
+    }
+
+    const std::int64_t half = getRootHalfSize();
+    m_root = setCell(m_root, -half, -half, p_x, p_y, p_cell == Cell::ON);
+}
+
+std::uint32_t HashLife::getNode(std::uint32_t p_nw, std::uint32_t p_ne, std::uint32_t p_sw, std::uint32_t p_se)
+{
+    if ((m_nodes.size() + 1) * 2 > m_table.size())
+    {
+        rehash(m_table.size() * 2);
+    }
+
+    const std::size_t mask = m_table.size() - 1;
+    std::size_t slot = hashChildren(p_nw, p_ne, p_sw, p_se) & mask;
+    while (m_table[slot] != NONE)
+    {
+        const Node& n = m_nodes[m_table[slot]];
+        if (n.nw == p_nw && n.ne == p_ne && n.sw == p_sw && n.se == p_se)
+        {
+            return m_table[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    const std::uint32_t id = (std::uint32_t)m_nodes.size();
+    const std::uint64_t population = m_nodes[p_nw].population + m_nodes[p_ne].population
+                                   + m_nodes[p_sw].population + m_nodes[p_se].population;
+    m_nodes.push_back({ p_nw, p_ne, p_sw, p_se, NONE, m_nodes[p_nw].level + 1, population });
+    m_table[slot] = id;
+    return id;
+}
+
+std::uint32_t HashLife::getEmpty(const unsigned p_level)
+{
+    while (m_empty.size() <= p_level)
+    {
+        std::uint32_t e = m_empty.back();
+        m_empty.push_back(getNode(e, e, e, e));
+    }
+    return m_empty[p_level];
+}
+
+std::uint32_t HashLife::getResult(const std::uint32_t p_node)
+{
+    const Node n = m_nodes[p_node];
+    if (n.result != NONE)
+    {
+        return n.result;
+    }
+
+    std::uint32_t result;
+    if (n.population == 0)
+    {
+        result = getEmpty(n.level - 1);
+    }
+    else if (n.level == 2)
+    {
+        result = getBaseResult(p_node);
+    }
+    else
+    {
+        const Node nw = m_nodes[n.nw];
+        const Node ne = m_nodes[n.ne];
+        const Node sw = m_nodes[n.sw];
+        const Node se = m_nodes[n.se];
+
+        // Nine overlapping sub-squares of half the size, advanced
+        std::uint32_t r00 = getResult(n.nw);
+        std::uint32_t r01 = getResult(getNode(nw.ne, ne.nw, nw.se, ne.sw));
+        std::uint32_t r02 = getResult(n.ne);
+        std::uint32_t r10 = getResult(getNode(nw.sw, nw.se, sw.nw, sw.ne));
+        std::uint32_t r11 = getResult(getNode(nw.se, ne.sw, sw.ne, se.nw));
+        std::uint32_t r12 = getResult(getNode(ne.sw, ne.se, se.nw, se.ne));
+        std::uint32_t r20 = getResult(n.sw);
+        std::uint32_t r21 = getResult(getNode(sw.ne, se.nw, sw.se, se.sw));
+        std::uint32_t r22 = getResult(n.se);
+
+        // Four quarters made of them, advanced again (full speed) or only centred
+        std::uint32_t q00 = getNode(r00, r01, r10, r11);
+        std::uint32_t q01 = getNode(r01, r02, r11, r12);
+        std::uint32_t q10 = getNode(r10, r11, r20, r21);
+        std::uint32_t q11 = getNode(r11, r12, r21, r22);
+        if (m_stepLog2 >= n.level - 2)
+        {
+            result = getNode(getResult(q00), getResult(q01), getResult(q10), getResult(q11));
+        }
+        else
+        {
+            result = getNode(getCentre(q00), getCentre(q01), getCentre(q10), getCentre(q11));
+        }
+    }
+
+    m_nodes[p_node].result = result;
+    return result;
+}
+
+std::uint32_t HashLife::getBaseResult(const std::uint32_t p_node)
+{
+    // 4x4 cells of the node
+    unsigned cells[4][4];
+    const Node& n = m_nodes[p_node];
+    const std::uint32_t quadrants[4] = { n.nw, n.ne, n.sw, n.se };
+    for (unsigned q = 0; q < 4; ++q)
+    {
+        const Node& child = m_nodes[quadrants[q]];
+        const unsigned x = (q % 2) * 2;
+        const unsigned y = (q / 2) * 2;
+        cells[y][x]         = child.nw;
+        cells[y][x + 1]     = child.ne;
+        cells[y + 1][x]     = child.sw;
+        cells[y + 1][x + 1] = child.se;
+    }
+
+    std::uint32_t next[2][2];
+    for (unsigned y = 1; y <= 2; ++y)
+    {
+        for (unsigned x = 1; x <= 2; ++x)
+        {
+            unsigned count = cells[y - 1][x - 1] + cells[y - 1][x] + cells[y - 1][x + 1]
+                           + cells[y][x - 1]                       + cells[y][x + 1]
+                           + cells[y + 1][x - 1] + cells[y + 1][x] + cells[y + 1][x + 1];
+
+            // Alive cell survives with 2 or 3 neighbours, dead cell is born with 3 neighbours
+            next[y - 1][x - 1] = count == 3 || (count == 2 && cells[y][x]);
+        }
+    }
+    return getNode(next[0][0], next[0][1], next[1][0], next[1][1]);
+}
+
+std::uint32_t HashLife::getCentre(const std::uint32_t p_node)
+{
+    const Node n = m_nodes[p_node];
+    return getNode(m_nodes[n.nw].se, m_nodes[n.ne].sw, m_nodes[n.sw].ne, m_nodes[n.se].nw);
+}
+
+std::uint32_t HashLife::expand(const std::uint32_t p_node)
+{
+    const Node n = m_nodes[p_node];
+    const std::uint32_t e = getEmpty(n.level - 1);
+    std::uint32_t nw = getNode(e, e, e, n.nw);
+    std::uint32_t ne = getNode(e, e, n.ne, e);
+    std::uint32_t sw = getNode(e, n.sw, e, e);
+    std::uint32_t se = getNode(n.se, e, e, e);
+    return getNode(nw, ne, sw, se);
+}
+
+bool HashLife::isCentred(const std::uint32_t p_node) const
+{
+    const Node& n  = m_nodes[p_node];
+    const Node& nw = m_nodes[n.nw];
+    const Node& ne = m_nodes[n.ne];
+    const Node& sw = m_nodes[n.sw];
+    const Node& se = m_nodes[n.se];
+    auto population = [this](std::uint32_t p_id) { return m_nodes[p_id].population; };
+
+    return population(nw.nw) + population(nw.ne) + population(nw.sw)
+         + population(ne.nw) + population(ne.ne) + population(ne.se)
+         + population(sw.nw) + population(sw.sw) + population(sw.se)
+         + population(se.ne) + population(se.sw) + population(se.se) == 0;
+}
+
+std::uint32_t HashLife::setCell(const std::uint32_t p_node, std::int64_t p_x0, std::int64_t p_y0,
+                                std::int64_t p_x, std::int64_t p_y, bool p_alive)
+{
+    const Node n = m_nodes[p_node];
+    if (n.level == 0)
+    {
+        return p_alive ? 1 : 0;
+    }
+
+    const std::int64_t half = (std::int64_t)1 << (n.level - 1);
+    const bool east  = p_x >= p_x0 + half;
+    const bool south = p_y >= p_y0 + half;
+    const std::int64_t x0 = east  ? p_x0 + half : p_x0;
+    const std::int64_t y0 = south ? p_y0 + half : p_y0;
+
+    std::uint32_t nw = n.nw, ne = n.ne, sw = n.sw, se = n.se;
+    std::uint32_t& child = south ? (east ? se : sw) : (east ? ne : nw);
+    child = setCell(child, x0, y0, p_x, p_y, p_alive);
+    return getNode(nw, ne, sw, se);
+}
+
+std::uint32_t HashLife::buildWindow(const std::vector<std::uint8_t>& p_cells)
+{
+    unsigned level = 3;
+    while (((std::int64_t)1 << (level - 1)) < (std::int64_t)std::max(m_simX, m_simY))
+    {
+        ++level;
+    }
+    const std::int64_t half = (std::int64_t)1 << (level - 1);
+    return build(level, -half, -half, p_cells);
+}
+
+std::uint32_t HashLife::build(const unsigned p_level, std::int64_t p_x0, std::int64_t p_y0, const std::vector<std::uint8_t>& p_cells)
+{
+    const std::int64_t size = (std::int64_t)1 << p_level;
+    if (p_x0 + size <= 0 || p_y0 + size <= 0 || p_x0 >= (std::int64_t)m_simX || p_y0 >= (std::int64_t)m_simY)
+    {
+        return getEmpty(p_level);
+    }
+    if (p_level == 0)
+    {
+        return p_cells[getCellIndex((unsigned)p_x0, (unsigned)p_y0)];
+    }
+
+    const std::int64_t half = size / 2;
+    std::uint32_t nw = build(p_level - 1, p_x0,        p_y0,        p_cells);
+    std::uint32_t ne = build(p_level - 1, p_x0 + half, p_y0,        p_cells);
+    std::uint32_t sw = build(p_level - 1, p_x0,        p_y0 + half, p_cells);
+    std::uint32_t se = build(p_level - 1, p_x0 + half, p_y0 + half, p_cells);
+    return getNode(nw, ne, sw, se);
+}
+
+void HashLife::markChanges(const std::uint32_t p_old, const std::uint32_t p_new, std::int64_t p_x0, std::int64_t p_y0)
+{
+    // Canonical nodes: the same node means the same cells
+    if (p_old == p_new)
+    {
+        return;
+    }
+
+    const unsigned level = m_nodes[p_new].level;
+    const std::int64_t size = (std::int64_t)1 << level;
+    if (p_x0 + size <= 0 || p_y0 + size <= 0 || p_x0 >= (std::int64_t)m_simX || p_y0 >= (std::int64_t)m_simY)
+    {
+        return;
+    }
+    if (level == 0)
+    {
+        markChanged((unsigned)p_x0, (unsigned)p_y0);
+        return;
+    }
+
+    const Node o = m_nodes[p_old];
+    const Node n = m_nodes[p_new];
+    const std::int64_t half = size / 2;
+    markChanges(o.nw, n.nw, p_x0,        p_y0);
+    markChanges(o.ne, n.ne, p_x0 + half, p_y0);
+    markChanges(o.sw, n.sw, p_x0,        p_y0 + half);
+    markChanges(o.se, n.se, p_x0 + half, p_y0 + half);
+}
+
+void HashLife::setStepLog2(const unsigned p_k)
+{
+    for (auto& node : m_nodes)
+    {
+        node.result = NONE;
+    }
+    m_stepLog2 = p_k;
+}
+
+void HashLife::collect()
+{
+    // Mark the nodes reachable from the roots
+    std::vector<std::uint8_t> reachable(m_nodes.size(), 0);
+    std::vector<std::uint32_t> stack = { 0, 1, m_root };
+    if (m_previousRoot != NONE)
+    {
+        stack.push_back(m_previousRoot);
+    }
+    stack.insert(stack.end(), m_empty.begin(), m_empty.end());
+
+    while (!stack.empty())
+    {
+        std::uint32_t id = stack.back();
+        stack.pop_back();
+        if (reachable[id])
+            continue;
+
+        reachable[id] = 1;
+        const Node& n = m_nodes[id];
+        if (n.level > 0)
+        {
+            stack.push_back(n.nw);
+            stack.push_back(n.ne);
+            stack.push_back(n.sw);
+            stack.push_back(n.se);
+        }
+    }
+
+    // Compact them: a node is always created after its children, so the order is kept
+    std::vector<std::uint32_t> remap(m_nodes.size(), NONE);
+    std::uint32_t count = 0;
+    for (std::size_t id = 0; id < m_nodes.size(); ++id)
+    {
+        if (reachable[id])
+            remap[id] = count++;
+    }
+    for (std::size_t id = 0; id < m_nodes.size(); ++id)
+    {
+        if (!reachable[id])
+            continue;
+
+        Node n = m_nodes[id];
+        if (n.level > 0)
+        {
+            n.nw = remap[n.nw];
+            n.ne = remap[n.ne];
+            n.sw = remap[n.sw];
+            n.se = remap[n.se];
+        }
+        n.result = n.result != NONE ? remap[n.result] : NONE;
+        m_nodes[remap[id]] = n;
+    }
+    m_nodes.resize(count);
+
+    m_root = remap[m_root];
+    if (m_previousRoot != NONE)
+    {
+        m_previousRoot = remap[m_previousRoot];
+    }
+    for (auto& empty : m_empty)
+    {
+        empty = remap[empty];
+    }
+
+    std::size_t slots = MIN_TABLE_SIZE;
+    while (slots < (std::size_t)count * 2)
+    {
+        slots *= 2;
+    }
+    rehash(slots);
+}
+
+void HashLife::rehash(std::size_t p_slots)
+{
+    m_table.assign(p_slots, NONE);
+    const std::size_t mask = p_slots - 1;
+    for (std::uint32_t id = 2; id < (std::uint32_t)m_nodes.size(); ++id)
+    {
+        const Node& n = m_nodes[id];
+        std::size_t slot = hashChildren(n.nw, n.ne, n.sw, n.se) & mask;
+        while (m_table[slot] != NONE)
+        {
+            slot = (slot + 1) & mask;
+        }
+        m_table[slot] = id;
+    }
+}
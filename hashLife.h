@@ -0,0 +1,193 @@
+#ifndef HASHLIFE_H
+#define HASHLIFE_H
+
+#include <cstdint>
+#include <vector>
+#include "engine.h"
+
+/**
+ * \file hashLife.h
+ * \brief Definition of the HashLife engine, computing huge numbers of generations at once.
+ * \author lhm
+ */
+
+/*!
+ * \class HashLife
+ * \brief Engine storing the universe as a quadtree of canonical (hashed) nodes.
+ * Identical regions of the universe share the same node, and the centre of each node
+ * advanced by \a 2^k generations is memoised in the node, so that repetitive patterns
+ * are computed once and that \a 2^k generations can be jumped at once (see \a jump).
+ * <ul>
+ * <li> The universe is unbounded: the simulation window is its region [0, simX) x [0, simY),
+ *      the cells leaving it keep evolving.
+ * <li> Only the deterministic rules are supported: the miracles are ignored.
+ * <li> The nodes are garbage collected when their memory exceeds <em>"hashlifeMemory"</em> MB.
+ * </ul>
+ */
+class HashLife : public Engine
+{
+    public:
+        /*!
+         * \function HashLife
+         * \brief Creates the engine, with dead cells (see \a Engine::create).
+         * \param p_config The configuration of the simulation.
+         */
+        explicit HashLife(const SimConfig& p_config);
+
+        /*!
+         * \function step
+         * \brief Advances the universe by the requested number of generations.
+         * The number is split into powers of two, each computed by \a jump.
+         * \param p_generations the number of generations to compute.
+         */
+        void step(unsigned p_generations = 1) override;
+
+        /*!
+         * \function jump
+         * \brief Advances the universe by \a 2^p_k generations at once.
+         * \param p_k the base 2 logarithm of the number of generations.
+         */
+        void jump(const unsigned p_k);
+
+        Cell getCell(const unsigned p_x, const unsigned p_y) const override;
+
+        void setCell(const unsigned p_x, const unsigned p_y, const Cell p_cell) override;
+
+        /*!
+         * \function setCells
+         * \brief Rebuilds the universe from the cells of the window: the cells outside of the window are dead.
+         */
+        void setCells(const std::uint64_t* p_bitmap) override;
+
+        /*!
+         * Get the number of alive cells of the whole universe
+         */
+        std::uint64_t getUniversePopulation() const { return m_nodes[m_root].population; }
+
+        /*!
+         * Get the number of nodes currently stored
+         */
+        std::size_t getNodeCount() const { return m_nodes.size(); }
+
+    protected:
+        void update() override;
+
+    private:
+        static const std::uint32_t NONE = 0xFFFFFFFFu;  /**< invalid node */
+
+        /*!
+         * \struct Node
+         * \brief Square of \a 2^level cells: a leaf (level 0) or four children of the level below.
+         */
+        struct Node
+        {
+            std::uint32_t nw, ne, sw, se;               /**< children (none for a leaf) */
+            std::uint32_t result;                       /**< centre advanced by 2^m_stepLog2 generations, or NONE */
+            std::uint32_t level;                        /**< base 2 logarithm of the size of the node */
+            std::uint64_t population;                   /**< number of alive cells */
+        };
+
+        /*!
+         * \function getNode
+         * \brief Returns the canonical node made of the four children, creating it if needed.
+         */
+        std::uint32_t getNode(std::uint32_t p_nw, std::uint32_t p_ne, std::uint32_t p_sw, std::uint32_t p_se);
+
+        /*!
+         * \function getEmpty
+         * \brief Returns the empty node of the requested level.
+         */
+        std::uint32_t getEmpty(const unsigned p_level);
+
+        /*!
+         * \function getResult
+         * \brief Returns the centre of the node (level - 1) advanced by 2^min(m_stepLog2, level - 2) generations.
+         */
+        std::uint32_t getResult(const std::uint32_t p_node);
+
+        /*!
+         * \function getBaseResult
+         * \brief Computes the centre of a node of level 2 advanced by one generation.
+         */
+        std::uint32_t getBaseResult(const std::uint32_t p_node);
+
+        /*!
+         * \function getCentre
+         * \brief Returns the centre (level - 1) of the node, not advanced.
+         */
+        std::uint32_t getCentre(const std::uint32_t p_node);
+
+        /*!
+         * \function expand
+         * \brief Returns a node of the level above with the node at its centre and an empty border.
+         */
+        std::uint32_t expand(const std::uint32_t p_node);
+
+        /*!
+         * \function isCentred
+         * \brief Returns true if every alive cell of the node lies in its centre (level - 1).
+         */
+        bool isCentred(const std::uint32_t p_node) const;
+
+        /*!
+         * \function setCell
+         * \brief Returns the node with the requested cell set.
+         * \param p_node the node, covering [p_x0, p_x0 + 2^level) x [p_y0, p_y0 + 2^level)
+         */
+        std::uint32_t setCell(const std::uint32_t p_node, std::int64_t p_x0, std::int64_t p_y0,
+                              std::int64_t p_x, std::int64_t p_y, bool p_alive);
+
+        /*!
+         * \function build
+         * \brief Builds the node covering [p_x0, p_x0 + 2^level) x [p_y0, p_y0 + 2^level) from the cells of the window.
+         */
+        std::uint32_t build(const unsigned p_level, std::int64_t p_x0, std::int64_t p_y0, const std::vector<std::uint8_t>& p_cells);
+
+        /*!
+         * \function buildWindow
+         * \brief Builds the smallest root centred on the origin covering the cells of the window.
+         * \param p_cells the state of each cell of the window (1 for alive)
+         */
+        std::uint32_t buildWindow(const std::vector<std::uint8_t>& p_cells);
+
+        /*!
+         * \function markChanges
+         * \brief Marks in the changes bitmap the cells of the window that differ between two nodes.
+         * \param p_old the node before the step
+         * \param p_new the node after the step, of the same level and position
+         */
+        void markChanges(const std::uint32_t p_old, const std::uint32_t p_new, std::int64_t p_x0, std::int64_t p_y0);
+
+        /*!
+         * \function setStepLog2
+         * \brief Changes the number of generations memoised in the nodes, forgetting the results.
+         */
+        void setStepLog2(const unsigned p_k);
+
+        /*!
+         * \function collect
+         * \brief Garbage collection: only keeps the nodes reachable from the roots.
+         */
+        void collect();
+
+        /*!
+         * \function rehash
+         * \brief Rebuilds the hash table of the canonical nodes with the requested number of slots.
+         */
+        void rehash(std::size_t p_slots);
+
+        /*!
+         * Get the half size of the root: the root covers [-half, half) x [-half, half)
+         */
+        std::int64_t getRootHalfSize() const { return (std::int64_t)1 << (m_nodes[m_root].level - 1); }
+
+        std::vector<Node> m_nodes;                      /**< every node (0 and 1 are the dead and alive leaves) */
+        std::vector<std::uint32_t> m_table;             /**< hash table of the canonical nodes (open addressing) */
+        std::vector<std::uint32_t> m_empty;             /**< empty node of each level */
+        std::uint32_t m_root;                           /**< root of the universe */
+        std::uint32_t m_previousRoot = NONE;            /**< root before the current step (kept by the collection) */
+        unsigned m_stepLog2 = 0;                        /**< base 2 logarithm of the generations memoised in the nodes */
+        std::size_t m_maxNodes;                         /**< number of nodes triggering a garbage collection */
+};
+
+#endif // HASHLIFE_H
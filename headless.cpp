@@ -0,0 +1,261 @@
+#include "simConfig.h"
+#include "engine.h"
+#include "checkpoint.h"
+#include "recorder.h"
+#include "cycleDetector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+/*!
+ * \file headless.cpp
+ * \brief main file of the headless runner.
+ * Runs a given number of generations without any window and reports the speed of the simulation.
+ * The simulation can be resumed from a checkpoint (-l), saved to a checkpoint at the end of the
+ * run and every \a interval generations (-o, -k), and every generation can be recorded (-R, with a
+ * keyframe every \a keyframes generations).
+ * Without miracles, the run can detect that the grid reached a cycle (-C detect), and then stop (-C stop)
+ * or skip the whole periods left (-C skip, see \a CycleDetector).
+ * A recording is replayed with -P: the requested generation (the last one by default) is read and
+ * can be saved to a checkpoint.
+ * Usage: <em> headless [-n generations] [-x simX] [-y simY] [-e engine] [-r rule] [-s seed] [-t threads] [-c config file]
+ * [-l checkpoint] [-o checkpoint] [-k interval] [-R recording] [-K keyframes] [-C cycle action] </em> \n
+ * or <em> headless -P recording [-g generation] [-o checkpoint] </em>
+ * \author lhm
+ */
+
+namespace
+{
+    void usage(const char* p_name)
+    {
+        std::cout << "Usage: " << p_name << " [-n generations] [-x simX] [-y simY] [-e engine] [-r rule] [-s seed] [-t threads] [-c config file]"
+                  << " [-l checkpoint] [-o checkpoint] [-k interval] [-R recording] [-K keyframes] [-C off|detect|stop|skip]\n"
+                  << "       " << p_name << " -P recording [-g generation] [-o checkpoint]\n";
+    }
+
+    void save(const SimConfig& p_conf, const Engine& p_engine, const char* p_file)
+    {
+        if (p_file && Checkpoint(p_conf, p_engine).save(p_file))
+            std::cout << "Checkpoint:     " << p_file << " (generation " << p_engine.getGeneration() << ")\n";
+    }
+
+    void run(const SimConfig& p_conf, Engine& p_engine, unsigned p_generations, const char* p_checkpoint, unsigned p_interval, Recorder& p_recorder)
+    {
+        const std::uint64_t first = p_engine.getGeneration();
+        const bool periodic = p_interval && p_checkpoint;
+        CycleDetector::Action cycle = CycleDetector::getAction(p_conf);
+        CycleDetector detector(p_conf.getCycleHistory());
+        if (cycle != CycleDetector::OFF)
+            detector.reset(p_engine);
+
+        std::uint64_t skipped = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned done = 0; done < p_generations; )
+        {
+            // A recording and the detection of the cycles need the changes of each generation
+            unsigned count = p_generations - done;
+            if (periodic)
+                count = std::min(count, p_interval - done % p_interval);
+            if (p_recorder.isOpen() || cycle != CycleDetector::OFF)
+                count = 1;
+
+            p_engine.step(count);
+            p_recorder.record(p_engine);
+            done += count;
+
+            if (cycle != CycleDetector::OFF && detector.update(p_engine))
+            {
+                std::cout << "Cycle:          period " << detector.getPeriod() << " from generation "
+                          << detector.getCycleStart() << '\n';
+                if (cycle == CycleDetector::STOP)
+                    break;
+
+                // The state after whole periods is the current one
+                if (cycle == CycleDetector::SKIP)
+                {
+                    const unsigned periods = (p_generations - done) / detector.getPeriod();
+                    skipped = (std::uint64_t)periods * detector.getPeriod();
+                    p_engine.setGeneration(p_engine.getGeneration() + skipped);
+                    done += (unsigned)skipped;
+                }
+                cycle = CycleDetector::OFF;
+            }
+
+            if (periodic && done % p_interval == 0 && done < p_generations)
+                save(p_conf, p_engine, p_checkpoint);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        double cells        = (double)p_engine.getSimX() * p_engine.getSimY();
+        double generations  = (double)(p_engine.getGeneration() - first - skipped);
+        double seconds      = elapsed.count() > 0 ? elapsed.count() : 1e-9;
+
+        std::cout << "Grid:           " << p_engine.getSimX() << " x " << p_engine.getSimY() << '\n';
+        std::cout << "Generations:    " << p_engine.getGeneration() << '\n';
+        if (skipped)
+            std::cout << "Skipped:        " << skipped << '\n';
+        std::cout << "Elapsed (s):    " << elapsed.count() << '\n';
+        std::cout << "Generations/s:  " << generations / seconds << '\n';
+        std::cout << "Cells/s:        " << generations * cells / seconds << '\n';
+        save(p_conf, p_engine, p_checkpoint);
+    }
+
+    int replay(const char* p_file, const char* p_generation, const char* p_checkpoint)
+    {
+        Replay recording;
+        if (!recording.open(p_file))
+            return 1;
+
+        const std::uint64_t generation = p_generation ? std::strtoull(p_generation, nullptr, 10) : recording.getLastGeneration();
+        auto start = std::chrono::steady_clock::now();
+        const bool found = recording.seek(generation);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << "Grid:           " << recording.getSimX() << " x " << recording.getSimY() << '\n';
+        std::cout << "Recorded:       " << recording.getFirstGeneration() << " to " << recording.getLastGeneration()
+                  << " (keyframe every " << recording.getKeyframeInterval() << ")\n";
+        if (!found)
+        {
+            std::cout << "Generation " << generation << " cannot be read\n";
+            return 1;
+        }
+
+        // The state planes follow the alive cells
+        std::uint64_t population = 0;
+        const std::size_t words = (std::size_t)(recording.getSimX() + 63) / 64 * recording.getSimY();
+        for (std::size_t i = 0; i < words; ++i)
+        {
+            population += (std::uint64_t)__builtin_popcountll(recording.getCells()[i]);
+        }
+        std::cout << "Generation:     " << generation << '\n';
+        std::cout << "Population:     " << population << '\n';
+        std::cout << "Seek (s):       " << elapsed.count() << '\n';
+
+        if (p_checkpoint)
+        {
+            SimConfig conf;
+            recording.configure(conf);
+            if (Checkpoint(conf, generation, recording.getCells().data(), recording.getStatePlanes()).save(p_checkpoint))
+                std::cout << "Checkpoint:     " << p_checkpoint << '\n';
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const char* configFile = "config.txt";
+    unsigned generations = 1000;
+    unsigned simX = 0;
+    unsigned simY = 0;
+    const char* engineName = nullptr;
+    const char* rule = nullptr;
+    int threads = -1;
+    const char* seed = nullptr;
+    const char* resume = nullptr;
+    const char* checkpoint = nullptr;
+    unsigned interval = 0;
+    const char* record = nullptr;
+    int keyframes = -1;
+    const char* replayFile = nullptr;
+    const char* replayGeneration = nullptr;
+    const char* cycle = nullptr;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (i + 1 < argc && !std::strcmp(argv[i], "-n"))
+            generations = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-x"))
+            simX = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-y"))
+            simY = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-e"))
+            engineName = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-r"))
+            rule = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-s"))
+            seed = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-t"))
+            threads = (int)std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-c"))
+            configFile = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-l"))
+            resume = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-o"))
+            checkpoint = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-k"))
+            interval = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-R"))
+            record = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-K"))
+            keyframes = (int)std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-P"))
+            replayFile = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-g"))
+            replayGeneration = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-C"))
+            cycle = argv[++i];
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (replayFile)
+        return replay(replayFile, replayGeneration, checkpoint);
+
+    SimConfig conf;
+    conf.loadConfig(configFile);
+    if (simX)
+        conf.setSimX(simX);
+    if (simY)
+        conf.setSimY(simY);
+    if (engineName)
+        conf.setEngine(engineName);
+    if (rule)
+        conf.setRule(rule);
+    if (threads >= 0)
+        conf.setThreadCount((unsigned)threads);
+    if (seed)
+        conf.setSeed(std::strtoull(seed, nullptr, 10));
+
+    if (resume)
+        conf.setResumeFile(resume);
+    if (record)
+        conf.setRecordFile(record);
+    if (keyframes >= 0)
+        conf.setKeyframeInterval((unsigned)keyframes);
+    if (cycle)
+        conf.setCycle(cycle);
+
+    // The size, rule and seed of a resumed simulation are the ones of its checkpoint
+    Checkpoint state;
+    if (!conf.getResumeFile().empty())
+    {
+        if (!state.load(conf.getResumeFile()))
+            return 1;
+        state.configure(conf);
+    }
+
+    auto engine = Engine::create(conf);
+    if (!engine)
+    {
+        std::cout << "Unknown engine: " << conf.getEngine() << '\n';
+        return 1;
+    }
+
+    if (!conf.getResumeFile().empty())
+        state.restore(*engine);
+
+    std::cout << "Engine:         " << conf.getEngine() << '\n';
+    std::cout << "Rule:           " << conf.getRule() << '\n';
+    Recorder recorder;
+    if (!conf.getRecordFile().empty() && !recorder.open(conf.getRecordFile(), conf, *engine, conf.getKeyframeInterval()))
+        return 1;
+
+    run(conf, *engine, generations, checkpoint, interval, recorder);
+}
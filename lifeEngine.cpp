@@ -0,0 +1,185 @@
+#include "lifeEngine.h"
+#include "simConfig.h"
+#include <algorithm>
+#include <cstring>
+
+/**
+ * \file lifeEngine.cpp
+ * \brief Implementation of the functions defined in \a lifeEngine.h
+ * \author lhm
+ */
+
+LifeEngine::LifeEngine(const SimConfig& p_config)
+    :   Engine      (p_config)
+    ,   m_stride    (p_config.getSimX() + 2)
+    ,   m_cells     ((std::size_t)m_stride * (p_config.getSimY() + 2))
+    ,   m_next      (m_cells.size())
+    ,   m_kernel    (getLifeRowKernel())
+{
+}
+
+Cell LifeEngine::getCell(const unsigned p_x, const unsigned p_y) const
+{
+    return m_cells[getPaddedIndex(p_x, p_y)] ? Cell::ON : Cell::OFF;
+}
+
+void LifeEngine::setCell(const unsigned p_x, const unsigned p_y, const Cell p_cell)
+{
+    m_cells[getPaddedIndex(p_x, p_y)] = p_cell == Cell::ON;
+    markTileChanged(p_x, p_y);
+}
+
+void LifeEngine::getRows(std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd) const
+{
+    const unsigned wordsPerRow = getChangesWordsPerRow();
+    for (unsigned y = p_yBegin; y < p_yEnd; ++y)
+    {
+        const std::uint8_t* row = &m_cells[getPaddedIndex(0, y)];
+        std::uint64_t* words = p_bitmap + (std::size_t)(y - p_yBegin) * wordsPerRow;
+        std::fill(words, words + wordsPerRow, 0);
+        for (unsigned x = 0; x < m_simX; ++x)
+        {
+            words[x / 64] |= (std::uint64_t)row[x] << (x % 64);
+        }
+    }
+}
+
+void LifeEngine::setRows(const std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd)
+{
+    const unsigned wordsPerRow = getChangesWordsPerRow();
+    for (unsigned y = p_yBegin; y < p_yEnd; ++y)
+    {
+        const std::uint64_t* words = p_bitmap + (std::size_t)(y - p_yBegin) * wordsPerRow;
+        std::uint8_t* row = &m_cells[getPaddedIndex(0, y)];
+        for (unsigned x = 0; x < m_simX; ++x)
+        {
+            const std::uint8_t cell = (std::uint8_t)((words[x / 64] >> (x % 64)) & 1);
+            if (row[x] != cell)
+            {
+                row[x] = cell;
+                markTileChanged(x, y);
+            }
+        }
+    }
+}
+
+void LifeEngine::update()
+{
+    wrapHalo(&m_cells[getPaddedIndex(0, 0)], m_stride);
+
+    if (useActiveTiles())
+    {
+        forEachBand(getTilesY(), [this](unsigned p_begin, unsigned p_end)
+        {
+            updateTiles(p_begin, p_end);
+        });
+    }
+    else
+    {
+        forEachRows([this](unsigned p_begin, unsigned p_end)
+        {
+            updateRows(p_begin, p_end);
+        });
+    }
+
+    m_cells.swap(m_next);
+}
+
+void LifeEngine::updateRows(const unsigned p_begin, const unsigned p_end)
+{
+    for (unsigned y = p_begin; y < p_end; ++y)
+    {
+        updateSpan(y, 0, m_simX);
+    }
+}
+
+void LifeEngine::updateTiles(const unsigned p_tyBegin, const unsigned p_tyEnd)
+{
+    const unsigned tilesX = getTilesX();
+    for (unsigned ty = p_tyBegin; ty < p_tyEnd; ++ty)
+    {
+        if (!isTileRowActive(ty))
+            continue;
+
+        const unsigned yEnd = std::min((ty + 1) * TILE_SIZE, m_simY);
+        for (unsigned y = ty * TILE_SIZE; y < yEnd; ++y)
+        {
+            // Consecutive active tiles are computed as one span
+            unsigned tx = 0;
+            while (tx < tilesX)
+            {
+                if (!isTileActive(tx, ty))
+                {
+                    ++tx;
+                    continue;
+                }
+
+                unsigned txEnd = tx + 1;
+                while (txEnd < tilesX && isTileActive(txEnd, ty))
+                {
+                    ++txEnd;
+                }
+
+                const unsigned xEnd = std::min(txEnd * TILE_SIZE, m_simX);
+                if (updateSpan(y, tx * TILE_SIZE, xEnd))
+                {
+                    markChangedTiles(y, tx, txEnd);
+                }
+                tx = txEnd;
+            }
+        }
+    }
+}
+
+void LifeEngine::markChangedTiles(const unsigned p_y, const unsigned p_txBegin, const unsigned p_txEnd)
+{
+    const std::uint8_t* row  = &m_cells[getPaddedIndex(0, p_y)];
+    const std::uint8_t* next = &m_next[getPaddedIndex(0, p_y)];
+    const unsigned ty = p_y / TILE_SIZE;
+    for (unsigned tx = p_txBegin; tx < p_txEnd; ++tx)
+    {
+        if (hasTileChanged(tx, ty))
+            continue;
+
+        const unsigned x    = tx * TILE_SIZE;
+        const unsigned size = std::min(TILE_SIZE, m_simX - x);
+        if (std::memcmp(row + x, next + x, size) != 0)
+        {
+            setTileChanged(tx, ty);
+        }
+    }
+}
+
+bool LifeEngine::updateSpan(const unsigned p_y, const unsigned p_xBegin, const unsigned p_xEnd)
+{
+    // The halo gives every cell of the grid its neighbours
+    const std::uint8_t* row   = &m_cells[getPaddedIndex(0, p_y)];
+    const std::uint8_t* above = row - m_stride;
+    const std::uint8_t* below = row + m_stride;
+    std::uint8_t*       next  = &m_next[getPaddedIndex(0, p_y)];
+
+    m_kernel(above, row, below, next, p_xBegin, p_xEnd);
+
+    // Dead cell not born from its neighbours: may get a miracle
+    forEachMiracle(p_y, p_xBegin, p_xEnd, [row, next](unsigned p_x)
+    {
+        next[p_x] |= (std::uint8_t)!row[p_x];
+    });
+
+    if (std::memcmp(row + p_xBegin, next + p_xBegin, p_xEnd - p_xBegin) == 0)
+    {
+        return false;
+    }
+
+    if (m_trackChanges)
+    {
+        for (unsigned x = p_xBegin; x < p_xEnd; ++x)
+        {
+            if (row[x] != next[x])
+            {
+                markChanged(x, p_y);
+            }
+        }
+    }
+    return true;
+}
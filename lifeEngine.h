@@ -0,0 +1,98 @@
+#ifndef LIFEENGINE_H
+#define LIFEENGINE_H
+
+#include <cstdint>
+#include <vector>
+#include "engine.h"
+#include "lifeKernel.h"
+
+/**
+ * \file lifeEngine.h
+ * \brief Definition of the default "Game of life" engine, storing one byte per cell.
+ * \author lhm
+ */
+
+/*!
+ * \class LifeEngine
+ * \brief Engine applying the rules of the "Game of life" (with miracles) to a dense grid.
+ * Each cell is stored in a byte (1 meaning alive), so that a row is computed by a vectorised
+ * kernel (see \a lifeKernel.h) and that a cell can later carry more than its state.
+ * The grid is surrounded by a halo of one cell: dead cells, or the cells of the opposite edges
+ * copied before each generation on a torus (see \a Engine::wrapHalo).
+ */
+class LifeEngine : public Engine
+{
+    public:
+        /*!
+         * \function LifeEngine
+         * \brief Creates the engine, with dead cells (see \a Engine::create).
+         * \param p_config The configuration of the simulation.
+         */
+        explicit LifeEngine(const SimConfig& p_config);
+
+        Cell getCell(const unsigned p_x, const unsigned p_y) const override;
+
+        void setCell(const unsigned p_x, const unsigned p_y, const Cell p_cell) override;
+
+        void getRows(std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd) const override;
+
+        void setRows(const std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd) override;
+
+    protected:
+        /*!
+         * \function update
+         * \brief Computes the next generation into \a m_next, then swaps the buffers.
+         */
+        void update() override;
+
+        /*!
+         * \function updateRows
+         * \brief Computes the next generation of a band of rows.
+         * \param p_begin the first row of the band
+         * \param p_end the past-the-end row of the band
+         */
+        void updateRows(const unsigned p_begin, const unsigned p_end);
+
+        /*!
+         * \function updateTiles
+         * \brief Computes the next generation of the active tiles of a band of rows of tiles.
+         * \param p_tyBegin the first row of tiles of the band
+         * \param p_tyEnd the past-the-end row of tiles of the band
+         */
+        void updateTiles(const unsigned p_tyBegin, const unsigned p_tyEnd);
+
+        /*!
+         * \function markChangedTiles
+         * \brief Records the tiles whose cells changed on a computed row.
+         * \param p_y the ordinate of the row
+         * \param p_txBegin the first tile of the computed span
+         * \param p_txEnd the past-the-end tile of the computed span
+         */
+        void markChangedTiles(const unsigned p_y, const unsigned p_txBegin, const unsigned p_txEnd);
+
+        /*!
+         * \function updateSpan
+         * \brief Computes the next generation of the cells [p_xBegin, p_xEnd) of a row.
+         * \param p_y the ordinate of the row
+         * \param p_xBegin the first cell to compute
+         * \param p_xEnd the past-the-end cell to compute
+         * \return true if at least one of the cells changed.
+         */
+        bool updateSpan(const unsigned p_y, const unsigned p_xBegin, const unsigned p_xEnd);
+
+    private:
+        /*!
+         * Returns the index of a cell in the padded grid
+         */
+        std::size_t getPaddedIndex(const unsigned p_x, const unsigned p_y) const
+        {
+            return (std::size_t)(p_y + 1) * m_stride + p_x + 1;
+        }
+
+        const unsigned m_stride;                        /**< number of cells of a padded row */
+        std::vector<std::uint8_t> m_cells;              /**< vector containing the cells of the cellular automaton, padded */
+        std::vector<std::uint8_t> m_next;               /**< next generation of the cells */
+        const LifeRowKernel m_kernel;                   /**< kernel computing a row */
+};
+
+#endif // LIFEENGINE_H
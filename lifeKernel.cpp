@@ -0,0 +1,155 @@
+#include "lifeKernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LIFE_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * \file lifeKernel.cpp
+ * \brief Implementation of the functions defined in \a lifeKernel.h
+ * The vectorised kernels sum the eight shifted neighbour rows 16 (SSE2) or 32 (AVX2) cells
+ * at a time, then apply the rule with vector compares. The cells left after the last full vector
+ * are computed by the scalar code. The halo of the rows gives every cell its eight neighbours:
+ * there is no bounds check.
+ * \author lhm
+ */
+
+namespace
+{
+    /*!
+     * Computes the cells [p_begin, p_end) of the row with the scalar code.
+     */
+    void rowScalar(const std::uint8_t* p_above,
+                   const std::uint8_t* p_row,
+                   const std::uint8_t* p_below,
+                   std::uint8_t*       p_next,
+                   unsigned            p_begin,
+                   unsigned            p_end)
+    {
+        for (unsigned x = p_begin; x < p_end; ++x)
+        {
+            const std::uint8_t* above = p_above + x - 1;
+            const std::uint8_t* row   = p_row   + x - 1;
+            const std::uint8_t* below = p_below + x - 1;
+            const unsigned count = above[0] + above[1] + above[2]
+                                 + row  [0]            + row  [2]
+                                 + below[0] + below[1] + below[2];
+
+            // Alive cell survives with 2 or 3 neighbours, dead cell is born with 3 neighbours
+            p_next[x] = count == 3 || (count == 2 && p_row[x]);
+        }
+    }
+
+#ifdef LIFE_KERNEL_X86
+    __attribute__((target("sse2")))
+    inline __m128i load(const std::uint8_t* p_ptr)
+    {
+        return _mm_loadu_si128((const __m128i*)p_ptr);
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i load256(const std::uint8_t* p_ptr)
+    {
+        return _mm256_loadu_si256((const __m256i*)p_ptr);
+    }
+
+    __attribute__((target("sse2")))
+    void rowSse2(const std::uint8_t* p_above,
+                 const std::uint8_t* p_row,
+                 const std::uint8_t* p_below,
+                 std::uint8_t*       p_next,
+                 unsigned            p_begin,
+                 unsigned            p_end)
+    {
+        const __m128i two   = _mm_set1_epi8(2);
+        const __m128i three = _mm_set1_epi8(3);
+        const __m128i one   = _mm_set1_epi8(1);
+
+        unsigned x = p_begin;
+        for (; x + 16 <= p_end; x += 16)
+        {
+            __m128i count = _mm_add_epi8(load(p_above + x - 1), load(p_above + x));
+            count = _mm_add_epi8(count, load(p_above + x + 1));
+            count = _mm_add_epi8(count, load(p_row   + x - 1));
+            count = _mm_add_epi8(count, load(p_row   + x + 1));
+            count = _mm_add_epi8(count, load(p_below + x - 1));
+            count = _mm_add_epi8(count, load(p_below + x));
+            count = _mm_add_epi8(count, load(p_below + x + 1));
+
+            __m128i alive   = _mm_cmpeq_epi8(load(p_row + x), one);
+            __m128i born    = _mm_cmpeq_epi8(count, three);
+            __m128i stays   = _mm_and_si128(_mm_cmpeq_epi8(count, two), alive);
+            __m128i result  = _mm_and_si128(_mm_or_si128(born, stays), one);
+            _mm_storeu_si128((__m128i*)(p_next + x), result);
+        }
+        rowScalar(p_above, p_row, p_below, p_next, x, p_end);
+    }
+
+    __attribute__((target("avx2")))
+    void rowAvx2(const std::uint8_t* p_above,
+                 const std::uint8_t* p_row,
+                 const std::uint8_t* p_below,
+                 std::uint8_t*       p_next,
+                 unsigned            p_begin,
+                 unsigned            p_end)
+    {
+        const __m256i two   = _mm256_set1_epi8(2);
+        const __m256i three = _mm256_set1_epi8(3);
+        const __m256i one   = _mm256_set1_epi8(1);
+
+        unsigned x = p_begin;
+        for (; x + 32 <= p_end; x += 32)
+        {
+            __m256i count = _mm256_add_epi8(load256(p_above + x - 1), load256(p_above + x));
+            count = _mm256_add_epi8(count, load256(p_above + x + 1));
+            count = _mm256_add_epi8(count, load256(p_row   + x - 1));
+            count = _mm256_add_epi8(count, load256(p_row   + x + 1));
+            count = _mm256_add_epi8(count, load256(p_below + x - 1));
+            count = _mm256_add_epi8(count, load256(p_below + x));
+            count = _mm256_add_epi8(count, load256(p_below + x + 1));
+
+            __m256i alive   = _mm256_cmpeq_epi8(load256(p_row + x), one);
+            __m256i born    = _mm256_cmpeq_epi8(count, three);
+            __m256i stays   = _mm256_and_si256(_mm256_cmpeq_epi8(count, two), alive);
+            __m256i result  = _mm256_and_si256(_mm256_or_si256(born, stays), one);
+            _mm256_storeu_si256((__m256i*)(p_next + x), result);
+        }
+        rowScalar(p_above, p_row, p_below, p_next, x, p_end);
+    }
+#endif
+
+    struct KernelChoice
+    {
+        LifeRowKernel kernel;
+        const char* name;
+    };
+
+    KernelChoice selectKernel()
+    {
+#ifdef LIFE_KERNEL_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return { rowAvx2, "avx2" };
+        if (__builtin_cpu_supports("sse2"))
+            return { rowSse2, "sse2" };
+#endif
+        return { rowScalar, "scalar" };
+    }
+
+    const KernelChoice& getChoice()
+    {
+        static const KernelChoice choice = selectKernel();
+        return choice;
+    }
+}
+
+LifeRowKernel getLifeRowKernel()
+{
+    return getChoice().kernel;
+}
+
+const char* getLifeRowKernelName()
+{
+    return getChoice().name;
+}
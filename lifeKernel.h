@@ -0,0 +1,43 @@
+#ifndef LIFEKERNEL_H
+#define LIFEKERNEL_H
+
+#include <cstdint>
+
+/**
+ * \file lifeKernel.h
+ * \brief Row kernels of the "Game of life" for grids storing one byte per cell.
+ * The kernel is chosen once, at runtime, among an AVX2, a SSE2 and a scalar version.
+ * \author lhm
+ */
+
+/*!
+ * \brief Computes the next generation of the cells [p_begin, p_end) of a row (1 meaning alive, 0 dead).
+ * The rows must be padded: the cells -1 and \a p_end of each row are read, so that no cell is
+ * computed differently from the others.
+ * \param p_above the row above
+ * \param p_row the row to compute
+ * \param p_below the row below
+ * \param p_next the next generation of the row
+ * \param p_begin the first cell to compute
+ * \param p_end the past-the-end cell to compute
+ */
+typedef void (*LifeRowKernel)(const std::uint8_t* p_above,
+                              const std::uint8_t* p_row,
+                              const std::uint8_t* p_below,
+                              std::uint8_t*       p_next,
+                              unsigned            p_begin,
+                              unsigned            p_end);
+
+/*!
+ * \function getLifeRowKernel
+ * \brief Returns the fastest row kernel supported by the processor.
+ */
+LifeRowKernel getLifeRowKernel();
+
+/*!
+ * \function getLifeRowKernelName
+ * \brief Returns the name of the kernel returned by \a getLifeRowKernel ("avx2", "sse2" or "scalar").
+ */
+const char* getLifeRowKernelName();
+
+#endif // LIFEKERNEL_H
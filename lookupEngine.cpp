@@ -0,0 +1,327 @@
+#include "lookupEngine.h"
+#include "simConfig.h"
+#include <algorithm>
+#include <iostream>
+
+/**
+ * \file lookupEngine.cpp
+ * \brief Implementation of the functions defined in \a lookupEngine.h
+ * \author lhm
+ */
+
+namespace
+{
+    Rule readRule(const SimConfig& p_config)
+    {
+        Rule rule;
+        if (!rule.parse(p_config.getRule()))
+        {
+            std::cout << "Invalid rule " << p_config.getRule() << ", using " << rule.toString() << '\n';
+        }
+        return rule;
+    }
+
+    const std::uint64_t NIBBLES = 0x0F0F0F0F0F0F0F0FULL; /**< low nibble of each byte */
+    const std::uint64_t BYTES   = 0x00FF00FF00FF00FFULL; /**< low byte of each 16 bits */
+
+    /*!
+     * Builds the table of a rule: the bit <em> 4 * r + c </em> of an index is the cell (c, r) of a
+     * block of 4x4 cells, and the bit <em> 4 * r + c </em> of an entry is the next generation of
+     * its cell (c + 1, r + 1), so that the entries of two blocks side by side can be merged into
+     * the nibbles of their 4 cells of each row (see \a lookupWord).
+     */
+    std::vector<std::uint8_t> buildTable(const Rule& p_rule)
+    {
+        auto cell = [](unsigned p_block, int p_c, int p_r) { return (p_block >> (4 * p_r + p_c)) & 1; };
+
+        std::vector<std::uint8_t> table(1 << 16);
+        for (unsigned block = 0; block < table.size(); ++block)
+        {
+            std::uint8_t next = 0;
+            for (int r = 1; r <= 2; ++r)
+            {
+                for (int c = 1; c <= 2; ++c)
+                {
+                    unsigned count = cell(block, c, r - 1) + cell(block, c, r + 1)
+                                   + cell(block, c - 1, r) + cell(block, c + 1, r);
+                    if (p_rule.neighbourhood != Neighbourhood::VON_NEUMANN)
+                    {
+                        count += cell(block, c - 1, r - 1) + cell(block, c + 1, r + 1);
+                    }
+                    if (p_rule.neighbourhood == Neighbourhood::MOORE)
+                    {
+                        count += cell(block, c + 1, r - 1) + cell(block, c - 1, r + 1);
+                    }
+
+                    const std::uint32_t set = cell(block, c, r) ? p_rule.survival : p_rule.birth;
+                    next |= (std::uint8_t)(((set >> count) & 1) << (4 * (r - 1) + (c - 1)));
+                }
+            }
+            table[block] = next;
+        }
+        return table;
+    }
+
+    /*!
+     * Returns the indexes of 16 blocks of 4x4 cells, 4 in each word, 16 bits each: the cells of
+     * the block \a k are the nibble \a k of each row, and its index is the lane <em> k / 4 </em> of
+     * the word <em> k % 4 </em>. The nibbles are interleaved by masks and shifts of whole words.
+     */
+    void getIndexes(const std::uint64_t p_rows[4], std::uint64_t p_indexes[4])
+    {
+        // Byte j: the nibble 2j (low) or 2j + 1 (high) of two rows
+        const std::uint64_t low01  = (p_rows[0] & NIBBLES) | ((p_rows[1] << 4) & ~NIBBLES);
+        const std::uint64_t high01 = ((p_rows[0] >> 4) & NIBBLES) | (p_rows[1] & ~NIBBLES);
+        const std::uint64_t low23  = (p_rows[2] & NIBBLES) | ((p_rows[3] << 4) & ~NIBBLES);
+        const std::uint64_t high23 = ((p_rows[2] >> 4) & NIBBLES) | (p_rows[3] & ~NIBBLES);
+
+        p_indexes[0] = (low01  & BYTES) | ((low23  & BYTES) << 8);
+        p_indexes[1] = (high01 & BYTES) | ((high23 & BYTES) << 8);
+        p_indexes[2] = ((low01  >> 8) & BYTES) | (low23  & ~BYTES);
+        p_indexes[3] = ((high01 >> 8) & BYTES) | (high23 & ~BYTES);
+    }
+
+    /*!
+     * Returns the low nibbles of the 8 bytes of a word, packed in 32 bits
+     */
+    std::uint64_t packNibbles(std::uint64_t p_word)
+    {
+        p_word &= NIBBLES;
+        p_word = (p_word | (p_word >> 4))  & BYTES;
+        p_word = (p_word | (p_word >> 8))  & 0x0000FFFF0000FFFFULL;
+        p_word = (p_word | (p_word >> 16)) & 0x00000000FFFFFFFFULL;
+        return p_word;
+    }
+
+    /*!
+     * Computes the next generation of a word of two rows from the 4 rows around them, the cell left
+     * of the word and the cell right of it being read in the words around it (the rows are padded).
+     * The 32 blocks of 2x2 cells are looked up by groups of 16: the blocks starting on the cells
+     * 4k - 1 of the word, then the ones starting on its cells 4k + 1.
+     */
+    void lookupWord(const std::uint64_t* const p_rows[4], const unsigned p_w, const std::uint8_t* p_table,
+                    std::uint64_t& p_first, std::uint64_t& p_second)
+    {
+        std::uint64_t even[4];
+        std::uint64_t odd[4];
+        for (unsigned r = 0; r < 4; ++r)
+        {
+            const std::uint64_t* row = p_rows[r];
+            even[r] = (row[p_w] << 1) | (row[(int)p_w - 1] >> 63);
+            odd[r]  = (row[p_w] >> 1) | (row[p_w + 1] << 63);
+        }
+        std::uint64_t evenIndexes[4];
+        std::uint64_t oddIndexes[4];
+        getIndexes(even, evenIndexes);
+        getIndexes(odd, oddIndexes);
+
+        // Byte k: the 4 next cells of each row from the cell 4k (low nibble: first row)
+        std::uint64_t nibbles[2] = { 0, 0 };
+        for (unsigned lane = 0; lane < 4; ++lane)
+        {
+            for (unsigned q = 0; q < 4; ++q)
+            {
+                const std::uint64_t cells = p_table[(evenIndexes[q] >> (16 * lane)) & 0xFFFF]
+                                          | (std::uint64_t)p_table[(oddIndexes[q] >> (16 * lane)) & 0xFFFF] << 2;
+                nibbles[lane / 2] |= cells << (8 * (4 * (lane % 2) + q));
+            }
+        }
+
+        p_first  = packNibbles(nibbles[0])      | packNibbles(nibbles[1]) << 32;
+        p_second = packNibbles(nibbles[0] >> 4) | packNibbles(nibbles[1] >> 4) << 32;
+    }
+}
+
+LookupEngine::LookupEngine(const SimConfig& p_config)
+    :   Engine          (p_config)
+    ,   m_rule          (readRule(p_config))
+    ,   m_table         (buildTable(m_rule))
+    ,   m_wordsPerRow   ((p_config.getSimX() + 63) / 64)
+    ,   m_stride        (m_wordsPerRow + 2)
+    ,   m_lastWordMask  (p_config.getSimX() % 64 ? (1ULL << (p_config.getSimX() % 64)) - 1 : ~0ULL)
+    ,   m_words         ((std::size_t)m_stride * (p_config.getSimY() + 3))
+    ,   m_next          (m_words.size())
+{
+}
+
+Cell LookupEngine::getCell(const unsigned p_x, const unsigned p_y) const
+{
+    auto word = m_words[getWordIndex(p_x / 64, (int)p_y)];
+    return (word >> (p_x % 64)) & 1 ? Cell::ON : Cell::OFF;
+}
+
+void LookupEngine::setCell(const unsigned p_x, const unsigned p_y, const Cell p_cell)
+{
+    auto& word = m_words[getWordIndex(p_x / 64, (int)p_y)];
+    auto  bit  = 1ULL << (p_x % 64);
+    word = p_cell == Cell::ON ? word | bit : word & ~bit;
+    markTileChanged(p_x, p_y);
+}
+
+void LookupEngine::getRows(std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd) const
+{
+    // The last word of a row may hold the halo of a torus past its cells
+    for (unsigned y = p_yBegin; y < p_yEnd; ++y)
+    {
+        const std::uint64_t* row = &m_words[getWordIndex(0, (int)y)];
+        std::uint64_t* words = p_bitmap + (std::size_t)(y - p_yBegin) * m_wordsPerRow;
+        std::copy(row, row + m_wordsPerRow, words);
+        words[m_wordsPerRow - 1] &= m_lastWordMask;
+    }
+}
+
+void LookupEngine::setRows(const std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd)
+{
+    // A word is a tile wide
+    for (unsigned y = p_yBegin; y < p_yEnd; ++y)
+    {
+        const std::uint64_t* words = p_bitmap + (std::size_t)(y - p_yBegin) * m_wordsPerRow;
+        std::uint64_t* row = &m_words[getWordIndex(0, (int)y)];
+        for (unsigned w = 0; w < m_wordsPerRow; ++w)
+        {
+            const std::uint64_t mask = w + 1 == m_wordsPerRow ? m_lastWordMask : ~0ULL;
+            const std::uint64_t word = words[w] & mask;
+            if ((row[w] & mask) != word)
+            {
+                row[w] = word;
+                markTileChanged(w * 64, y);
+            }
+        }
+    }
+}
+
+void LookupEngine::update()
+{
+    if (m_simX == 0 || m_simY == 0)
+        return;
+
+    wrapHalo();
+
+    if (useActiveTiles())
+    {
+        forEachBand(getTilesY(), [this](unsigned p_begin, unsigned p_end)
+        {
+            updateTiles(p_begin, p_end);
+        });
+    }
+    else
+    {
+        forEachBand((m_simY + 1) / 2, [this](unsigned p_begin, unsigned p_end)
+        {
+            for (unsigned pair = p_begin; pair < p_end; ++pair)
+            {
+                updateWords(2 * pair, 0, m_wordsPerRow);
+            }
+        });
+    }
+    m_words.swap(m_next);
+}
+
+void LookupEngine::updateTiles(const unsigned p_tyBegin, const unsigned p_tyEnd)
+{
+    static_assert(TILE_SIZE == 64, "A tile of the lookup engine is one word wide");
+
+    for (unsigned ty = p_tyBegin; ty < p_tyEnd; ++ty)
+    {
+        if (!isTileRowActive(ty))
+            continue;
+
+        const unsigned yEnd = std::min((ty + 1) * TILE_SIZE, m_simY);
+        for (unsigned y = ty * TILE_SIZE; y < yEnd; y += 2)
+        {
+            for (unsigned tx = 0; tx < m_wordsPerRow; ++tx)
+            {
+                if (isTileActive(tx, ty) && updateWords(y, tx, tx + 1))
+                {
+                    setTileChanged(tx, ty);
+                }
+            }
+        }
+    }
+}
+
+void LookupEngine::wrapHalo()
+{
+    if (!isToroidal())
+        return;
+
+    // The cell left of each row is the last one, and the two cells right of it are the first ones
+    const unsigned lastBit = (m_simX - 1) % 64;
+    for (unsigned y = 0; y < m_simY; ++y)
+    {
+        std::uint64_t* row = &m_words[getWordIndex(0, (int)y)];
+        const std::uint64_t first = row[0] & (m_simX > 1 ? 3 : 1);
+        const std::uint64_t two   = m_simX > 1 ? first : first | first << 1;
+        row[-1] = ((row[m_wordsPerRow - 1] >> lastBit) & 1) << 63;
+        row[m_wordsPerRow - 1] &= m_lastWordMask;
+        row[m_wordsPerRow] = 0;
+        if (lastBit < 63)
+            row[m_wordsPerRow - 1] |= two << (lastBit + 1);
+        row[m_wordsPerRow] |= lastBit < 63 ? two >> (63 - lastBit) : two;
+    }
+
+    // Then the last row is above the first one, and the first row below the last one
+    std::copy(&m_words[getWordIndex(0, (int)m_simY - 1) - 1], &m_words[getWordIndex(0, (int)m_simY) - 1],
+              &m_words[getWordIndex(0, -1) - 1]);
+    std::copy(&m_words[getWordIndex(0, 0) - 1], &m_words[getWordIndex(0, 1) - 1],
+              &m_words[getWordIndex(0, (int)m_simY) - 1]);
+}
+
+std::uint64_t LookupEngine::updateWords(const unsigned p_y, const unsigned p_wBegin, const unsigned p_wEnd)
+{
+    // The 4 rows around the pair; the row below a last row of an odd grid is never written
+    const bool hasSecond = p_y + 1 < m_simY;
+    const std::uint64_t* rows[4];
+    for (unsigned r = 0; r < 4; ++r)
+    {
+        rows[r] = &m_words[getWordIndex(0, (int)p_y + (int)r - 1)];
+    }
+    std::uint64_t* next[2]    = { &m_next[getWordIndex(0, (int)p_y)], &m_next[getWordIndex(0, (int)p_y + 1)] };
+    std::uint64_t* changes[2] = { nullptr, nullptr };
+    if (m_trackChanges)
+    {
+        changes[0] = &m_changes[(std::size_t)p_y * m_wordsPerRow];
+        changes[1] = hasSecond ? changes[0] + m_wordsPerRow : nullptr;
+    }
+
+    for (unsigned w = p_wBegin; w < p_wEnd; ++w)
+    {
+        std::uint64_t result[2];
+        lookupWord(rows, w, m_table.data(), result[0], result[1]);
+
+        const std::uint64_t mask = w + 1 == m_wordsPerRow ? m_lastWordMask : ~0ULL;
+        next[0][w] = result[0] & mask;
+        if (hasSecond)
+            next[1][w] = result[1] & mask;
+    }
+
+    // Dead cell not born from its neighbours: may get a miracle
+    const unsigned xBegin = p_wBegin * 64;
+    const unsigned xEnd   = std::min(p_wEnd * 64, m_simX);
+    for (unsigned r = 0; r < (hasSecond ? 2u : 1u); ++r)
+    {
+        const std::uint64_t* row = rows[r + 1];
+        std::uint64_t* words = next[r];
+        forEachMiracle(p_y + r, xBegin, xEnd, [row, words](unsigned p_x)
+        {
+            words[p_x / 64] |= ~row[p_x / 64] & (1ULL << (p_x % 64));
+        });
+    }
+
+    // The halo of a torus past the last cell is not a change
+    std::uint64_t changed = 0;
+    for (unsigned r = 0; r < (hasSecond ? 2u : 1u); ++r)
+    {
+        const std::uint64_t* row = rows[r + 1];
+        for (unsigned w = p_wBegin; w < p_wEnd; ++w)
+        {
+            const std::uint64_t diff = (next[r][w] ^ row[w]) & (w + 1 == m_wordsPerRow ? m_lastWordMask : ~0ULL);
+            changed |= diff;
+            if (changes[r])
+            {
+                changes[r][w] |= diff;
+            }
+        }
+    }
+    return changed;
+}
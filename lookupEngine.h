@@ -0,0 +1,104 @@
+#ifndef LOOKUPENGINE_H
+#define LOOKUPENGINE_H
+
+#include <cstdint>
+#include <vector>
+#include "engine.h"
+#include "rule.h"
+
+/**
+ * \file lookupEngine.h
+ * \brief Definition of an engine applying an outer-totalistic rule by blocks of 2x2 cells, looked up in a table.
+ * \author lhm
+ */
+
+/*!
+ * \class LookupEngine
+ * \brief Engine storing one bit per cell, as \a BitEngine, and applying the rule read from the
+ * <em>"rule"</em> rulestring of the configuration to 2x2 cells at once.
+ * The next generation of a block of 2x2 cells only depends on the 4x4 cells around it: the
+ * 16 bits of these cells index a table of the 4 next cells, built for the rule when the engine
+ * is created. Any neighbourhood and any birth and survival sets are computed at the same cost.
+ * Each row of the grid is stored in words as in \a BitEngine, padded with a word on each side,
+ * and the grid with a row above and two rows below, so that the 4x4 cells of every block can be
+ * read without any test. This halo holds dead cells, or the cells of the opposite edges on a torus.
+ * Only the rules of two states are computed: the dying states of the "Generations" rules do not fit in a bit.
+ */
+class LookupEngine : public Engine
+{
+    public:
+        /*!
+         * \function LookupEngine
+         * \brief Creates the engine and builds the table of its rule, with dead cells (see \a Engine::create).
+         * An invalid rulestring is replaced by the rule of the "Game of life".
+         * \param p_config The configuration of the simulation.
+         */
+        explicit LookupEngine(const SimConfig& p_config);
+
+        Cell getCell(const unsigned p_x, const unsigned p_y) const override;
+
+        void setCell(const unsigned p_x, const unsigned p_y, const Cell p_cell) override;
+
+        void getRows(std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd) const override;
+
+        void setRows(const std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd) override;
+
+        /*!
+         * Get the rule applied by the engine
+         */
+        const Rule& getRule() const { return m_rule; }
+
+    protected:
+        /*!
+         * \function update
+         * \brief Computes the next generation into \a m_next, then swaps the buffers.
+         */
+        void update() override;
+
+        /*!
+         * \function updateWords
+         * \brief Computes the next generation of consecutive words of a pair of rows.
+         * \param p_y the ordinate of the first row of the pair, even (the second one may be past the grid)
+         * \param p_wBegin the first word to compute
+         * \param p_wEnd the past-the-end word to compute
+         * \return the cells of the computed words that changed.
+         */
+        std::uint64_t updateWords(const unsigned p_y, const unsigned p_wBegin, const unsigned p_wEnd);
+
+        /*!
+         * \function updateTiles
+         * \brief Computes the next generation of the active tiles of a band of rows of tiles.
+         * As \a TILE_SIZE is 64, a tile is one word wide and holds whole pairs of rows.
+         * \param p_tyBegin the first row of tiles of the band
+         * \param p_tyEnd the past-the-end row of tiles of the band
+         */
+        void updateTiles(const unsigned p_tyBegin, const unsigned p_tyEnd);
+
+        /*!
+         * \function wrapHalo
+         * \brief Copies the opposite edges of the grid into its halo (toroidal boundary only).
+         */
+        void wrapHalo();
+
+        /*!
+         * \function getWordIndex
+         * \brief Returns the index of a word of the grid in the padded buffers.
+         * \param p_w the word of the row
+         * \param p_y the ordinate of the row (-1 for the row of the halo above the grid)
+         */
+        std::size_t getWordIndex(const unsigned p_w, const int p_y) const
+        {
+            return (std::size_t)(p_y + 1) * m_stride + p_w + 1;
+        }
+
+    private:
+        const Rule m_rule;                              /**< rule applied by the engine */
+        const std::vector<std::uint8_t> m_table;        /**< next 2x2 cells of each block of 4x4 cells */
+        const unsigned m_wordsPerRow;                   /**< number of words in a row */
+        const unsigned m_stride;                        /**< number of words in a padded row */
+        const std::uint64_t m_lastWordMask;             /**< valid cells of the last word of a row */
+        std::vector<std::uint64_t> m_words;             /**< current generation, padded */
+        std::vector<std::uint64_t> m_next;              /**< next generation, padded */
+};
+
+#endif // LOOKUPENGINE_H
@@ -1,7 +1,8 @@
 #include "Application.h"
 #include "config.h"
-#include "random.h"
 #include "cellAutomaton.h"
+#include "engine.h"
+#include "checkpoint.h"
 
 #include <iostream>
 #include <fstream>
@@ -35,16 +36,25 @@ namespace
         SetWindowPos(consoleWindow, 0, 0, 0, 500, 500, SWP_NOSIZE | SWP_NOZORDER);
     }
 
-    template<typename T>
-    void run(const Config& p_conf)
+    void run(Config& p_conf)
     {
         std::cout << "Controls: \n";
         std::cout << "Up - Zoom in\nDown - Zoom out\nZQSD - Move Around\n";
         std::cout << "R - Reset the view\n";
+        std::cout << "F3 - Show or hide the telemetry overlay\n";
+        std::cout << "F5 - Save a checkpoint to " << p_conf.getCheckpointFile() << '\n';
         std::cin.ignore();
 
+        // The size, rule and seed of a resumed simulation are the ones of its checkpoint
+        auto engine = p_conf.getResumeFile().empty() ? Engine::create(p_conf) : Checkpoint::resume(p_conf.getResumeFile(), p_conf);
+        if (!engine)
+        {
+            std::cout << "Unable to create the engine: " << p_conf.getEngine() << '\n';
+            return;
+        }
+
         Application app(p_conf);
-        app.init<T>();
+        app.init(std::move(engine));
         app.run();
 
         std::cout << '\n';
@@ -56,5 +66,5 @@ int main()
     setConsolePosition();
     Config conf;
     conf.loadConfig();
-    run<CellAutomaton>(conf);
+    run(conf);
 }
@@ -0,0 +1,63 @@
+#include "mappedFile.h"
+
+#ifdef _WIN32
+// The macros min and max would replace std::min and std::max
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * \file mappedFile.cpp
+ * \brief Implementation of the functions defined in \a mappedFile.h
+ * \author lhm
+ */
+
+MappedFile::MappedFile(const std::string& p_file)
+{
+#ifdef _WIN32
+    const HANDLE file = CreateFileA(p_file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return;
+    m_file = file;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+        return;
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+        return;
+    m_data = (const std::uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    m_size = m_data ? (std::size_t)size.QuadPart : 0;
+#else
+    m_file = open(p_file.c_str(), O_RDONLY);
+    struct stat status;
+    if (m_file < 0 || fstat(m_file, &status) != 0 || status.st_size == 0)
+        return;
+    void* data = mmap(nullptr, (std::size_t)status.st_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+    if (data == MAP_FAILED)
+        return;
+    m_data = (const std::uint8_t*)data;
+    m_size = (std::size_t)status.st_size;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file)
+        CloseHandle(m_file);
+#else
+    if (m_data)
+        munmap((void*)m_data, m_size);
+    if (m_file >= 0)
+        close(m_file);
+#endif
+}
@@ -0,0 +1,65 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * \file mappedFile.h
+ * \brief Definition of the read-only mapping of a file in memory.
+ * \author lhm
+ */
+
+/*!
+ * \class MappedFile
+ * \brief Maps a whole file in memory, read only, for as long as the object lives
+ * (mmap, or a file mapping on Windows). The pages are read by the system when accessed.
+ */
+class MappedFile
+{
+    public:
+        /*!
+         * \function MappedFile
+         * \brief Maps a file. \a getData is nullptr if the file cannot be mapped, or is empty.
+         * \param p_file the file
+         */
+        explicit MappedFile(const std::string& p_file);
+
+        /*!
+         * Unmaps the file.
+         */
+        ~MappedFile();
+
+        /*!
+         * Copy constructor is prohibited.
+         */
+        MappedFile              (const MappedFile& other)   = delete;
+
+        /*!
+         * Assignment constructor is prohibited.
+         */
+        MappedFile& operator=   (const MappedFile& other)   = delete;
+
+        /*!
+         * Get the content of the file (nullptr if it is not mapped)
+         */
+        const std::uint8_t* getData() const { return m_data; }
+
+        /*!
+         * Get the size of the file, in bytes
+         */
+        std::size_t getSize() const { return m_size; }
+
+    private:
+#ifdef _WIN32
+        void* m_file        = nullptr;                  /**< file mapped (HANDLE, <windows.h> being only included by the implementation) */
+        void* m_mapping     = nullptr;                  /**< mapping of the file (HANDLE) */
+#else
+        int m_file          = -1;                       /**< file mapped */
+#endif
+        const std::uint8_t* m_data = nullptr;           /**< content of the file */
+        std::size_t m_size  = 0;                        /**< size of the file */
+};
+
+#endif // MAPPEDFILE_H
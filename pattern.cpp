@@ -0,0 +1,588 @@
+#include "pattern.h"
+#include "engine.h"
+#include "simConfig.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+/**
+ * \file pattern.cpp
+ * \brief Implementation of the functions defined in \a pattern.h
+ * \author lhm
+ */
+
+namespace
+{
+    /*!
+     * \class Reader
+     * \brief Reads a file character by character, by blocks of \a BLOCK_SIZE bytes.
+     */
+    class Reader
+    {
+        public:
+            static const std::size_t BLOCK_SIZE = 1 << 20;
+
+            explicit Reader(const std::string& p_file)
+                :   m_file      (std::fopen(p_file.c_str(), "rb"))
+                ,   m_buffer    (BLOCK_SIZE)
+            {
+            }
+
+            ~Reader()
+            {
+                if (m_file)
+                    std::fclose(m_file);
+            }
+
+            Reader              (const Reader& other)   = delete;
+            Reader& operator=   (const Reader& other)   = delete;
+
+            bool isOpen() const { return m_file != nullptr; }
+
+            int get()
+            {
+                if (m_pos == m_end && !fill())
+                    return EOF;
+                return (unsigned char)m_buffer[m_pos++];
+            }
+
+            int peek()
+            {
+                if (m_pos == m_end && !fill())
+                    return EOF;
+                return (unsigned char)m_buffer[m_pos];
+            }
+
+            /*!
+             * Reads the rest of the current line (without the end of line).
+             */
+            std::string getLine()
+            {
+                std::string line;
+                for (int c = get(); c != EOF && c != '\n'; c = get())
+                {
+                    if (c != '\r')
+                        line += (char)c;
+                }
+                return line;
+            }
+
+            /*!
+             * Returns the characters buffered and not read yet, reading the next block if there is none.
+             */
+            bool getBlock(const char*& p_begin, const char*& p_end)
+            {
+                if (m_pos == m_end && !fill())
+                    return false;
+                p_begin = m_buffer.data() + m_pos;
+                p_end   = m_buffer.data() + m_end;
+                m_pos   = m_end;
+                return true;
+            }
+
+            void skipLine()
+            {
+                for (int c = get(); c != EOF && c != '\n'; c = get())
+                {
+                }
+            }
+
+            /*!
+             * Reads a signed integer after spaces (not after the end of the line).
+             */
+            bool getInteger(std::int64_t& p_value)
+            {
+                while (peek() == ' ' || peek() == '\t')
+                {
+                    get();
+                }
+                const bool negative = peek() == '-';
+                if (negative || peek() == '+')
+                {
+                    get();
+                }
+                if (!std::isdigit(peek()))
+                    return false;
+
+                p_value = 0;
+                while (std::isdigit(peek()))
+                {
+                    p_value = p_value * 10 + (get() - '0');
+                }
+                p_value = negative ? -p_value : p_value;
+                return true;
+            }
+
+        private:
+            bool fill()
+            {
+                m_pos = 0;
+                m_end = m_file ? std::fread(m_buffer.data(), 1, m_buffer.size(), m_file) : 0;
+                return m_end > 0;
+            }
+
+            std::FILE* m_file;
+            std::vector<char> m_buffer;
+            std::size_t m_pos = 0;
+            std::size_t m_end = 0;
+    };
+
+    /*!
+     * \class Canvas
+     * \brief Bitmap of the grid the cells of a pattern are written to, clipped to the grid.
+     */
+    class Canvas
+    {
+        public:
+            Canvas(std::uint64_t* p_bitmap, const unsigned p_simX, const unsigned p_simY, const std::int64_t p_x, const std::int64_t p_y)
+                :   m_bitmap        (p_bitmap)
+                ,   m_simX          (p_simX)
+                ,   m_simY          (p_simY)
+                ,   m_wordsPerRow   ((p_simX + 63) / 64)
+                ,   m_x             (p_x)
+                ,   m_y             (p_y)
+            {
+            }
+
+            /*!
+             * Returns true if a square of cells of the pattern overlaps the grid.
+             */
+            bool intersects(const std::int64_t p_x, const std::int64_t p_y, const std::int64_t p_size) const
+            {
+                const std::int64_t x = p_x + m_x;
+                const std::int64_t y = p_y + m_y;
+                return x < m_simX && y < m_simY && x + p_size > 0 && y + p_size > 0;
+            }
+
+            /*!
+             * Sets alive a run of cells of a row of the pattern.
+             */
+            void setRun(const std::int64_t p_x, const std::int64_t p_y, const std::uint64_t p_length)
+            {
+                const std::int64_t y = p_y + m_y;
+                std::int64_t begin = p_x + m_x;
+                if (y < 0 || y >= m_simY || begin >= m_simX)
+                    return;
+
+                const std::int64_t end = p_length >= (std::uint64_t)(m_simX - begin) ? m_simX : begin + (std::int64_t)p_length;
+                begin = std::max<std::int64_t>(begin, 0);
+                if (begin >= end)
+                    return;
+
+                std::uint64_t* row = m_bitmap + (std::size_t)y * m_wordsPerRow;
+                const std::size_t first = (std::size_t)begin / 64;
+                const std::size_t last  = (std::size_t)(end - 1) / 64;
+                const std::uint64_t firstMask = ~0ULL << (begin % 64);
+                const std::uint64_t lastMask  = ~0ULL >> (63 - (end - 1) % 64);
+                if (first == last)
+                {
+                    row[first] |= firstMask & lastMask;
+                    return;
+                }
+                row[first] |= firstMask;
+                std::fill(row + first + 1, row + last, ~0ULL);
+                row[last] |= lastMask;
+            }
+
+            /*!
+             * Sets alive the cells of a row of the pattern whose bits are set, the bit 0 being at \a p_x.
+             */
+            void setBits(const std::int64_t p_x, const std::int64_t p_y, std::uint64_t p_bits)
+            {
+                const std::int64_t y = p_y + m_y;
+                std::int64_t x = p_x + m_x;
+                if (y < 0 || y >= m_simY || x >= m_simX || x <= -64 || !p_bits)
+                    return;
+
+                if (x < 0)
+                {
+                    p_bits >>= -x;
+                    x = 0;
+                }
+                if (m_simX - x < 64)
+                {
+                    p_bits &= (1ULL << (m_simX - x)) - 1;
+                }
+
+                std::uint64_t* row = m_bitmap + (std::size_t)y * m_wordsPerRow;
+                const unsigned shift = (unsigned)(x % 64);
+                row[x / 64] |= p_bits << shift;
+                if (shift && (p_bits >> (64 - shift)))
+                {
+                    row[x / 64 + 1] |= p_bits >> (64 - shift);
+                }
+            }
+
+        private:
+            std::uint64_t* const m_bitmap;
+            const std::int64_t m_simX;
+            const std::int64_t m_simY;
+            const unsigned m_wordsPerRow;
+            const std::int64_t m_x;
+            const std::int64_t m_y;
+    };
+
+    bool loadRle(Reader& p_in, Canvas& p_canvas)
+    {
+        std::int64_t originX = 0, originY = 0;
+
+        // Comments and header
+        for (int c = p_in.peek(); c != EOF; c = p_in.peek())
+        {
+            if (c == '#')
+            {
+                const std::string line = p_in.getLine();
+                const std::size_t pos = line.find("Pos=");
+                if (line.compare(0, 6, "#CXRLE") == 0 && pos != std::string::npos)
+                {
+                    std::sscanf(line.c_str() + pos + 4, "%lld,%lld", (long long*)&originX, (long long*)&originY);
+                }
+            }
+            else if (c == 'x')
+            {
+                p_in.skipLine();
+                break;
+            }
+            else if (std::isspace(c))
+            {
+                p_in.get();
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        // Runs of cells: <count><state>, a state being 'b' or '.' (dead), '$' (end of row) or any other letter (alive).
+        // The block is parsed with local copies, which the writes to the bitmap cannot alias
+        Canvas canvas = p_canvas;
+        std::int64_t x = originX, y = originY;
+        std::uint64_t count = 0;
+        bool prefix = false;
+        const char* begin;
+        const char* end;
+        while (p_in.getBlock(begin, end))
+        {
+            for (const char* p = begin; p < end; ++p)
+            {
+                const char c = *p;
+                if (c >= '0' && c <= '9')
+                {
+                    count = count * 10 + (unsigned)(c - '0');
+                    continue;
+                }
+                if (c == '\n' || c == ' ' || c == '\r' || c == '\t')
+                    continue;
+
+                // Multistate files: "pA" to "yX" are the states above 24
+                if (prefix && !(c >= 'A' && c <= 'X'))
+                    return false;
+                if (!prefix && c >= 'p' && c <= 'y')
+                {
+                    prefix = true;
+                    continue;
+                }
+
+                const std::uint64_t run = count ? count : 1;
+                count = 0;
+                if ((c == 'b' || c == '.') && !prefix)
+                {
+                    x += (std::int64_t)run;
+                }
+                else if (c == '$')
+                {
+                    x = originX;
+                    y += (std::int64_t)run;
+                }
+                else if (c == '!')
+                {
+                    return true;
+                }
+                else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+                {
+                    canvas.setRun(x, y, run);
+                    x += (std::int64_t)run;
+                    prefix = false;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool loadPlaintext(Reader& p_in, Canvas& p_canvas)
+    {
+        std::int64_t x = 0, y = 0;
+        std::int64_t runBegin = -1;
+        for (int c = p_in.get(); c != EOF; c = p_in.get())
+        {
+            if (c == '!' && x == 0)
+            {
+                p_in.skipLine();
+                continue;
+            }
+
+            const bool alive = c == 'O' || c == '*';
+            if (runBegin >= 0 && !alive)
+            {
+                p_canvas.setRun(runBegin, y, (std::uint64_t)(x - runBegin));
+                runBegin = -1;
+            }
+
+            if (alive)
+            {
+                runBegin = runBegin < 0 ? x : runBegin;
+                ++x;
+            }
+            else if (c == '.')
+            {
+                ++x;
+            }
+            else if (c == '\n')
+            {
+                x = 0;
+                ++y;
+            }
+            else if (c != '\r' && c != ' ' && c != '\t')
+            {
+                return false;
+            }
+        }
+        if (runBegin >= 0)
+        {
+            p_canvas.setRun(runBegin, y, (std::uint64_t)(x - runBegin));
+        }
+        return true;
+    }
+
+    bool loadLife106(Reader& p_in, Canvas& p_canvas)
+    {
+        for (int c = p_in.peek(); c != EOF; c = p_in.peek())
+        {
+            if (c == '#')
+            {
+                p_in.skipLine();
+                continue;
+            }
+            if (std::isspace(c))
+            {
+                p_in.get();
+                continue;
+            }
+
+            std::int64_t x, y;
+            if (!p_in.getInteger(x) || !p_in.getInteger(y))
+                return false;
+            p_canvas.setRun(x, y, 1);
+        }
+        return true;
+    }
+
+    /*!
+     * \struct MacrocellNode
+     * \brief Node of a macrocell file: 8 x 8 cells (leaf), 2 x 2 states (level 1), or 4 nodes of the level below.
+     */
+    struct MacrocellNode
+    {
+        unsigned level = 0;
+        bool leaf = false;
+        std::uint64_t bits = 0;                         // leaf: row r in the bits 8r to 8r + 7
+        std::int64_t children[4] = {};                  // nw, ne, sw, se (0: empty)
+    };
+
+    void drawMacrocell(const std::vector<MacrocellNode>& p_nodes, const std::int64_t p_index,
+                       const std::int64_t p_x, const std::int64_t p_y, Canvas& p_canvas)
+    {
+        const MacrocellNode& node = p_nodes[(std::size_t)p_index];
+        const std::int64_t size = (std::int64_t)1 << node.level;
+        if (p_index == 0 || !p_canvas.intersects(p_x, p_y, size))
+            return;
+
+        if (node.leaf)
+        {
+            for (unsigned row = 0; row < 8; ++row)
+            {
+                p_canvas.setBits(p_x, p_y + row, (node.bits >> (8 * row)) & 0xff);
+            }
+            return;
+        }
+
+        const std::int64_t half = size / 2;
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            const std::int64_t x = p_x + (i & 1) * half;
+            const std::int64_t y = p_y + (i >> 1) * half;
+            if (node.level == 1)
+            {
+                if (node.children[i])
+                    p_canvas.setRun(x, y, 1);
+            }
+            else
+            {
+                drawMacrocell(p_nodes, node.children[i], x, y, p_canvas);
+            }
+        }
+    }
+
+    bool loadMacrocell(Reader& p_in, Canvas& p_canvas)
+    {
+        static const unsigned MAX_LEVEL = 62;           // the coordinates of the cells fit in 64 bits
+
+        std::vector<MacrocellNode> nodes(1);
+        for (int c = p_in.peek(); c != EOF; c = p_in.peek())
+        {
+            if (c == '[' || c == '#' || std::isspace(c))
+            {
+                p_in.skipLine();
+                continue;
+            }
+
+            MacrocellNode node;
+            if (c == '.' || c == '*' || c == '$')
+            {
+                // Leaf of 8 x 8 cells, the trailing dead cells and rows being omitted
+                node.level = 3;
+                node.leaf  = true;
+                unsigned x = 0, y = 0;
+                for (c = p_in.get(); c != EOF && c != '\n'; c = p_in.get())
+                {
+                    if (c == '$')
+                    {
+                        x = 0;
+                        ++y;
+                    }
+                    else if ((c == '.' || c == '*') && x < 8 && y < 8)
+                    {
+                        node.bits |= (std::uint64_t)(c == '*') << (8 * y + x++);
+                    }
+                    else if (c != '\r')
+                    {
+                        return false;
+                    }
+                }
+            }
+            else
+            {
+                std::int64_t level = 0;
+                if (!p_in.getInteger(level) || level < 1 || level > MAX_LEVEL)
+                    return false;
+                node.level = (unsigned)level;
+                for (auto& child : node.children)
+                {
+                    if (!p_in.getInteger(child) || child < 0)
+                        return false;
+
+                    // The nodes only refer to the nodes of the level below, defined before them
+                    const bool valid = node.level == 1
+                                    || child == 0
+                                    || ((std::size_t)child < nodes.size() && nodes[(std::size_t)child].level + 1 == node.level);
+                    if (!valid)
+                        return false;
+                }
+                p_in.skipLine();
+            }
+            nodes.push_back(node);
+        }
+
+        // The root is the last node, centred on the cell (0, 0)
+        if (nodes.size() < 2)
+            return true;
+        const std::int64_t half = (std::int64_t)1 << (nodes.back().level - 1);
+        drawMacrocell(nodes, (std::int64_t)nodes.size() - 1, -half, -half, p_canvas);
+        return true;
+    }
+
+    bool startsWith(const std::string& p_string, const char* p_prefix)
+    {
+        return p_string.compare(0, std::char_traits<char>::length(p_prefix), p_prefix) == 0;
+    }
+}
+
+Pattern::Format Pattern::getFormat(const std::string& p_file)
+{
+    std::string extension = p_file.substr(std::min(p_file.size(), p_file.find_last_of('.')));
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower(c); });
+
+    Reader in(p_file);
+    const std::string line = in.getLine();
+    if (startsWith(line, "[M2]"))
+        return MACROCELL;
+    if (startsWith(line, "#Life 1.06"))
+        return LIFE_106;
+    if (startsWith(line, "#Life"))
+        return UNKNOWN;
+    if (extension == ".rle")
+        return RLE;
+    if (extension == ".cells")
+        return PLAINTEXT;
+    if (extension == ".mc")
+        return MACROCELL;
+    if (startsWith(line, "!"))
+        return PLAINTEXT;
+    if (startsWith(line, "#") || startsWith(line, "x"))
+        return RLE;
+    return UNKNOWN;
+}
+
+bool Pattern::load(const std::string& p_file,
+                   const std::int64_t p_x,
+                   const std::int64_t p_y,
+                   const unsigned p_simX,
+                   const unsigned p_simY,
+                   std::uint64_t* p_bitmap)
+{
+    const Format format = getFormat(p_file);
+    Reader in(p_file);
+    if (!in.isOpen())
+    {
+        std::cout << "Unable to open the pattern " << p_file << '\n';
+        return false;
+    }
+
+    Canvas canvas(p_bitmap, p_simX, p_simY, p_x, p_y);
+    bool valid = false;
+    switch (format)
+    {
+        case RLE:
+            valid = loadRle(in, canvas);
+            break;
+
+        case PLAINTEXT:
+            valid = loadPlaintext(in, canvas);
+            break;
+
+        case LIFE_106:
+            valid = loadLife106(in, canvas);
+            break;
+
+        case MACROCELL:
+            valid = loadMacrocell(in, canvas);
+            break;
+
+        default:
+            std::cout << "Unknown format of the pattern " << p_file << '\n';
+            return false;
+    }
+
+    if (!valid)
+    {
+        std::cout << "Invalid pattern " << p_file << '\n';
+    }
+    return valid;
+}
+
+bool Pattern::load(const SimConfig& p_config, Engine& p_engine)
+{
+    std::vector<std::uint64_t> cells((std::size_t)p_engine.getChangesWordsPerRow() * p_engine.getSimY());
+    if (!load(p_config.getPatternFile(), p_config.getPatternX(), p_config.getPatternY(), p_engine.getSimX(), p_engine.getSimY(), cells.data()))
+        return false;
+
+    p_engine.setCells(cells.data());
+    return true;
+}
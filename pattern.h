@@ -0,0 +1,80 @@
+#ifndef PATTERN_H
+#define PATTERN_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * \file pattern.h
+ * \brief Definition of the loaders of the standard pattern files.
+ * \author lhm
+ */
+
+class Engine;
+class SimConfig;
+
+/*!
+ * \class Pattern
+ * \brief Loader of the pattern files, written into a bitmap laid out as \a Engine::getCells.
+ * The files are parsed as they are read, by blocks: only the bitmap (and the nodes of a
+ * macrocell file) are held in memory. The cells outside the grid are ignored.
+ * The cell (0, 0) of a pattern is written at the given offset of the grid, the cell (0, 0) being:
+ * <ul>
+ * <li> \a RLE: the top left corner (or the position of a "#CXRLE Pos=x,y" line)
+ * <li> \a PLAINTEXT (.cells): the top left corner
+ * <li> \a LIFE_106: the origin of the coordinates of the file
+ * <li> \a MACROCELL: the centre of the root node (as in Golly)
+ * </ul>
+ */
+class Pattern
+{
+    public:
+        /*!
+         * \enum Format
+         * \brief Formats of the pattern files.
+         */
+        enum Format
+        {
+            UNKNOWN,
+            RLE,                                        /**< run length encoded (.rle) */
+            PLAINTEXT,                                  /**< one character per cell (.cells) */
+            LIFE_106,                                   /**< coordinates of the alive cells (.lif, .life) */
+            MACROCELL                                   /**< quadtree of the cells (.mc) */
+        };
+
+        /*!
+         * \function getFormat
+         * \brief Returns the format of a file, from its extension or else from its first line.
+         * \param p_file the file
+         */
+        static Format getFormat(const std::string& p_file);
+
+        /*!
+         * \function load
+         * \brief Reads a pattern file and sets its alive cells in a bitmap (the other cells are left as is).
+         * \param p_file the file
+         * \param p_x the abscissa of the cell (0, 0) of the pattern on the grid
+         * \param p_y the ordinate of the cell (0, 0) of the pattern on the grid
+         * \param p_simX the abscissa of the grid
+         * \param p_simY the ordinate of the grid
+         * \param p_bitmap the bitmap of the grid, laid out as \a Engine::getCells
+         * \return false if the file cannot be read or is invalid.
+         */
+        static bool load(const std::string& p_file,
+                         const std::int64_t p_x,
+                         const std::int64_t p_y,
+                         const unsigned p_simX,
+                         const unsigned p_simY,
+                         std::uint64_t* p_bitmap);
+
+        /*!
+         * \function load
+         * \brief Replaces the cells of an engine by the pattern of the configuration, at its offset.
+         * \param p_config the configuration (see \a SimConfig::getPatternFile)
+         * \param p_engine the engine
+         * \return false if the file cannot be read or is invalid (the engine is left as is).
+         */
+        static bool load(const SimConfig& p_config, Engine& p_engine);
+};
+
+#endif // PATTERN_H
@@ -0,0 +1,347 @@
+#include "recorder.h"
+#include "checkpoint.h"
+#include "engine.h"
+#include "mappedFile.h"
+#include "simConfig.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+/**
+ * \file recorder.cpp
+ * \brief Implementation of the functions defined in \a recorder.h
+ * \author lhm
+ */
+
+namespace
+{
+    const char MAGIC[8]       = { 'C', 'E', 'L', 'L', 'R', 'E', 'C', 'D' };
+    const char INDEX_MAGIC[8] = { 'C', 'E', 'L', 'L', 'I', 'N', 'D', 'X' };
+    const std::size_t FRAME_HEADER_SIZE = 1 + 2 * sizeof(std::uint64_t);
+
+    template<typename T>
+    void put(std::vector<std::uint8_t>& p_out, const T p_value)
+    {
+        const std::uint8_t* bytes = (const std::uint8_t*)&p_value;
+        p_out.insert(p_out.end(), bytes, bytes + sizeof(T));
+    }
+
+    template<typename T>
+    T get(const std::uint8_t* p_in)
+    {
+        T value;
+        std::memcpy(&value, p_in, sizeof(T));
+        return value;
+    }
+}
+
+Recorder::~Recorder()
+{
+    close();
+}
+
+bool Recorder::open(const std::string& p_file, const SimConfig& p_config, Engine& p_engine, const unsigned p_keyframeInterval)
+{
+    close();
+    m_out.open(p_file, std::ios::binary | std::ios::trunc);
+    if (!m_out.is_open())
+    {
+        std::cout << "Unable to create the recording " << p_file << '\n';
+        return false;
+    }
+
+    m_keyframeInterval  = std::max(1u, p_keyframeInterval);
+    m_firstGeneration   = p_engine.getGeneration();
+    m_planes            = Checkpoint::getPlaneCount(p_config.getRule());
+    m_cells.resize((std::size_t)p_engine.getChangesWordsPerRow() * p_engine.getSimY() * (1 + m_planes));
+    m_previous.clear();
+    m_keyframes.clear();
+
+    // Header, padded to 8 bytes
+    std::vector<std::uint8_t> header(MAGIC, MAGIC + sizeof(MAGIC));
+    put<std::uint32_t>(header, VERSION);
+    put<std::uint32_t>(header, 0);
+    put<std::uint32_t>(header, p_engine.getSimX());
+    put<std::uint32_t>(header, p_engine.getSimY());
+    put<std::uint32_t>(header, m_keyframeInterval);
+    put<std::uint64_t>(header, m_firstGeneration);
+    put<std::uint64_t>(header, p_config.getSeed());
+    put<double>       (header, p_config.getMiracleProb());
+    put<std::uint32_t>(header, m_planes);
+    put<std::uint32_t>(header, (std::uint32_t)p_config.getRule().size());
+    header.insert(header.end(), p_config.getRule().begin(), p_config.getRule().end());
+    header.resize((header.size() + 7) / 8 * 8, 0);
+    const std::uint32_t headerSize = (std::uint32_t)header.size();
+    std::memcpy(&header[12], &headerSize, sizeof(headerSize));
+
+    m_out.write((const char*)header.data(), (std::streamsize)header.size());
+    m_offset = header.size();
+
+    p_engine.setTrackChanges(true);
+    readCells(p_engine);
+    writeFrame(KEYFRAME, m_firstGeneration, m_cells.data());
+    return true;
+}
+
+void Recorder::record(const Engine& p_engine)
+{
+    if (!isOpen())
+        return;
+
+    // The changes of several generations are not a delta: a cell may have recovered its state
+    const std::uint64_t generation = p_engine.getGeneration();
+    const bool keyframe = (generation - m_firstGeneration) % m_keyframeInterval == 0 || generation != m_lastGeneration + 1;
+
+    // The changes of the engine are the ones of the alive cells only: the states are compared to the previous ones
+    if (m_planes > 0)
+    {
+        m_previous.swap(m_cells);
+        m_cells.resize(m_previous.size());
+        readCells(p_engine);
+        if (!keyframe)
+        {
+            for (std::size_t i = 0; i < m_cells.size(); ++i)
+            {
+                m_previous[i] ^= m_cells[i];
+            }
+        }
+        writeFrame(keyframe ? KEYFRAME : DELTA, generation, keyframe ? m_cells.data() : m_previous.data());
+    }
+    else if (keyframe)
+    {
+        readCells(p_engine);
+        writeFrame(KEYFRAME, generation, m_cells.data());
+    }
+    else
+    {
+        writeFrame(DELTA, generation, p_engine.getChanges().data());
+    }
+}
+
+void Recorder::readCells(const Engine& p_engine)
+{
+    const std::size_t words = (std::size_t)p_engine.getChangesWordsPerRow() * p_engine.getSimY();
+    p_engine.getCells(m_cells.data());
+    p_engine.getStates(m_cells.data() + words, m_planes);
+}
+
+bool Recorder::close()
+{
+    if (!isOpen())
+        return true;
+
+    std::vector<std::uint8_t> index(INDEX_MAGIC, INDEX_MAGIC + sizeof(INDEX_MAGIC));
+    put<std::uint64_t>(index, m_keyframes.size());
+    put<std::uint64_t>(index, m_lastGeneration);
+    for (const auto& keyframe : m_keyframes)
+    {
+        put<std::uint64_t>(index, keyframe.first);
+        put<std::uint64_t>(index, keyframe.second);
+    }
+    put<std::uint64_t>(index, m_offset);
+    index.insert(index.end(), INDEX_MAGIC, INDEX_MAGIC + sizeof(INDEX_MAGIC));
+
+    m_out.write((const char*)index.data(), (std::streamsize)index.size());
+    const bool written = (bool)m_out.flush();
+    m_out.close();
+    if (!written)
+    {
+        std::cout << "Unable to write the recording\n";
+    }
+    return written;
+}
+
+void Recorder::writeFrame(const Kind p_kind, const std::uint64_t p_generation, const std::uint64_t* p_words)
+{
+    if (p_kind == KEYFRAME)
+    {
+        m_keyframes.emplace_back(p_generation, m_offset);
+    }
+    m_lastGeneration = p_generation;
+
+    m_buffer.clear();
+    m_buffer.push_back((std::uint8_t)p_kind);
+    put<std::uint64_t>(m_buffer, p_generation);
+    put<std::uint64_t>(m_buffer, 0);
+    Checkpoint::encode(p_words, m_cells.size(), m_buffer);
+    const std::uint64_t size = m_buffer.size() - FRAME_HEADER_SIZE;
+    std::memcpy(&m_buffer[1 + sizeof(std::uint64_t)], &size, sizeof(size));
+
+    m_out.write((const char*)m_buffer.data(), (std::streamsize)m_buffer.size());
+    m_offset += m_buffer.size();
+}
+
+Replay::Replay() = default;
+
+Replay::~Replay() = default;
+
+bool Replay::open(const std::string& p_file)
+{
+    m_file  = std::make_unique<MappedFile>(p_file);
+    m_valid = false;
+    const std::uint8_t* data = m_file->getData();
+    const std::size_t size   = m_file->getSize();
+    if (!data)
+    {
+        std::cout << "Unable to open the recording " << p_file << '\n';
+        return false;
+    }
+
+    // The version 1 has no state planes
+    const std::uint32_t version = size >= 12 ? get<std::uint32_t>(data + 8) : 0;
+    const std::size_t FIXED_HEADER_SIZE = version == 1 ? 56 : 60;
+    if (size < FIXED_HEADER_SIZE || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || (version != 1 && version != Recorder::VERSION))
+    {
+        std::cout << p_file << " is not a recording, or of an unsupported version\n";
+        return false;
+    }
+
+    const std::uint32_t headerSize = get<std::uint32_t>(data + 12);
+    m_simX              = get<std::uint32_t>(data + 16);
+    m_simY              = get<std::uint32_t>(data + 20);
+    m_keyframeInterval  = get<std::uint32_t>(data + 24);
+    m_seed              = get<std::uint64_t>(data + 36);
+    m_miracleProb       = get<double>       (data + 44);
+    m_planes            = version == 1 ? 0 : get<std::uint32_t>(data + 52);
+    const std::uint32_t ruleSize = get<std::uint32_t>(data + FIXED_HEADER_SIZE - 4);
+    if (headerSize > size || FIXED_HEADER_SIZE + ruleSize > headerSize || m_planes > Checkpoint::MAX_PLANES
+     || ((std::uint64_t)m_simX + 63) / 64 * m_simY * (1 + m_planes) > Checkpoint::MAX_WORDS)
+    {
+        std::cout << "The recording " << p_file << " is corrupted\n";
+        return false;
+    }
+    m_rule.assign((const char*)data + FIXED_HEADER_SIZE, ruleSize);
+    m_cells.assign((std::size_t)(m_simX + 63) / 64 * m_simY * (1 + m_planes), 0);
+
+    if (!readIndex() || !seek(getFirstGeneration()))
+    {
+        std::cout << "The recording " << p_file << " is corrupted\n";
+        return false;
+    }
+    return true;
+}
+
+bool Replay::seek(const std::uint64_t p_generation)
+{
+    if (m_keyframes.empty() || p_generation < getFirstGeneration() || p_generation > m_lastGeneration)
+        return false;
+
+    // Keyframe before the generation, unless the current generation is closer
+    auto keyframe = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), p_generation,
+                                     [](const std::uint64_t p_value, const std::pair<std::uint64_t, std::uint64_t>& p_keyframe)
+                                     {
+                                         return p_value < p_keyframe.first;
+                                     }) - 1;
+    if (!m_valid || m_generation > p_generation || m_generation < keyframe->first)
+    {
+        Frame frame;
+        m_valid = readFrame(keyframe->second, frame) && frame.kind == Recorder::KEYFRAME && apply(frame);
+        m_next  = frame.next;
+        if (!m_valid)
+            return false;
+    }
+
+    while (m_generation < p_generation)
+    {
+        if (!next())
+            return false;
+    }
+    return m_generation == p_generation;
+}
+
+bool Replay::next()
+{
+    Frame frame;
+    if (!m_valid || !readFrame(m_next, frame))
+        return false;
+
+    m_valid = apply(frame);
+    m_next  = frame.next;
+    return m_valid;
+}
+
+void Replay::configure(SimConfig& p_config) const
+{
+    p_config.setSimX(m_simX);
+    p_config.setSimY(m_simY);
+    p_config.setRule(m_rule);
+    p_config.setSeed(m_seed);
+    p_config.setMiracleProb(m_miracleProb);
+}
+
+bool Replay::readFrame(const std::uint64_t p_offset, Frame& p_frame) const
+{
+    const std::uint8_t* data = m_file->getData();
+    if (p_offset + FRAME_HEADER_SIZE > m_framesEnd)
+        return false;
+
+    p_frame.kind        = data[p_offset];
+    p_frame.generation  = get<std::uint64_t>(data + p_offset + 1);
+    p_frame.size        = get<std::uint64_t>(data + p_offset + 1 + sizeof(std::uint64_t));
+    p_frame.payload     = data + p_offset + FRAME_HEADER_SIZE;
+    p_frame.next        = p_offset + FRAME_HEADER_SIZE + p_frame.size;
+    return p_frame.kind <= Recorder::DELTA && p_frame.size <= m_framesEnd - p_offset - FRAME_HEADER_SIZE;
+}
+
+bool Replay::readIndex()
+{
+    const std::uint8_t* data = m_file->getData();
+    const std::size_t size   = m_file->getSize();
+    const std::uint64_t firstFrame = get<std::uint32_t>(data + 12);
+    m_keyframes.clear();
+
+    // Index written by Recorder::close
+    if (size >= firstFrame + 2 * sizeof(INDEX_MAGIC) + 3 * sizeof(std::uint64_t)
+        && std::memcmp(data + size - sizeof(INDEX_MAGIC), INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0)
+    {
+        // The index holds its magic, its count, the last generation, the entries, then its offset and its magic
+        const std::uint64_t offset = get<std::uint64_t>(data + size - sizeof(INDEX_MAGIC) - sizeof(std::uint64_t));
+        const bool inside          = offset >= firstFrame && offset <= size - 40;
+        const std::uint64_t count  = inside ? get<std::uint64_t>(data + offset + 8) : 0;
+        if (inside && count <= (size - offset - 40) / 16 && offset + 40 + count * 16 == size
+            && std::memcmp(data + offset, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0)
+        {
+            m_framesEnd      = offset;
+            m_lastGeneration = get<std::uint64_t>(data + offset + 16);
+            for (std::uint64_t i = 0; i < count; ++i)
+            {
+                const std::uint8_t* entry = data + offset + 24 + i * 16;
+                m_keyframes.emplace_back(get<std::uint64_t>(entry), get<std::uint64_t>(entry + 8));
+            }
+            return !m_keyframes.empty();
+        }
+    }
+
+    // Interrupted recording: the frames are scanned up to the first truncated one
+    m_framesEnd = size;
+    std::uint64_t end = firstFrame;
+    Frame frame;
+    for (std::uint64_t offset = firstFrame; readFrame(offset, frame); offset = frame.next)
+    {
+        if (frame.kind == Recorder::KEYFRAME)
+        {
+            m_keyframes.emplace_back(frame.generation, offset);
+        }
+        if (!m_keyframes.empty())
+        {
+            m_lastGeneration = frame.generation;
+            end = frame.next;
+        }
+    }
+    m_framesEnd = end;
+    return !m_keyframes.empty();
+}
+
+bool Replay::apply(const Frame& p_frame)
+{
+    // A delta is the exclusive or of the generation and of the previous one
+    const bool delta = p_frame.kind == Recorder::DELTA;
+    if (delta && p_frame.generation != m_generation + 1)
+        return false;
+    if (!Checkpoint::decode(p_frame.payload, (std::size_t)p_frame.size, m_cells.data(), m_cells.size(), delta))
+        return false;
+
+    m_generation = p_frame.generation;
+    return true;
+}
@@ -0,0 +1,280 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * \file recorder.h
+ * \brief Definition of the recording of the generations of a simulation, and of their replay.
+ * \author lhm
+ */
+
+class Engine;
+class MappedFile;
+class SimConfig;
+
+/*!
+ * \class Recorder
+ * \brief Writes every generation of a simulation to a file: a keyframe holding every cell each
+ * \a getKeyframeInterval generations, and in between the cells changed since the previous
+ * generation (see \a Engine::getChanges), both compressed as the payload of a \a Checkpoint.
+ * For the rules of more than two states, the frames also hold the bit planes of the states (see
+ * \a Engine::getStates), and a delta is the exclusive or of every plane with the previous generation.
+ * An index of the keyframes is written at the end of the file by \a close.
+ * <ul>
+ * <li> Header (little endian): "CELLRECD", version, size of the header, simX, simY, keyframe interval,
+ * first generation, seed, miracle probability, number of state planes, length of the rule, rule
+ * (version 1 has no state planes)
+ * <li> Frames: kind (\a KEYFRAME or \a DELTA, 1 byte), generation, size of the payload, payload
+ * <li> Index: "CELLINDX", number of keyframes, last generation, then the generation and the offset of
+ * each keyframe, and finally the offset of the index and "CELLINDX" again
+ * </ul>
+ * A file without index (the recording was interrupted) is still read, by scanning its frames.
+ * The unbounded engines (hashlife, sparse) only record the cells of their window.
+ */
+class Recorder
+{
+    public:
+        static const std::uint32_t VERSION = 2;         /**< version of the files written */
+
+        /*!
+         * \enum Kind
+         * \brief Kinds of frames.
+         */
+        enum Kind
+        {
+            KEYFRAME,                                   /**< every cell */
+            DELTA                                       /**< cells changed since the previous generation */
+        };
+
+        Recorder() = default;
+
+        /*!
+         * Closes the file.
+         */
+        ~Recorder();
+
+        /*!
+         * Copy constructor is prohibited.
+         */
+        Recorder              (const Recorder& other)   = delete;
+
+        /*!
+         * Assignment constructor is prohibited.
+         */
+        Recorder& operator=   (const Recorder& other)   = delete;
+
+        /*!
+         * \function open
+         * \brief Creates the file and writes the current generation of an engine as a keyframe.
+         * The changes of the engine are tracked from now on.
+         * \param p_file the file
+         * \param p_config the configuration of the engine (rule, seed, miracles)
+         * \param p_engine the engine
+         * \param p_keyframeInterval the number of generations between two keyframes
+         * \return true if the file was created.
+         */
+        bool open(const std::string& p_file, const SimConfig& p_config, Engine& p_engine, const unsigned p_keyframeInterval);
+
+        /*!
+         * \function record
+         * \brief Writes the current generation of the engine, to be called after each generation.
+         * A keyframe is written instead of a delta if generations were skipped.
+         * \param p_engine the engine given to \a open
+         */
+        void record(const Engine& p_engine);
+
+        /*!
+         * \function close
+         * \brief Writes the index and closes the file (does nothing if not open).
+         * \return false if the file could not be written.
+         */
+        bool close();
+
+        /*!
+         * Returns true if a file is open
+         */
+        bool isOpen() const { return m_out.is_open(); }
+
+    protected:
+        /*!
+         * \function writeFrame
+         * \brief Compresses and writes a frame.
+         * \param p_kind the kind of the frame
+         * \param p_generation the generation of the frame
+         * \param p_words the cells and state planes (\a KEYFRAME) or the changed ones (\a DELTA)
+         */
+        void writeFrame(const Kind p_kind, const std::uint64_t p_generation, const std::uint64_t* p_words);
+
+        /*!
+         * \function readCells
+         * \brief Copies the cells and the state planes of the engine into \a m_cells.
+         */
+        void readCells(const Engine& p_engine);
+
+    private:
+        std::ofstream m_out;                            /**< file */
+        std::uint64_t m_offset = 0;                     /**< size of the file */
+        unsigned m_keyframeInterval = 1;                /**< generations between two keyframes */
+        std::uint64_t m_firstGeneration = 0;            /**< generation of the first keyframe */
+        std::uint64_t m_lastGeneration = 0;             /**< generation of the last frame */
+        unsigned m_planes = 0;                          /**< number of state planes */
+        std::vector<std::uint64_t> m_cells;             /**< cells of a keyframe, then the state planes */
+        std::vector<std::uint64_t> m_previous;          /**< cells and state planes of the previous generation (states only) */
+        std::vector<std::uint8_t> m_buffer;             /**< compressed frame */
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> m_keyframes;   /**< generation and offset of each keyframe */
+};
+
+/*!
+ * \class Replay
+ * \brief Reads a file written by a \a Recorder, mapped in memory. Any generation is reached by
+ * decoding the keyframe before it, then at most <em> interval - 1 </em> deltas.
+ */
+class Replay
+{
+    public:
+        Replay();
+
+        /*!
+         * Unmaps the file.
+         */
+        ~Replay();
+
+        /*!
+         * Copy constructor is prohibited.
+         */
+        Replay              (const Replay& other)   = delete;
+
+        /*!
+         * Assignment constructor is prohibited.
+         */
+        Replay& operator=   (const Replay& other)   = delete;
+
+        /*!
+         * \function open
+         * \brief Maps a recording, and reads its first generation.
+         * \param p_file the file
+         * \return false if the file is not a valid recording.
+         */
+        bool open(const std::string& p_file);
+
+        /*!
+         * \function seek
+         * \brief Reads a generation of the recording.
+         * \param p_generation the generation, between \a getFirstGeneration and \a getLastGeneration
+         * \return false if the generation is not recorded or its frames are invalid.
+         */
+        bool seek(const std::uint64_t p_generation);
+
+        /*!
+         * \function next
+         * \brief Reads the generation following the current one.
+         * \return false at the end of the recording.
+         */
+        bool next();
+
+        /*!
+         * \function configure
+         * \brief Replaces the size of the grid, the rule, the seed and the miracle probability
+         * of a configuration by the ones of the recording.
+         * \param p_config the configuration
+         */
+        void configure(SimConfig& p_config) const;
+
+        /*!
+         * Get the abscissa of the grid
+         */
+        unsigned getSimX() const { return m_simX; }
+
+        /*!
+         * Get the ordinate of the grid
+         */
+        unsigned getSimY() const { return m_simY; }
+
+        /*!
+         * Get the number of generations between two keyframes
+         */
+        unsigned getKeyframeInterval() const { return m_keyframeInterval; }
+
+        /*!
+         * Get the first generation recorded
+         */
+        std::uint64_t getFirstGeneration() const { return m_keyframes.empty() ? 0 : m_keyframes.front().first; }
+
+        /*!
+         * Get the last generation recorded
+         */
+        std::uint64_t getLastGeneration() const { return m_lastGeneration; }
+
+        /*!
+         * Get the generation read
+         */
+        std::uint64_t getGeneration() const { return m_generation; }
+
+        /*!
+         * Get the cells of the generation read, laid out as \a Engine::getCells, followed by the state planes
+         */
+        const std::vector<std::uint64_t>& getCells() const { return m_cells; }
+
+        /*!
+         * Get the number of bit planes of the states following the cells (0 for the rules of two states)
+         */
+        unsigned getStatePlanes() const { return m_planes; }
+
+    protected:
+        /*!
+         * \struct Frame
+         * \brief Frame of the recording, pointing into the mapped file.
+         */
+        struct Frame
+        {
+            std::uint8_t kind = 0;                      /**< \a Recorder::Kind */
+            std::uint64_t generation = 0;               /**< generation */
+            const std::uint8_t* payload = nullptr;      /**< compressed words */
+            std::uint64_t size = 0;                     /**< size of the payload */
+            std::uint64_t next = 0;                     /**< offset of the next frame */
+        };
+
+        /*!
+         * \function readFrame
+         * \brief Reads the header of the frame at an offset of the file.
+         * \return false past the last frame, or if the frame is truncated.
+         */
+        bool readFrame(const std::uint64_t p_offset, Frame& p_frame) const;
+
+        /*!
+         * \function readIndex
+         * \brief Reads the index of the keyframes, or else scans the frames to build it.
+         */
+        bool readIndex();
+
+        /*!
+         * \function apply
+         * \brief Decodes a frame into the current generation.
+         */
+        bool apply(const Frame& p_frame);
+
+    private:
+        std::unique_ptr<MappedFile> m_file;             /**< recording */
+        std::uint64_t m_framesEnd = 0;                  /**< offset of the end of the frames */
+        unsigned m_simX = 0;                            /**< abscissa of the grid */
+        unsigned m_simY = 0;                            /**< ordinate of the grid */
+        unsigned m_keyframeInterval = 1;                /**< generations between two keyframes */
+        std::uint64_t m_seed = 0;                       /**< seed of the random numbers */
+        double m_miracleProb = 0;                       /**< probability (%) of the miracles */
+        std::string m_rule;                             /**< rulestring */
+        unsigned m_planes = 0;                          /**< number of state planes */
+        std::uint64_t m_lastGeneration = 0;             /**< last generation recorded */
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> m_keyframes;   /**< generation and offset of each keyframe */
+        std::uint64_t m_generation = 0;                 /**< generation read */
+        std::uint64_t m_next = 0;                       /**< offset of the frame following the generation read */
+        bool m_valid = false;                           /**< true if a generation was read */
+        std::vector<std::uint64_t> m_cells;             /**< cells of the generation read, then the state planes */
+};
+
+#endif // RECORDER_H
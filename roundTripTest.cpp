@@ -0,0 +1,198 @@
+#include "simConfig.h"
+#include "engine.h"
+#include "checkpoint.h"
+#include "cycleDetector.h"
+#include "recorder.h"
+#include "rule.h"
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*!
+ * \file roundTripTest.cpp
+ * \brief main file of the round trip tests.
+ * Checks that a simulation saved to a checkpoint and resumed computes exactly the generations of
+ * a simulation run without interruption, and that a recording replays exactly the generations
+ * recorded, for the rules of two states and for the "Generations" rules, whose dying states are
+ * saved too. Checks as well that the hash of the cycle detector, updated from the changes of each
+ * generation, is the hash of the cells computed again from scratch.
+ * Usage: <em> roundTripTest </em> (returns 1 if a test failed)
+ * \author lhm
+ */
+
+namespace
+{
+    const char* const CHECKPOINT_FILE = "roundTripTest.ckpt";
+    const char* const RECORDING_FILE = "roundTripTest.recd";
+
+    /*!
+     * Returns the bit planes of the states of the cells of an engine
+     */
+    std::vector<std::uint64_t> getStates(const Engine& p_engine, const unsigned p_planes)
+    {
+        std::vector<std::uint64_t> states((std::size_t)p_engine.getChangesWordsPerRow() * p_engine.getSimY() * p_planes);
+        p_engine.getStates(states.data(), p_planes);
+        return states;
+    }
+
+    /*!
+     * Returns the configuration of a small simulation
+     */
+    SimConfig getConfig(const std::string& p_engine, const std::string& p_rule, const double p_miracleProb)
+    {
+        SimConfig config;
+        config.setSimX(150);
+        config.setSimY(70);
+        config.setEngine(p_engine);
+        config.setRule(p_rule);
+        config.setSeed(42);
+        config.setMiracleProb(p_miracleProb);
+        config.setThreadCount(1);
+        return config;
+    }
+
+    /*!
+     * Runs 2n generations, and n generations saved, resumed then n more: returns true if both end in the same states
+     */
+    bool testCheckpoint(const std::string& p_engine, const std::string& p_rule, const double p_miracleProb)
+    {
+        const unsigned generations = 10;
+        const SimConfig config = getConfig(p_engine, p_rule, p_miracleProb);
+
+        Rule rule;
+        rule.parse(p_rule);
+        const unsigned planes = rule.getStateBits();
+
+        auto straight = Engine::create(config);
+        straight->step(2 * generations);
+
+        auto saved = Engine::create(config);
+        saved->step(generations);
+        if (!Checkpoint(config, *saved).save(CHECKPOINT_FILE))
+            return false;
+
+        SimConfig resumedConfig = config;
+        auto resumed = Checkpoint::resume(CHECKPOINT_FILE, resumedConfig);
+        std::remove(CHECKPOINT_FILE);
+        if (!resumed)
+            return false;
+        resumed->step(generations);
+
+        return resumed->getGeneration() == straight->getGeneration()
+            && getStates(*resumed, planes) == getStates(*straight, planes);
+    }
+
+    /*!
+     * Records n generations, then replays them backwards: returns true if every generation replayed
+     * holds the cells and the state planes of the generation recorded
+     */
+    bool testRecording(const std::string& p_engine, const std::string& p_rule, const double p_miracleProb)
+    {
+        const unsigned generations = 20;
+        const SimConfig config = getConfig(p_engine, p_rule, p_miracleProb);
+        const unsigned planes = Checkpoint::getPlaneCount(p_rule);
+
+        auto engine = Engine::create(config);
+        Recorder recorder;
+        if (!recorder.open(RECORDING_FILE, config, *engine, 4))
+            return false;
+        std::vector<std::vector<std::uint64_t>> recorded;
+        for (unsigned i = 0; i <= generations; ++i)
+        {
+            if (i > 0)
+            {
+                engine->step(1);
+                recorder.record(*engine);
+            }
+            std::vector<std::uint64_t> cells((std::size_t)engine->getChangesWordsPerRow() * engine->getSimY());
+            engine->getCells(cells.data());
+            const std::vector<std::uint64_t> states = getStates(*engine, planes);
+            cells.insert(cells.end(), states.begin(), states.end());
+            recorded.push_back(cells);
+        }
+        if (!recorder.close())
+            return false;
+
+        Replay replay;
+        bool passed = replay.open(RECORDING_FILE) && replay.getStatePlanes() == planes;
+        for (unsigned i = generations + 1; passed && i-- > 0;)
+        {
+            passed = replay.seek(i) && replay.getCells() == recorded[i];
+        }
+        std::remove(RECORDING_FILE);
+        return passed;
+    }
+
+    /*!
+     * Runs n generations: returns true if the hash updated at each generation is the one of the cells
+     */
+    bool testCycleHash(const std::string& p_engine, const std::string& p_rule, const double p_miracleProb)
+    {
+        const unsigned generations = 50;
+        const SimConfig config = getConfig(p_engine, p_rule, p_miracleProb);
+
+        auto engine = Engine::create(config);
+        CycleDetector detector;
+        detector.reset(*engine);
+        for (unsigned i = 0; i < generations; ++i)
+        {
+            engine->step(1);
+            detector.update(*engine);
+
+            CycleDetector hashed;
+            hashed.reset(*engine);
+            if (hashed.getHash() != detector.getHash())
+                return false;
+        }
+        return true;
+    }
+}
+
+int main()
+{
+    struct Test
+    {
+        const char* engine;
+        const char* rule;
+        double miracleProb;
+    };
+    const Test tests[] =
+    {
+        { "life", "B3/S23",      0 },
+        { "bit",  "B3/S23",      0.5 },
+        { "rule", "B36/S23",     0 },
+        { "rule", "B2/S/C3",     0 },
+        { "rule", "B2/S/C3",     0.5 },
+        { "rule", "B2/S34/C5H",  0 },
+        { "rule", "B2/S/C200",   0 },
+        { "rule", "B3/S23/C4",   0 },
+        { "rule", "B36/S23/C8",  0 },
+    };
+
+    unsigned failed = 0;
+    for (const Test& test : tests)
+    {
+        const bool passed = testCheckpoint(test.engine, test.rule, test.miracleProb);
+        failed += !passed;
+        std::cout << (passed ? "PASS" : "FAIL") << "  checkpoint  " << test.engine << ' ' << test.rule
+                  << " (miracles " << test.miracleProb << "%)\n";
+    }
+    for (const Test& test : tests)
+    {
+        const bool passed = testRecording(test.engine, test.rule, test.miracleProb);
+        failed += !passed;
+        std::cout << (passed ? "PASS" : "FAIL") << "  recording   " << test.engine << ' ' << test.rule
+                  << " (miracles " << test.miracleProb << "%)\n";
+    }
+    for (const Test& test : tests)
+    {
+        const bool passed = testCycleHash(test.engine, test.rule, test.miracleProb);
+        failed += !passed;
+        std::cout << (passed ? "PASS" : "FAIL") << "  cycle hash  " << test.engine << ' ' << test.rule
+                  << " (miracles " << test.miracleProb << "%)\n";
+    }
+    std::cout << failed << " test(s) failed\n";
+    return failed ? 1 : 0;
+}
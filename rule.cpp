@@ -0,0 +1,177 @@
+#include "rule.h"
+#include <cctype>
+#include <vector>
+
+/**
+ * \file rule.cpp
+ * \brief Implementation of the functions defined in \a rule.h
+ * \author lhm
+ */
+
+namespace
+{
+    /*!
+     * Reads a set of neighbour counts ("236" gives the bits 2, 3 and 6).
+     */
+    bool parseCounts(const std::string& p_digits, unsigned p_max, std::uint32_t& p_set)
+    {
+        p_set = 0;
+        for (char c : p_digits)
+        {
+            if (!std::isdigit((unsigned char)c) || (unsigned)(c - '0') > p_max)
+                return false;
+            p_set |= 1u << (c - '0');
+        }
+        return true;
+    }
+
+    /*!
+     * Reads a number of states.
+     */
+    bool parseStates(const std::string& p_digits, unsigned& p_states)
+    {
+        if (p_digits.empty() || p_digits.size() > 3)
+            return false;
+        unsigned states = 0;
+        for (char c : p_digits)
+        {
+            if (!std::isdigit((unsigned char)c))
+                return false;
+            states = states * 10 + (unsigned)(c - '0');
+        }
+        if (states < 2 || states > 256)
+            return false;
+        p_states = states;
+        return true;
+    }
+}
+
+bool Rule::parse(const std::string& p_rule)
+{
+    Rule rule;
+    std::string text;
+    for (char c : p_rule)
+    {
+        if (!std::isspace((unsigned char)c))
+            text += (char)std::toupper((unsigned char)c);
+    }
+
+    // Neighbourhood suffix
+    if (!text.empty() && (text.back() == 'H' || text.back() == 'V' || text.back() == 'M'))
+    {
+        rule.neighbourhood = text.back() == 'H' ? Neighbourhood::HEXAGONAL
+                           : text.back() == 'V' ? Neighbourhood::VON_NEUMANN
+                           :                      Neighbourhood::MOORE;
+        text.pop_back();
+    }
+    const unsigned maxNeighbours = rule.getMaxNeighbours();
+
+    std::vector<std::string> tokens(1);
+    for (char c : text)
+    {
+        if (c == '/')
+            tokens.emplace_back();
+        else
+            tokens.back() += c;
+    }
+    if (tokens.size() < 2 || tokens.size() > 3)
+        return false;
+
+    if (tokens[0].empty() || (tokens[0][0] != 'B' && tokens[0][0] != 'S'))
+    {
+        // S/B notation, followed by the number of states
+        if (!parseCounts(tokens[0], maxNeighbours, rule.survival) ||
+            !parseCounts(tokens[1], maxNeighbours, rule.birth))
+            return false;
+    }
+    else
+    {
+        // B/S notation, in any order
+        bool hasBirth = false, hasSurvival = false;
+        for (unsigned i = 0; i < 2; ++i)
+        {
+            const std::string& token = tokens[i];
+            if (token.empty())
+                return false;
+            if (token[0] == 'B' && !hasBirth)
+            {
+                hasBirth = parseCounts(token.substr(1), maxNeighbours, rule.birth);
+                if (!hasBirth)
+                    return false;
+            }
+            else if (token[0] == 'S' && !hasSurvival)
+            {
+                hasSurvival = parseCounts(token.substr(1), maxNeighbours, rule.survival);
+                if (!hasSurvival)
+                    return false;
+            }
+            else
+            {
+                return false;
+            }
+        }
+    }
+
+    if (tokens.size() == 3)
+    {
+        std::string states = tokens[2];
+        if (!states.empty() && (states[0] == 'C' || states[0] == 'G'))
+            states.erase(0, 1);
+        if (!parseStates(states, rule.states))
+            return false;
+    }
+
+    *this = rule;
+    return true;
+}
+
+std::string Rule::toString() const
+{
+    std::string text = "B";
+    for (unsigned n = 0; n <= getMaxNeighbours(); ++n)
+    {
+        if ((birth >> n) & 1)
+            text += (char)('0' + n);
+    }
+    text += "/S";
+    for (unsigned n = 0; n <= getMaxNeighbours(); ++n)
+    {
+        if ((survival >> n) & 1)
+            text += (char)('0' + n);
+    }
+    if (states > 2)
+    {
+        text += "/C" + std::to_string(states);
+    }
+    if (neighbourhood == Neighbourhood::HEXAGONAL)
+        text += 'H';
+    else if (neighbourhood == Neighbourhood::VON_NEUMANN)
+        text += 'V';
+    return text;
+}
+
+unsigned Rule::getMaxNeighbours() const
+{
+    switch (neighbourhood)
+    {
+        case Neighbourhood::VON_NEUMANN:    return 4;
+        case Neighbourhood::HEXAGONAL:      return 6;
+        default:                            return 8;
+    }
+}
+
+unsigned Rule::getStateBits() const
+{
+    unsigned bits = 1;
+    while ((1u << bits) < states)
+    {
+        ++bits;
+    }
+    return bits;
+}
+
+bool Rule::isConway() const
+{
+    return neighbourhood == Neighbourhood::MOORE && states == 2 &&
+           birth == 1u << 3 && survival == ((1u << 2) | (1u << 3));
+}
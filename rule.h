@@ -0,0 +1,76 @@
+#ifndef RULE_H
+#define RULE_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * \file rule.h
+ * \brief Definition of the rules of the outer-totalistic cellular automata.
+ * \author lhm
+ */
+
+/*!
+ * \enum Neighbourhood
+ * \brief Enumerate containing the supported neighbourhoods of a cell.
+ * The hexagonal neighbourhood is emulated on the square grid by skewing it: the neighbours
+ * are the Moore ones without the north-east and the south-west cells.
+ */
+enum class Neighbourhood
+{
+    MOORE,                                              /**< 8 neighbours */
+    VON_NEUMANN,                                        /**< 4 orthogonal neighbours */
+    HEXAGONAL                                           /**< 6 neighbours */
+};
+
+/*!
+ * \struct Rule
+ * \brief Outer-totalistic rule: birth and survival sets, number of states and neighbourhood.
+ * A cell of state 0 is dead, 1 is alive, and with more than two states ("Generations" rules)
+ * an alive cell that does not survive goes through the dying states 2 .. states - 1 before
+ * being dead again. Only the alive cells are counted as neighbours.
+ */
+struct Rule
+{
+    std::uint32_t birth = 1u << 3;                      /**< bit n set: a dead cell with n neighbours is born */
+    std::uint32_t survival = (1u << 2) | (1u << 3);     /**< bit n set: an alive cell with n neighbours survives */
+    unsigned states = 2;                                /**< number of states of a cell (2 to 256) */
+    Neighbourhood neighbourhood = Neighbourhood::MOORE; /**< neighbourhood of a cell */
+
+    /*!
+     * \function parse
+     * \brief Reads a rulestring, such as <em>"B3/S23"</em>, <em>"B36/S23"</em>, <em>"B2/S/C3"</em>,
+     * <em>"B2/S34H"</em> (hexagonal) or <em>"B1/S1V"</em> (von Neumann).
+     * The S/B notation (<em>"23/3"</em>) and the Generations notation (<em>"345/2/4"</em>,
+     * <em>"B2/S345/4"</em>) are also accepted.
+     * \param p_rule the rulestring
+     * \return false if the rulestring is invalid, the rule being then left unchanged.
+     */
+    bool parse(const std::string& p_rule);
+
+    /*!
+     * \function toString
+     * \brief Returns the rulestring in the B/S notation.
+     */
+    std::string toString() const;
+
+    /*!
+     * \function getMaxNeighbours
+     * \brief Returns the number of neighbours of a cell.
+     */
+    unsigned getMaxNeighbours() const;
+
+    /*!
+     * \function getStateBits
+     * \brief Returns the number of bits of the state of a cell: 1 for the rules of two states.
+     */
+    unsigned getStateBits() const;
+
+    /*!
+     * \function isConway
+     * \brief Returns true for the rule of the "Game of life" (B3/S23), computed by every engine.
+     */
+    bool isConway() const;
+};
+
+#endif // RULE_H
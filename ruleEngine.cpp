@@ -0,0 +1,258 @@
+#include "ruleEngine.h"
+#include "simConfig.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+/**
+ * \file ruleEngine.cpp
+ * \brief Implementation of the functions defined in \a ruleEngine.h
+ * \author lhm
+ */
+
+namespace
+{
+    Rule readRule(const SimConfig& p_config)
+    {
+        Rule rule;
+        if (!rule.parse(p_config.getRule()))
+        {
+            std::cout << "Invalid rule " << p_config.getRule() << ", using " << rule.toString() << '\n';
+        }
+        return rule;
+    }
+}
+
+RuleEngine::RuleEngine(const SimConfig& p_config)
+    :   Engine      (p_config)
+    ,   m_rule      (readRule(p_config))
+    ,   m_tables    (m_rule)
+    ,   m_kernel    (getRuleRowKernel(m_rule))
+    ,   m_stride    (p_config.getSimX() + 2)
+    ,   m_cells     ((std::size_t)m_stride * (p_config.getSimY() + 2))
+    ,   m_next      (m_cells.size())
+{
+}
+
+Cell RuleEngine::getCell(const unsigned p_x, const unsigned p_y) const
+{
+    return m_cells[getPaddedIndex(p_x, p_y)] == 1 ? Cell::ON : Cell::OFF;
+}
+
+void RuleEngine::setCell(const unsigned p_x, const unsigned p_y, const Cell p_cell)
+{
+    m_cells[getPaddedIndex(p_x, p_y)] = p_cell == Cell::ON;
+    markTileChanged(p_x, p_y);
+}
+
+void RuleEngine::getRows(std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd) const
+{
+    // Only the cells of state 1 are alive: 8 cells are tested at once, as the bytes of a word
+    const std::uint64_t ONES  = 0x0101010101010101ULL;
+    const std::uint64_t LOW7  = 0x7F7F7F7F7F7F7F7FULL;
+    const unsigned wordsPerRow = getChangesWordsPerRow();
+    for (unsigned y = p_yBegin; y < p_yEnd; ++y)
+    {
+        const std::uint8_t* row = &m_cells[getPaddedIndex(0, y)];
+        std::uint64_t* words = p_bitmap + (std::size_t)(y - p_yBegin) * wordsPerRow;
+        std::fill(words, words + wordsPerRow, 0);
+
+        unsigned x = 0;
+        for (; x + 8 <= m_simX; x += 8)
+        {
+            std::uint64_t bytes;
+            std::memcpy(&bytes, row + x, sizeof(bytes));
+
+            // High bit of each byte equal to 1, then the 8 high bits gathered in a byte
+            const std::uint64_t diff = bytes ^ ONES;
+            const std::uint64_t zero = ~(((diff & LOW7) + LOW7) | diff | LOW7);
+            words[x / 64] |= (((zero >> 7) * 0x0102040810204080ULL) >> 56) << (x % 64);
+        }
+        for (; x < m_simX; ++x)
+        {
+            words[x / 64] |= (std::uint64_t)(row[x] == 1) << (x % 64);
+        }
+    }
+}
+
+void RuleEngine::setRows(const std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd)
+{
+    const unsigned wordsPerRow = getChangesWordsPerRow();
+    for (unsigned y = p_yBegin; y < p_yEnd; ++y)
+    {
+        const std::uint64_t* words = p_bitmap + (std::size_t)(y - p_yBegin) * wordsPerRow;
+        std::uint8_t* row = &m_cells[getPaddedIndex(0, y)];
+        for (unsigned x = 0; x < m_simX; ++x)
+        {
+            const std::uint8_t cell = (std::uint8_t)((words[x / 64] >> (x % 64)) & 1);
+            if (row[x] != cell)
+            {
+                row[x] = cell;
+                markTileChanged(x, y);
+            }
+        }
+    }
+}
+
+void RuleEngine::getStates(std::uint64_t* p_planes, const unsigned p_count) const
+{
+    const unsigned wordsPerRow = getChangesWordsPerRow();
+    const std::size_t words = (std::size_t)wordsPerRow * m_simY;
+    std::fill(p_planes, p_planes + p_count * words, 0);
+    for (unsigned y = 0; y < m_simY; ++y)
+    {
+        const std::uint8_t* row = &m_cells[getPaddedIndex(0, y)];
+        for (unsigned x = 0; x < m_simX; ++x)
+        {
+            const std::size_t word = (std::size_t)y * wordsPerRow + x / 64;
+            for (unsigned plane = 0; plane < p_count; ++plane)
+            {
+                p_planes[plane * words + word] |= (std::uint64_t)((row[x] >> plane) & 1) << (x % 64);
+            }
+        }
+    }
+}
+
+void RuleEngine::setStates(const std::uint64_t* p_planes, const unsigned p_count)
+{
+    const unsigned wordsPerRow = getChangesWordsPerRow();
+    const std::size_t words = (std::size_t)wordsPerRow * m_simY;
+    for (unsigned y = 0; y < m_simY; ++y)
+    {
+        std::uint8_t* row = &m_cells[getPaddedIndex(0, y)];
+        for (unsigned x = 0; x < m_simX; ++x)
+        {
+            const std::size_t word = (std::size_t)y * wordsPerRow + x / 64;
+            unsigned state = 0;
+            for (unsigned plane = 0; plane < p_count; ++plane)
+            {
+                state |= (unsigned)((p_planes[plane * words + word] >> (x % 64)) & 1) << plane;
+            }
+
+            // A state past the last one of the rule is a dead cell
+            const std::uint8_t cell = state < m_rule.states ? (std::uint8_t)state : 0;
+            if (row[x] != cell)
+            {
+                row[x] = cell;
+                markTileChanged(x, y);
+            }
+        }
+    }
+}
+
+void RuleEngine::update()
+{
+    wrapHalo(&m_cells[getPaddedIndex(0, 0)], m_stride);
+
+    if (useActiveTiles())
+    {
+        forEachBand(getTilesY(), [this](unsigned p_begin, unsigned p_end)
+        {
+            updateTiles(p_begin, p_end);
+        });
+    }
+    else
+    {
+        forEachRows([this](unsigned p_begin, unsigned p_end)
+        {
+            for (unsigned y = p_begin; y < p_end; ++y)
+            {
+                updateSpan(y, 0, m_simX);
+            }
+        });
+    }
+
+    m_cells.swap(m_next);
+}
+
+void RuleEngine::updateTiles(const unsigned p_tyBegin, const unsigned p_tyEnd)
+{
+    const unsigned tilesX = getTilesX();
+    for (unsigned ty = p_tyBegin; ty < p_tyEnd; ++ty)
+    {
+        if (!isTileRowActive(ty))
+            continue;
+
+        const unsigned yEnd = std::min((ty + 1) * TILE_SIZE, m_simY);
+        for (unsigned y = ty * TILE_SIZE; y < yEnd; ++y)
+        {
+            // Consecutive active tiles are computed as one span
+            unsigned tx = 0;
+            while (tx < tilesX)
+            {
+                if (!isTileActive(tx, ty))
+                {
+                    ++tx;
+                    continue;
+                }
+
+                unsigned txEnd = tx + 1;
+                while (txEnd < tilesX && isTileActive(txEnd, ty))
+                {
+                    ++txEnd;
+                }
+
+                const unsigned xEnd = std::min(txEnd * TILE_SIZE, m_simX);
+                if (updateSpan(y, tx * TILE_SIZE, xEnd))
+                {
+                    markChangedTiles(y, tx, txEnd);
+                }
+                tx = txEnd;
+            }
+        }
+    }
+}
+
+void RuleEngine::markChangedTiles(const unsigned p_y, const unsigned p_txBegin, const unsigned p_txEnd)
+{
+    const std::uint8_t* row  = &m_cells[getPaddedIndex(0, p_y)];
+    const std::uint8_t* next = &m_next[getPaddedIndex(0, p_y)];
+    const unsigned ty = p_y / TILE_SIZE;
+    for (unsigned tx = p_txBegin; tx < p_txEnd; ++tx)
+    {
+        if (hasTileChanged(tx, ty))
+            continue;
+
+        const unsigned x    = tx * TILE_SIZE;
+        const unsigned size = std::min(TILE_SIZE, m_simX - x);
+        if (std::memcmp(row + x, next + x, size) != 0)
+        {
+            setTileChanged(tx, ty);
+        }
+    }
+}
+
+bool RuleEngine::updateSpan(const unsigned p_y, const unsigned p_xBegin, const unsigned p_xEnd)
+{
+    // The halo gives every cell of the grid its neighbours
+    const std::uint8_t* row   = &m_cells[getPaddedIndex(0, p_y)];
+    const std::uint8_t* above = row - m_stride;
+    const std::uint8_t* below = row + m_stride;
+    std::uint8_t*       next  = &m_next[getPaddedIndex(0, p_y)];
+
+    m_kernel(above, row, below, next, m_tables, p_xBegin, p_xEnd);
+
+    // Dead cell not born from its neighbours: may get a miracle
+    forEachMiracle(p_y, p_xBegin, p_xEnd, [row, next](unsigned p_x)
+    {
+        next[p_x] |= (std::uint8_t)!row[p_x];
+    });
+
+    if (std::memcmp(row + p_xBegin, next + p_xBegin, p_xEnd - p_xBegin) == 0)
+    {
+        return false;
+    }
+
+    // Only the cells turning alive or dead are changes: not the steps of the dying states
+    if (m_trackChanges)
+    {
+        for (unsigned x = p_xBegin; x < p_xEnd; ++x)
+        {
+            if ((row[x] == 1) != (next[x] == 1))
+            {
+                markChanged(x, p_y);
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,117 @@
+#ifndef RULEENGINE_H
+#define RULEENGINE_H
+
+#include <cstdint>
+#include <vector>
+#include "engine.h"
+#include "rule.h"
+#include "ruleKernel.h"
+
+/**
+ * \file ruleEngine.h
+ * \brief Definition of an engine applying any outer-totalistic rule (see \a rule.h).
+ * \author lhm
+ */
+
+/*!
+ * \class RuleEngine
+ * \brief Engine applying the rule read from the <em>"rule"</em> rulestring of the configuration.
+ * Each cell is stored in a byte holding its state. The rows are padded with a cell on each
+ * side, and the grid with a row above and below, so that the neighbours of every cell can be
+ * read without any test. This halo holds dead cells, or the cells of the opposite edges on a
+ * torus (see \a Engine::wrapHalo).
+ * The row kernel, specialised for the neighbourhood and the number of states of the rule,
+ * is chosen once when the engine is created (see \a ruleKernel.h).
+ */
+class RuleEngine : public Engine
+{
+    public:
+        /*!
+         * \function RuleEngine
+         * \brief Creates the engine, with dead cells (see \a Engine::create).
+         * An invalid rulestring is replaced by the rule of the "Game of life".
+         * \param p_config The configuration of the simulation.
+         */
+        explicit RuleEngine(const SimConfig& p_config);
+
+        /*!
+         * \function getCell
+         * \brief Returns the state of the requested cell: only the alive cells are \a ON.
+         */
+        Cell getCell(const unsigned p_x, const unsigned p_y) const override;
+
+        void setCell(const unsigned p_x, const unsigned p_y, const Cell p_cell) override;
+
+        void getRows(std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd) const override;
+
+        void setRows(const std::uint64_t* p_bitmap, const unsigned p_yBegin, const unsigned p_yEnd) override;
+
+        void getStates(std::uint64_t* p_planes, const unsigned p_count) const override;
+
+        void setStates(const std::uint64_t* p_planes, const unsigned p_count) override;
+
+        /*!
+         * \function getState
+         * \brief Returns the state of the requested cell (0 dead, 1 alive, then the dying states).
+         * \param p_x the requested abscissa
+         * \param p_y the requested ordinate
+         */
+        std::uint8_t getState(const unsigned p_x, const unsigned p_y) const { return m_cells[getPaddedIndex(p_x, p_y)]; }
+
+        /*!
+         * Get the rule applied by the engine
+         */
+        const Rule& getRule() const { return m_rule; }
+
+    protected:
+        /*!
+         * \function update
+         * \brief Computes the next generation into \a m_next, then swaps the buffers.
+         */
+        void update() override;
+
+        /*!
+         * \function updateTiles
+         * \brief Computes the next generation of the active tiles of a band of rows of tiles.
+         * \param p_tyBegin the first row of tiles of the band
+         * \param p_tyEnd the past-the-end row of tiles of the band
+         */
+        void updateTiles(const unsigned p_tyBegin, const unsigned p_tyEnd);
+
+        /*!
+         * \function markChangedTiles
+         * \brief Records the tiles whose cells changed on a computed row.
+         * \param p_y the ordinate of the row
+         * \param p_txBegin the first tile of the computed span
+         * \param p_txEnd the past-the-end tile of the computed span
+         */
+        void markChangedTiles(const unsigned p_y, const unsigned p_txBegin, const unsigned p_txEnd);
+
+        /*!
+         * \function updateSpan
+         * \brief Computes the next generation of the cells [p_xBegin, p_xEnd) of a row.
+         * \param p_y the ordinate of the row
+         * \param p_xBegin the first cell to compute
+         * \param p_xEnd the past-the-end cell to compute
+         * \return true if at least one of the cells changed.
+         */
+        bool updateSpan(const unsigned p_y, const unsigned p_xBegin, const unsigned p_xEnd);
+
+    private:
+        /*!
+         * Returns the index of a cell in the padded grid
+         */
+        std::size_t getPaddedIndex(const unsigned p_x, const unsigned p_y) const
+        {
+            return (std::size_t)(p_y + 1) * m_stride + p_x + 1;
+        }
+
+        const Rule m_rule;                              /**< rule applied by the engine */
+        const RuleTables m_tables;                      /**< next states of the rule */
+        const RuleRowKernel m_kernel;                   /**< kernel specialised for the rule */
+        const unsigned m_stride;                        /**< number of cells of a padded row */
+        std::vector<std::uint8_t> m_cells;              /**< state of the cells, padded with a halo (see \a Engine::wrapHalo) */
+        std::vector<std::uint8_t> m_next;               /**< next generation of the cells */
+};
+
+#endif // RULEENGINE_H
@@ -0,0 +1,254 @@
+#include "ruleKernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RULE_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * \file ruleKernel.cpp
+ * \brief Implementation of the functions defined in \a ruleKernel.h
+ * The vectorised kernels sum the shifted neighbour rows 16 (SSSE3) or 32 (AVX2) cells at
+ * a time, then read the next state of the dead and alive cells in the tables of the rule
+ * with a byte shuffle. The cells left after the last full vector are computed by the scalar code.
+ * \author lhm
+ */
+
+RuleTables::RuleTables(const Rule& p_rule)
+    :   birth       {}
+    ,   survival    {}
+    ,   states      ((std::uint8_t)p_rule.states)
+{
+    // A dead cell is born or stays dead, an alive cell survives or starts dying
+    const std::uint8_t dies = p_rule.states > 2 ? 2 : 0;
+    for (unsigned count = 0; count <= p_rule.getMaxNeighbours(); ++count)
+    {
+        birth[count]    = (p_rule.birth >> count) & 1;
+        survival[count] = (p_rule.survival >> count) & 1 ? 1 : dies;
+    }
+}
+
+namespace
+{
+    /*!
+     * Returns 1 if the state is alive, 0 otherwise.
+     */
+    template<bool Generations>
+    inline unsigned alive(const std::uint8_t p_state)
+    {
+        return Generations ? p_state == 1 : p_state;
+    }
+
+    /*!
+     * Computes the cells [p_begin, p_end) of the row with the scalar code.
+     * The tests on the template parameters are resolved at compile time.
+     */
+    template<Neighbourhood N, bool Generations>
+    void rowScalar(const std::uint8_t* p_above,
+                   const std::uint8_t* p_row,
+                   const std::uint8_t* p_below,
+                   std::uint8_t*       p_next,
+                   const RuleTables&   p_tables,
+                   unsigned            p_begin,
+                   unsigned            p_end)
+    {
+        for (unsigned x = p_begin; x < p_end; ++x)
+        {
+            // The padding cell left of the row is at index -1
+            const std::uint8_t* a = p_above + x;
+            const std::uint8_t* r = p_row   + x;
+            const std::uint8_t* b = p_below + x;
+
+            unsigned count = alive<Generations>(a[0])  + alive<Generations>(b[0])
+                           + alive<Generations>(r[-1]) + alive<Generations>(r[1]);
+            if (N != Neighbourhood::VON_NEUMANN)
+            {
+                count += alive<Generations>(a[-1]) + alive<Generations>(b[1]);
+            }
+            if (N == Neighbourhood::MOORE)
+            {
+                count += alive<Generations>(a[1]) + alive<Generations>(b[-1]);
+            }
+
+            const std::uint8_t state = r[0];
+            if (Generations)
+            {
+                const std::uint8_t dying = (std::uint8_t)(state + 1) == p_tables.states ? 0 : (std::uint8_t)(state + 1);
+                p_next[x] = state == 0 ? p_tables.birth[count] : state == 1 ? p_tables.survival[count] : dying;
+            }
+            else
+            {
+                p_next[x] = state ? p_tables.survival[count] : p_tables.birth[count];
+            }
+        }
+    }
+
+#ifdef RULE_KERNEL_X86
+    __attribute__((target("ssse3")))
+    inline __m128i load(const std::uint8_t* p_ptr)
+    {
+        return _mm_loadu_si128((const __m128i*)p_ptr);
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i load256(const std::uint8_t* p_ptr)
+    {
+        return _mm256_loadu_si256((const __m256i*)p_ptr);
+    }
+
+    template<bool Generations>
+    __attribute__((target("ssse3")))
+    inline __m128i alive(const std::uint8_t* p_ptr, const __m128i p_one)
+    {
+        return Generations ? _mm_and_si128(_mm_cmpeq_epi8(load(p_ptr), p_one), p_one) : load(p_ptr);
+    }
+
+    template<bool Generations>
+    __attribute__((target("avx2")))
+    inline __m256i alive256(const std::uint8_t* p_ptr, const __m256i p_one)
+    {
+        return Generations ? _mm256_and_si256(_mm256_cmpeq_epi8(load256(p_ptr), p_one), p_one) : load256(p_ptr);
+    }
+
+    template<Neighbourhood N, bool Generations>
+    __attribute__((target("ssse3")))
+    void rowSsse3(const std::uint8_t* p_above,
+                  const std::uint8_t* p_row,
+                  const std::uint8_t* p_below,
+                  std::uint8_t*       p_next,
+                  const RuleTables&   p_tables,
+                  unsigned            p_begin,
+                  unsigned            p_end)
+    {
+        const __m128i zero     = _mm_setzero_si128();
+        const __m128i one      = _mm_set1_epi8(1);
+        const __m128i states   = _mm_set1_epi8((char)p_tables.states);
+        const __m128i birth    = load(p_tables.birth);
+        const __m128i survival = load(p_tables.survival);
+
+        unsigned x = p_begin;
+        for (; x + 16 <= p_end; x += 16)
+        {
+            const std::uint8_t* a = p_above + x;
+            const std::uint8_t* r = p_row   + x;
+            const std::uint8_t* b = p_below + x;
+
+            __m128i count = _mm_add_epi8(alive<Generations>(a, one), alive<Generations>(b, one));
+            count = _mm_add_epi8(count, alive<Generations>(r - 1, one));
+            count = _mm_add_epi8(count, alive<Generations>(r + 1, one));
+            if (N != Neighbourhood::VON_NEUMANN)
+            {
+                count = _mm_add_epi8(count, alive<Generations>(a - 1, one));
+                count = _mm_add_epi8(count, alive<Generations>(b + 1, one));
+            }
+            if (N == Neighbourhood::MOORE)
+            {
+                count = _mm_add_epi8(count, alive<Generations>(a + 1, one));
+                count = _mm_add_epi8(count, alive<Generations>(b - 1, one));
+            }
+
+            const __m128i state   = load(r);
+            const __m128i isAlive = _mm_cmpeq_epi8(state, one);
+            const __m128i born    = _mm_shuffle_epi8(birth, count);
+            const __m128i stays   = _mm_shuffle_epi8(survival, count);
+            __m128i result = _mm_or_si128(_mm_and_si128(isAlive, stays), _mm_andnot_si128(isAlive, born));
+            if (Generations)
+            {
+                // Dying cells go to the next state, and are dead after the last one
+                const __m128i isDead  = _mm_cmpeq_epi8(state, zero);
+                __m128i dying = _mm_add_epi8(state, one);
+                dying  = _mm_andnot_si128(_mm_cmpeq_epi8(dying, states), dying);
+                result = _mm_and_si128(result, _mm_or_si128(isDead, isAlive));
+                result = _mm_or_si128(result, _mm_andnot_si128(_mm_or_si128(isDead, isAlive), dying));
+            }
+            _mm_storeu_si128((__m128i*)(p_next + x), result);
+        }
+        rowScalar<N, Generations>(p_above, p_row, p_below, p_next, p_tables, x, p_end);
+    }
+
+    template<Neighbourhood N, bool Generations>
+    __attribute__((target("avx2")))
+    void rowAvx2(const std::uint8_t* p_above,
+                 const std::uint8_t* p_row,
+                 const std::uint8_t* p_below,
+                 std::uint8_t*       p_next,
+                 const RuleTables&   p_tables,
+                 unsigned            p_begin,
+                 unsigned            p_end)
+    {
+        const __m256i zero     = _mm256_setzero_si256();
+        const __m256i one      = _mm256_set1_epi8(1);
+        const __m256i states   = _mm256_set1_epi8((char)p_tables.states);
+        const __m256i birth    = _mm256_broadcastsi128_si256(load(p_tables.birth));
+        const __m256i survival = _mm256_broadcastsi128_si256(load(p_tables.survival));
+
+        unsigned x = p_begin;
+        for (; x + 32 <= p_end; x += 32)
+        {
+            const std::uint8_t* a = p_above + x;
+            const std::uint8_t* r = p_row   + x;
+            const std::uint8_t* b = p_below + x;
+
+            __m256i count = _mm256_add_epi8(alive256<Generations>(a, one), alive256<Generations>(b, one));
+            count = _mm256_add_epi8(count, alive256<Generations>(r - 1, one));
+            count = _mm256_add_epi8(count, alive256<Generations>(r + 1, one));
+            if (N != Neighbourhood::VON_NEUMANN)
+            {
+                count = _mm256_add_epi8(count, alive256<Generations>(a - 1, one));
+                count = _mm256_add_epi8(count, alive256<Generations>(b + 1, one));
+            }
+            if (N == Neighbourhood::MOORE)
+            {
+                count = _mm256_add_epi8(count, alive256<Generations>(a + 1, one));
+                count = _mm256_add_epi8(count, alive256<Generations>(b - 1, one));
+            }
+
+            const __m256i state   = load256(r);
+            const __m256i isAlive = _mm256_cmpeq_epi8(state, one);
+            const __m256i born    = _mm256_shuffle_epi8(birth, count);
+            const __m256i stays   = _mm256_shuffle_epi8(survival, count);
+            __m256i result = _mm256_blendv_epi8(born, stays, isAlive);
+            if (Generations)
+            {
+                // Dying cells go to the next state, and are dead after the last one
+                const __m256i isDead  = _mm256_cmpeq_epi8(state, zero);
+                __m256i dying = _mm256_add_epi8(state, one);
+                dying  = _mm256_andnot_si256(_mm256_cmpeq_epi8(dying, states), dying);
+                result = _mm256_blendv_epi8(dying, result, _mm256_or_si256(isDead, isAlive));
+            }
+            _mm256_storeu_si256((__m256i*)(p_next + x), result);
+        }
+        rowScalar<N, Generations>(p_above, p_row, p_below, p_next, p_tables, x, p_end);
+    }
+#endif
+
+    template<Neighbourhood N, bool Generations>
+    RuleRowKernel selectInstructions()
+    {
+#ifdef RULE_KERNEL_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return rowAvx2<N, Generations>;
+        if (__builtin_cpu_supports("ssse3"))
+            return rowSsse3<N, Generations>;
+#endif
+        return rowScalar<N, Generations>;
+    }
+
+    template<bool Generations>
+    RuleRowKernel selectNeighbourhood(const Neighbourhood p_neighbourhood)
+    {
+        switch (p_neighbourhood)
+        {
+            case Neighbourhood::VON_NEUMANN:    return selectInstructions<Neighbourhood::VON_NEUMANN, Generations>();
+            case Neighbourhood::HEXAGONAL:      return selectInstructions<Neighbourhood::HEXAGONAL, Generations>();
+            default:                            return selectInstructions<Neighbourhood::MOORE, Generations>();
+        }
+    }
+}
+
+RuleRowKernel getRuleRowKernel(const Rule& p_rule)
+{
+    return p_rule.states > 2 ? selectNeighbourhood<true>(p_rule.neighbourhood)
+                             : selectNeighbourhood<false>(p_rule.neighbourhood);
+}
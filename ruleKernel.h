@@ -0,0 +1,59 @@
+#ifndef RULEKERNEL_H
+#define RULEKERNEL_H
+
+#include <cstdint>
+#include "rule.h"
+
+/**
+ * \file ruleKernel.h
+ * \brief Row kernels applying an outer-totalistic rule to grids storing one byte per cell.
+ * A kernel is specialised at compile time for each neighbourhood, with and without the dying
+ * states of the "Generations" rules, and for each instruction set (AVX2, SSSE3 or scalar).
+ * The birth and survival sets are applied by a lookup in 16 bytes tables, so that no rule
+ * is interpreted per cell.
+ * \author lhm
+ */
+
+/*!
+ * \struct RuleTables
+ * \brief Next state of a cell for each number of its alive neighbours.
+ */
+struct RuleTables
+{
+    std::uint8_t birth[16];                             /**< next state of a dead cell */
+    std::uint8_t survival[16];                          /**< next state of an alive cell */
+    std::uint8_t states;                                /**< number of states (0 for 256): a dying cell then dies */
+
+    /*!
+     * \function RuleTables
+     * \brief Builds the tables of a rule.
+     */
+    explicit RuleTables(const Rule& p_rule);
+};
+
+/*!
+ * \brief Computes the next generation of the cells [p_begin, p_end) of a row.
+ * The rows must be padded: the cells -1 and \a p_end of each row are read.
+ * \param p_above the row above
+ * \param p_row the row to compute
+ * \param p_below the row below
+ * \param p_next the next generation of the row
+ * \param p_tables the tables of the rule
+ * \param p_begin the first cell to compute
+ * \param p_end the past-the-end cell to compute
+ */
+typedef void (*RuleRowKernel)(const std::uint8_t* p_above,
+                              const std::uint8_t* p_row,
+                              const std::uint8_t* p_below,
+                              std::uint8_t*       p_next,
+                              const RuleTables&   p_tables,
+                              unsigned            p_begin,
+                              unsigned            p_end);
+
+/*!
+ * \function getRuleRowKernel
+ * \brief Returns the fastest row kernel specialised for the rule supported by the processor.
+ */
+RuleRowKernel getRuleRowKernel(const Rule& p_rule);
+
+#endif // RULEKERNEL_H
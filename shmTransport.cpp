@@ -0,0 +1,191 @@
+#include "shmTransport.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/**
+ * \file shmTransport.cpp
+ * \brief Implementation of the functions defined in \a shmTransport.h
+ * \author lhm
+ */
+
+// POSIX shared memory only: the distributed runner is built on Linux only
+#ifndef _WIN32
+
+namespace
+{
+    /*!
+     * Shared state of the simulation, at the start of the segment (followed by the rings)
+     */
+    struct Header
+    {
+        alignas(64) std::atomic<unsigned> aborted;      /**< non-zero once the simulation is aborted */
+    };
+
+    const unsigned SPINS_BEFORE_YIELD = 64;             /**< waits spinning before yielding the core */
+    const unsigned SPINS_PER_HOOK     = 1024;           /**< waits between two calls to the wait hook */
+}
+
+ShmTransport::~ShmTransport()
+{
+    if (m_memory)
+        munmap(m_memory, m_size);
+}
+
+bool ShmTransport::create(const std::string& p_name, const unsigned p_workers, const std::size_t p_ringWords)
+{
+    m_workers    = p_workers;
+    m_worker     = -1;
+    m_ringWords  = std::max<std::size_t>(p_ringWords, 1);
+    m_ringStride = (sizeof(Ring) + m_ringWords * sizeof(std::uint64_t) + 63) / 64 * 64;
+    m_size       = sizeof(Header) + (std::size_t)p_workers * CHANNEL_COUNT * m_ringStride;
+
+    const int file = shm_open(p_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (file < 0)
+    {
+        std::cout << "Unable to create the shared memory " << p_name << ": " << std::strerror(errno) << '\n';
+        return false;
+    }
+
+    // The workers inherit the mapping: the name is not needed anymore
+    void* memory = ftruncate(file, (off_t)m_size) == 0 ? mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0) : MAP_FAILED;
+    shm_unlink(p_name.c_str());
+    close(file);
+    if (memory == MAP_FAILED)
+    {
+        std::cout << "Unable to map the shared memory " << p_name << ": " << std::strerror(errno) << '\n';
+        return false;
+    }
+    m_memory = memory;
+
+    new (m_memory) Header();
+    for (unsigned worker = 0; worker < p_workers; ++worker)
+    {
+        for (unsigned channel = 0; channel < CHANNEL_COUNT; ++channel)
+        {
+            new (&getRing(worker, (Channel)channel)) Ring();
+        }
+    }
+    return true;
+}
+
+bool ShmTransport::send(const Peer p_peer, const std::uint64_t* p_words, const std::size_t p_count)
+{
+    const Channel channel = p_peer == ABOVE ? TO_ABOVE : p_peer == BELOW ? TO_BELOW : TO_COORDINATOR;
+    return write(getRing((unsigned)m_worker, channel), p_words, p_count);
+}
+
+bool ShmTransport::receive(const Peer p_peer, std::uint64_t* p_words, const std::size_t p_count)
+{
+    // The rows from the band above were sent to the band below it, and conversely
+    const unsigned worker = (unsigned)m_worker;
+    if (p_peer == ABOVE)
+        return read(getRing((worker + m_workers - 1) % m_workers, TO_BELOW), p_words, p_count);
+    if (p_peer == BELOW)
+        return read(getRing((worker + 1) % m_workers, TO_ABOVE), p_words, p_count);
+    return read(getRing(worker, FROM_COORDINATOR), p_words, p_count);
+}
+
+bool ShmTransport::sendTo(const unsigned p_worker, const std::uint64_t* p_words, const std::size_t p_count)
+{
+    return write(getRing(p_worker, FROM_COORDINATOR), p_words, p_count);
+}
+
+bool ShmTransport::receiveFrom(const unsigned p_worker, std::uint64_t* p_words, const std::size_t p_count)
+{
+    return read(getRing(p_worker, TO_COORDINATOR), p_words, p_count);
+}
+
+void ShmTransport::abort()
+{
+    if (m_memory)
+        static_cast<Header*>(m_memory)->aborted.store(1);
+}
+
+ShmTransport::Ring& ShmTransport::getRing(const unsigned p_worker, const Channel p_channel) const
+{
+    std::uint8_t* rings = static_cast<std::uint8_t*>(m_memory) + sizeof(Header);
+    return *reinterpret_cast<Ring*>(rings + ((std::size_t)p_worker * CHANNEL_COUNT + p_channel) * m_ringStride);
+}
+
+bool ShmTransport::write(Ring& p_ring, const std::uint64_t* p_words, const std::size_t p_count)
+{
+    std::uint64_t* words = reinterpret_cast<std::uint64_t*>(&p_ring + 1);
+    std::uint64_t written = p_ring.written.load(std::memory_order_relaxed);
+    unsigned spins = 0;
+    for (std::size_t done = 0; done < p_count; )
+    {
+        const std::size_t room = m_ringWords - (std::size_t)(written - p_ring.read.load(std::memory_order_acquire));
+        if (room == 0)
+        {
+            if (!wait(spins))
+                return false;
+            continue;
+        }
+
+        // The words may wrap around the end of the ring
+        const std::size_t count = std::min(room, p_count - done);
+        const std::size_t start = (std::size_t)(written % m_ringWords);
+        const std::size_t first = std::min(count, m_ringWords - start);
+        std::copy(p_words + done, p_words + done + first, words + start);
+        std::copy(p_words + done + first, p_words + done + count, words);
+        written += count;
+        done    += count;
+        p_ring.written.store(written, std::memory_order_release);
+    }
+    return true;
+}
+
+bool ShmTransport::read(Ring& p_ring, std::uint64_t* p_words, const std::size_t p_count)
+{
+    const std::uint64_t* words = reinterpret_cast<const std::uint64_t*>(&p_ring + 1);
+    std::uint64_t read = p_ring.read.load(std::memory_order_relaxed);
+    unsigned spins = 0;
+    for (std::size_t done = 0; done < p_count; )
+    {
+        const std::size_t available = (std::size_t)(p_ring.written.load(std::memory_order_acquire) - read);
+        if (available == 0)
+        {
+            if (!wait(spins))
+                return false;
+            continue;
+        }
+
+        const std::size_t count = std::min(available, p_count - done);
+        const std::size_t start = (std::size_t)(read % m_ringWords);
+        const std::size_t first = std::min(count, m_ringWords - start);
+        std::copy(words + start, words + start + first, p_words + done);
+        std::copy(words, words + count - first, p_words + done + first);
+        read += count;
+        done += count;
+        p_ring.read.store(read, std::memory_order_release);
+    }
+    return true;
+}
+
+bool ShmTransport::wait(unsigned& p_spins)
+{
+    if (static_cast<Header*>(m_memory)->aborted.load(std::memory_order_relaxed))
+        return false;
+
+    if (++p_spins % SPINS_PER_HOOK == 0 && m_waitHook && !m_waitHook())
+    {
+        abort();
+        return false;
+    }
+    if (p_spins > SPINS_BEFORE_YIELD)
+        std::this_thread::yield();
+    return true;
+}
+
+#endif // _WIN32
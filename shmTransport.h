@@ -0,0 +1,153 @@
+#ifndef SHMTRANSPORT_H
+#define SHMTRANSPORT_H
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include "transport.h"
+
+/**
+ * \file shmTransport.h
+ * \brief Definition of the transport of a distributed simulation through POSIX shared memory.
+ * \author lhm
+ */
+
+/*!
+ * \class ShmTransport
+ * \brief Transport between the processes of one machine: the coordinator creates a shared memory
+ * segment holding a ring buffer of words for each direction of each channel, then forks the
+ * workers, which inherit the mapping (see \a setWorker).
+ * Each ring has a single writer and a single reader, which only share the number of words
+ * written and read: no lock is taken. A process waiting for a ring yields its core.
+ * The segment is unlinked as soon as it is mapped, so that nothing is left behind by the
+ * processes, even if they are killed.
+ */
+class ShmTransport : public Transport
+{
+    public:
+        static const std::size_t DEFAULT_RING_WORDS = 1 << 16; /**< default capacity of a ring, in words */
+
+        /*!
+         * \function ShmTransport
+         * \brief Creates an endpoint without any segment (see \a create).
+         */
+        ShmTransport() = default;
+
+        /*!
+         * \function ~ShmTransport
+         * \brief Unmaps the segment.
+         */
+        ~ShmTransport() override;
+
+        /*!
+         * Copy constructor is prohibited.
+         */
+        ShmTransport            (const ShmTransport& other) = delete;
+
+        /*!
+         * Assignment constructor is prohibited.
+         */
+        ShmTransport& operator= (const ShmTransport& other) = delete;
+
+        /*!
+         * \function create
+         * \brief Creates the segment of the rings, the endpoint being the one of the coordinator.
+         * \param p_name the name of the segment (<em>"/name"</em>)
+         * \param p_workers the number of workers
+         * \param p_ringWords the capacity of each ring, in words: at least the largest message
+         * sent before receiving (a row of the grid)
+         * \return false if the segment cannot be created.
+         */
+        bool create(const std::string& p_name, const unsigned p_workers, const std::size_t p_ringWords = DEFAULT_RING_WORDS);
+
+        /*!
+         * \function setWorker
+         * \brief Makes the endpoint the one of a worker, in the process of the worker.
+         * \param p_worker the worker
+         */
+        void setWorker(const unsigned p_worker) { m_worker = (int)p_worker; }
+
+        /*!
+         * \function setWaitHook
+         * \brief Sets a function called from time to time while waiting for a ring: the simulation is
+         * aborted if it returns false (for instance, when a process of the simulation died).
+         * \param p_hook the function
+         */
+        void setWaitHook(std::function<bool()> p_hook) { m_waitHook = std::move(p_hook); }
+
+        unsigned getWorkerCount() const override { return m_workers; }
+
+        bool send(const Peer p_peer, const std::uint64_t* p_words, const std::size_t p_count) override;
+
+        bool receive(const Peer p_peer, std::uint64_t* p_words, const std::size_t p_count) override;
+
+        bool sendTo(const unsigned p_worker, const std::uint64_t* p_words, const std::size_t p_count) override;
+
+        bool receiveFrom(const unsigned p_worker, std::uint64_t* p_words, const std::size_t p_count) override;
+
+        void abort() override;
+
+    protected:
+        /*!
+         * \struct Ring
+         * \brief Counters of a ring buffer, followed in the segment by its words.
+         * The counters are on their own cache lines, as they are written by different processes.
+         */
+        struct Ring
+        {
+            alignas(64) std::atomic<std::uint64_t> written; /**< number of words written */
+            alignas(64) std::atomic<std::uint64_t> read;    /**< number of words read */
+        };
+
+        /*!
+         * \enum Channel
+         * \brief Rings of each worker.
+         */
+        enum Channel
+        {
+            TO_ABOVE,                                   /**< from the worker to the worker of the band above */
+            TO_BELOW,                                   /**< from the worker to the worker of the band below */
+            TO_COORDINATOR,                             /**< from the worker to the coordinator */
+            FROM_COORDINATOR,                           /**< from the coordinator to the worker */
+            CHANNEL_COUNT
+        };
+
+        /*!
+         * \function getRing
+         * \brief Returns the ring of a channel of a worker.
+         */
+        Ring& getRing(const unsigned p_worker, const Channel p_channel) const;
+
+        /*!
+         * \function write
+         * \brief Writes words into a ring, waiting for the room needed.
+         * \return false if the simulation was aborted.
+         */
+        bool write(Ring& p_ring, const std::uint64_t* p_words, const std::size_t p_count);
+
+        /*!
+         * \function read
+         * \brief Reads words from a ring, waiting for them.
+         * \return false if the simulation was aborted.
+         */
+        bool read(Ring& p_ring, std::uint64_t* p_words, const std::size_t p_count);
+
+        /*!
+         * \function wait
+         * \brief Waits a little for a ring.
+         * \param p_spins the number of times the caller waited so far
+         * \return false if the simulation was aborted.
+         */
+        bool wait(unsigned& p_spins);
+
+    private:
+        void* m_memory = nullptr;                       /**< mapping of the segment */
+        std::size_t m_size = 0;                         /**< size of the segment, in bytes */
+        std::size_t m_ringWords = 0;                    /**< capacity of each ring, in words */
+        std::size_t m_ringStride = 0;                   /**< distance between two rings, in bytes */
+        unsigned m_workers = 0;                         /**< number of workers */
+        int m_worker = -1;                              /**< worker of the endpoint (-1 for the coordinator) */
+        std::function<bool()> m_waitHook;               /**< check run while waiting */
+};
+
+#endif // SHMTRANSPORT_H
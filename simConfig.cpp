@@ -0,0 +1,132 @@
+#include "simConfig.h"
+#include <iostream>
+#include <fstream>
+
+/**
+ * \file simConfig.cpp
+ * \brief Implementation of the functions defined in \a simConfig.h
+ * \author lhm
+ */
+
+void SimConfig::loadConfig(const std::string& p_file)
+{
+    std::ifstream inFile(p_file);
+    if (!inFile.is_open())
+    {
+        std::cout << "Unable to load config, making default settings\n";
+        loadDefaults();
+
+        return;
+    }
+
+    std::string line;
+    while (std::getline(inFile, line))
+    {
+        parseEntry(line, inFile);
+    }
+    init();
+}
+
+bool SimConfig::parseEntry(const std::string& p_key, std::istream& p_in)
+{
+    unsigned tmp;
+    if (p_key == "simx")
+    {
+        p_in >> tmp;
+        setSimX(tmp);
+    }
+    else if (p_key == "simy")
+    {
+        p_in >> tmp;
+        setSimY(tmp);
+    }
+    else if (p_key == "miracleProb")
+    {
+        p_in >> miracle_prob;
+    }
+    else if (p_key == "engine")
+    {
+        p_in >> engine;
+    }
+    else if (p_key == "threads")
+    {
+        p_in >> tmp;
+        setThreadCount(tmp);
+    }
+    else if (p_key == "activeTiles")
+    {
+        p_in >> tmp;
+        setActiveTiles(tmp != 0);
+    }
+    else if (p_key == "boundary")
+    {
+        p_in >> boundary;
+    }
+    else if (p_key == "temporalBlocking")
+    {
+        p_in >> tmp;
+        setTemporalBlocking(tmp);
+    }
+    else if (p_key == "hashlifeMemory")
+    {
+        p_in >> tmp;
+        setHashLifeMemory(tmp);
+    }
+    else if (p_key == "rule")
+    {
+        p_in >> rule;
+    }
+    else if (p_key == "seed")
+    {
+        p_in >> seed;
+    }
+    else if (p_key == "generationRate")
+    {
+        p_in >> generationRate;
+    }
+    else if (p_key == "resume")
+    {
+        p_in >> resumeFile;
+    }
+    else if (p_key == "checkpoint")
+    {
+        p_in >> checkpointFile;
+    }
+    else if (p_key == "record")
+    {
+        p_in >> recordFile;
+    }
+    else if (p_key == "keyframeInterval")
+    {
+        p_in >> tmp;
+        setKeyframeInterval(tmp);
+    }
+    else if (p_key == "cycle")
+    {
+        p_in >> cycle;
+    }
+    else if (p_key == "cycleHistory")
+    {
+        p_in >> tmp;
+        setCycleHistory(tmp);
+    }
+    else if (p_key == "pattern")
+    {
+        p_in >> patternFile;
+    }
+    else if (p_key == "patternOffset")
+    {
+        p_in >> patternX;
+        p_in >> patternY;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+void SimConfig::loadDefaults()
+{
+    setMiracleProb(5);
+}
@@ -0,0 +1,307 @@
+#ifndef SIMCONFIG_H
+#define SIMCONFIG_H
+
+/**
+ * \file simConfig.h
+ * \brief Configuration of the simulation itself (grid size, miracle probability...).
+ * Contains every setting the simulation engines need, without any dependency on SFML,
+ * so that it can be shared by the windowed application and the headless runner.
+ * \author lhm
+ */
+
+#include <cstdint>
+#include <ctime>
+#include <istream>
+#include <string>
+
+/*!
+ * \class SimConfig
+ * \brief Configuration class containing the settings of the simulation engine.
+ */
+class SimConfig
+{
+    public:
+        SimConfig() = default;
+
+        /*!
+         * \function SimConfig
+         * \brief Creates a \a SimConfig object.
+         * \param p_simX abscissa of the simulation
+         * \param p_simY ordinate of the simulation
+         */
+        SimConfig(unsigned p_simX, unsigned p_simY)
+            :   simX    (p_simX)
+            ,   simY    (p_simY)
+        {}
+
+        /*!
+         * Default destructor
+         */
+        virtual ~SimConfig() = default;
+
+        /*!
+         * Get the simulation abscissa
+         */
+        const unsigned& getSimX() const { return simX; }
+
+        /*!
+         * Get the simulation ordinate
+         */
+        const unsigned& getSimY() const { return simY; }
+
+        /*!
+         * Get the probability (in percent, possibly fractional) of cell "miracle" apparition
+         */
+         const double& getMiracleProb() const { return miracle_prob; }
+
+        /*!
+         * Get the name of the simulation engine
+         */
+        const std::string& getEngine() const { return engine; }
+
+        /*!
+         * Get the number of threads computing a generation (0 for every core)
+         */
+        const unsigned& getThreadCount() const { return threadCount; }
+
+        /*!
+         * Returns true if the tiles that cannot change are skipped (only without miracles)
+         */
+        bool getActiveTiles() const { return activeTiles; }
+
+        /*!
+         * Get the boundary of the grid: "dead" (the cells outside are dead) or "torus" (the opposite edges are neighbours)
+         */
+        const std::string& getBoundary() const { return boundary; }
+
+        /*!
+         * Get the number of generations computed on each block of the grid before the next one (1 for none, see \a BitEngine)
+         */
+        unsigned getTemporalBlocking() const { return temporalBlocking; }
+
+        /*!
+         * Get the memory (in MB) of the HashLife nodes triggering a garbage collection
+         */
+        const unsigned& getHashLifeMemory() const { return hashLifeMemory; }
+
+        /*!
+         * Get the rulestring of the simulation (see \a Rule::parse)
+         */
+        const std::string& getRule() const { return rule; }
+
+        /*!
+         * Get the seed of the random numbers of the simulation
+         */
+        std::uint64_t getSeed() const { return seed; }
+
+        /*!
+         * Get the number of generations computed per second by the simulation thread (0 for as many as possible)
+         */
+        const double& getGenerationRate() const { return generationRate; }
+
+        /*!
+         * Get the checkpoint file the simulation is resumed from (empty to start a new one)
+         */
+        const std::string& getResumeFile() const { return resumeFile; }
+
+        /*!
+         * Get the checkpoint file the state of the simulation is saved to
+         */
+        const std::string& getCheckpointFile() const { return checkpointFile; }
+
+        /*!
+         * Get the pattern file the simulation starts from (empty to start from random cells)
+         */
+        const std::string& getPatternFile() const { return patternFile; }
+
+        /*!
+         * Get the abscissa of the cell (0, 0) of the pattern on the grid
+         */
+        std::int64_t getPatternX() const { return patternX; }
+
+        /*!
+         * Get the ordinate of the cell (0, 0) of the pattern on the grid
+         */
+        std::int64_t getPatternY() const { return patternY; }
+
+        /*!
+         * Get the file every generation is recorded to (empty for none, see \a Recorder)
+         */
+        const std::string& getRecordFile() const { return recordFile; }
+
+        /*!
+         * Get the number of generations between two keyframes of a recording
+         */
+        unsigned getKeyframeInterval() const { return keyframeInterval; }
+
+        /*!
+         * Get the action once the simulation reached a cycle ("off", "detect", "stop" or "skip", see \a CycleDetector)
+         */
+        const std::string& getCycle() const { return cycle; }
+
+        /*!
+         * Get the number of generations whose hash is kept to detect the cycles
+         */
+        unsigned getCycleHistory() const { return cycleHistory; }
+
+        /*!
+         * Returns true if the engines start from random cells, false if they start from
+         * a pattern or a checkpoint (their cells are then dead until these are loaded)
+         */
+        bool isRandomInit() const { return patternFile.empty() && resumeFile.empty(); }
+
+        /*!
+         * Set the simulation abscissa
+         */
+        void setSimX(const unsigned p_x) { simX = p_x; }
+
+        /*!
+         * Set the simulation ordinate
+         */
+        void setSimY(const unsigned p_y) { simY = p_y; }
+
+        /*!
+         * Set the probability (in percent, possibly fractional) of cell "miracle" apparition
+         */
+         void setMiracleProb(const double& p_miracleProb) { miracle_prob = p_miracleProb; }
+
+        /*!
+         * Set the name of the simulation engine (see \a Engine::create)
+         */
+        void setEngine(const std::string& p_engine) { engine = p_engine; }
+
+        /*!
+         * Set the number of threads computing a generation (0 for every core)
+         */
+        void setThreadCount(const unsigned p_threads) { threadCount = p_threads; }
+
+        /*!
+         * Enable or disable the skipping of the tiles that cannot change
+         */
+        void setActiveTiles(const bool p_activeTiles) { activeTiles = p_activeTiles; }
+
+        /*!
+         * Set the boundary of the grid ("dead" or "torus")
+         */
+        void setBoundary(const std::string& p_boundary) { boundary = p_boundary; }
+
+        /*!
+         * Set the number of generations computed on each block of the grid before the next one (1 for none)
+         */
+        void setTemporalBlocking(const unsigned p_generations) { temporalBlocking = p_generations; }
+
+        /*!
+         * Set the memory (in MB) of the HashLife nodes triggering a garbage collection
+         */
+        void setHashLifeMemory(const unsigned p_memory) { hashLifeMemory = p_memory; }
+
+        /*!
+         * Set the rulestring of the simulation (see \a Rule::parse)
+         */
+        void setRule(const std::string& p_rule) { rule = p_rule; }
+
+        /*!
+         * Set the seed of the random numbers of the simulation
+         */
+        void setSeed(const std::uint64_t p_seed) { seed = p_seed; }
+
+        /*!
+         * Set the number of generations computed per second by the simulation thread (0 for as many as possible)
+         */
+        void setGenerationRate(const double& p_rate) { generationRate = p_rate; }
+
+        /*!
+         * Set the checkpoint file the simulation is resumed from
+         */
+        void setResumeFile(const std::string& p_file) { resumeFile = p_file; }
+
+        /*!
+         * Set the checkpoint file the state of the simulation is saved to
+         */
+        void setCheckpointFile(const std::string& p_file) { checkpointFile = p_file; }
+
+        /*!
+         * Set the file every generation is recorded to
+         */
+        void setRecordFile(const std::string& p_file) { recordFile = p_file; }
+
+        /*!
+         * Set the number of generations between two keyframes of a recording
+         */
+        void setKeyframeInterval(const unsigned p_interval) { keyframeInterval = p_interval; }
+
+        /*!
+         * Set the action once the simulation reached a cycle
+         */
+        void setCycle(const std::string& p_cycle) { cycle = p_cycle; }
+
+        /*!
+         * Set the number of generations whose hash is kept to detect the cycles
+         */
+        void setCycleHistory(const unsigned p_history) { cycleHistory = p_history; }
+
+        /*!
+         * Set the pattern file the simulation starts from (see \a Pattern)
+         */
+        void setPatternFile(const std::string& p_file) { patternFile = p_file; }
+
+        /*!
+         * Set the position of the cell (0, 0) of the pattern on the grid
+         */
+        void setPatternOffset(const std::int64_t p_x, const std::int64_t p_y) { patternX = p_x; patternY = p_y; }
+
+        /*!
+         * \function loadConfig
+         * \brief load configuration parameters from the requested file.
+         * \param p_file the configuration file (<em>"config.txt"</em> by default).
+         */
+        void loadConfig(const std::string& p_file = "config.txt");
+
+    protected:
+        /*!
+         * \function parseEntry
+         * \brief Reads the value(s) of a configuration key.
+         * \param p_key the key read on the current line.
+         * \param p_in the stream to read the value(s) from.
+         * \return true if the key is known, false otherwise.
+         */
+        virtual bool parseEntry(const std::string& p_key, std::istream& p_in);
+
+        /*!
+         * \function loadDefaults
+         * \brief Called when the configuration file cannot be opened.
+         */
+        virtual void loadDefaults();
+
+        /*!
+         * \function init
+         * \brief performs the initialization step once every key has been read.
+         */
+        virtual void init() {}
+
+    private:
+        unsigned simX = 640;                            /**< Abscissa of the simulation */
+        unsigned simY = 360;                            /**< Ordinate of the simulation */
+
+        double miracle_prob = 5;                        /**< Probability (%) a cell appears for no apparent reason */
+        std::string engine = "life";                    /**< Name of the simulation engine */
+        unsigned threadCount = 1;                       /**< Number of threads computing a generation */
+        bool activeTiles = true;                        /**< Skip the tiles that cannot change */
+        std::string boundary = "dead";                  /**< Boundary of the grid */
+        unsigned temporalBlocking = 1;                  /**< Generations computed on each block of the grid at once */
+        unsigned hashLifeMemory = 512;                  /**< Memory (MB) of the HashLife nodes */
+        std::string rule = "B3/S23";                    /**< Rulestring of the simulation */
+        std::uint64_t seed = (std::uint64_t)std::time(nullptr); /**< Seed of the random numbers */
+        double generationRate = 0;                      /**< Generations per second (0 for no limit) */
+        std::string resumeFile;                         /**< Checkpoint the simulation is resumed from */
+        std::string checkpointFile = "checkpoint.bin";  /**< Checkpoint the simulation is saved to */
+        std::string recordFile;                         /**< Recording of every generation */
+        unsigned keyframeInterval = 64;                 /**< Generations between two keyframes of a recording */
+        std::string cycle = "off";                      /**< Action once the simulation reached a cycle */
+        unsigned cycleHistory = 1024;                   /**< Generations whose hash is kept to detect the cycles */
+        std::string patternFile;                        /**< Pattern the simulation starts from */
+        std::int64_t patternX = 0;                      /**< Abscissa of the cell (0, 0) of the pattern */
+        std::int64_t patternY = 0;                      /**< Ordinate of the cell (0, 0) of the pattern */
+};
+
+#endif // SIMCONFIG_H
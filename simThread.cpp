@@ -0,0 +1,141 @@
+#include "simThread.h"
+#include <chrono>
+#include <iostream>
+
+/**
+ * \file simThread.cpp
+ * \brief Implementation of the functions defined in \a simThread.h
+ * \author lhm
+ */
+
+SimThread::SimThread(std::unique_ptr<Engine> p_engine, const double p_generationRate, Telemetry* p_telemetry)
+    :   m_engine            (std::move(p_engine))
+    ,   m_generationRate    (p_generationRate)
+    ,   m_pTelemetry        (p_telemetry)
+{
+    m_generation = m_engine->getGeneration();
+    publish();
+}
+
+SimThread::~SimThread()
+{
+    stop();
+}
+
+bool SimThread::record(const std::string& p_file, const SimConfig& p_config, const unsigned p_keyframeInterval)
+{
+    m_recorder = std::make_unique<Recorder>();
+    if (m_recorder->open(p_file, p_config, *m_engine, p_keyframeInterval))
+        return true;
+
+    m_recorder.reset();
+    return false;
+}
+
+void SimThread::detectCycles(const CycleDetector::Action p_action, const unsigned p_history)
+{
+    m_cycleAction = p_action;
+    m_cycleDetector.reset();
+    if (p_action != CycleDetector::OFF)
+    {
+        m_cycleDetector = std::make_unique<CycleDetector>(p_history);
+        m_cycleDetector->reset(*m_engine);
+    }
+}
+
+void SimThread::start()
+{
+    if (m_thread.joinable())
+        return;
+
+    m_running = true;
+    m_thread = std::thread(&SimThread::run, this);
+}
+
+void SimThread::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_wakeUp.notify_all();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+void SimThread::run()
+{
+    typedef std::chrono::steady_clock Clock;
+
+    // The date of each generation is computed from the origin, so that the rounding errors do not accumulate
+    const auto period = m_generationRate > 0 ? std::chrono::duration<double>(1 / m_generationRate)
+                                             : std::chrono::duration<double>(0);
+    auto origin = Clock::now();
+    std::uint64_t count = 0;
+
+    while (m_running.load(std::memory_order_relaxed))
+    {
+        {
+            Telemetry::Timer timer(m_pTelemetry, Telemetry::STEP);
+            m_engine->step();
+        }
+        m_generation.store(m_engine->getGeneration(), std::memory_order_relaxed);
+        if (m_recorder)
+        {
+            m_recorder->record(*m_engine);
+        }
+        if (m_cycleDetector && m_cycleDetector->update(*m_engine))
+        {
+            std::cout << "Cycle of period " << m_cycleDetector->getPeriod() << " from generation "
+                      << m_cycleDetector->getCycleStart() << '\n';
+            m_cycleDetector.reset();
+            if (m_cycleAction != CycleDetector::DETECT)
+            {
+                // The reader gets the last generation even if it did not take the previous one
+                publish();
+                m_running = false;
+                break;
+            }
+        }
+
+        // The reader did not take the previous snapshot yet: it would not draw this one either
+        if (m_snapshots.isConsumed())
+        {
+            Telemetry::Timer timer(m_pTelemetry, Telemetry::PUBLISH);
+            publish();
+        }
+        if (m_pTelemetry)
+        {
+            m_pTelemetry->commit(Telemetry::GENERATION);
+        }
+
+        if (m_generationRate > 0)
+        {
+            ++count;
+            auto date = origin + std::chrono::duration_cast<Clock::duration>(period * (double)count);
+            auto now  = Clock::now();
+            if (now - date > std::chrono::seconds(1))
+            {
+                // Too late to catch up: restart the schedule from now
+                origin = now;
+                count  = 0;
+            }
+            else if (date > now)
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wakeUp.wait_until(lock, date, [this] { return !m_running.load(); });
+            }
+        }
+    }
+}
+
+void SimThread::publish()
+{
+    auto& snapshot = m_snapshots.getWriteBuffer();
+    snapshot.generation = m_engine->getGeneration();
+    snapshot.cells.resize((std::size_t)m_engine->getChangesWordsPerRow() * m_engine->getSimY());
+    m_engine->getCells(snapshot.cells.data());
+    m_snapshots.publish();
+}
@@ -0,0 +1,151 @@
+#ifndef SIMTHREAD_H
+#define SIMTHREAD_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "cycleDetector.h"
+#include "engine.h"
+#include "recorder.h"
+#include "telemetry.h"
+#include "tripleBuffer.h"
+
+/**
+ * \file simThread.h
+ * \brief Definition of the thread advancing an engine independently of the rendering.
+ * \author lhm
+ */
+
+/*!
+ * \class SimThread
+ * \brief Thread owning an \a Engine and computing its generations, as fast as possible
+ * or at the configured generation rate.
+ * The state of the cells is published through a \a TripleBuffer: the reader takes the
+ * latest snapshot without locking, and the simulation never waits for the reader.
+ * A snapshot is only written once the reader took the previous one, so that a fast simulation
+ * does not spend its time copying cells that are never drawn.
+ */
+class SimThread
+{
+    public:
+        /*!
+         * \struct Snapshot
+         * \brief State of the cells after a generation.
+         */
+        struct Snapshot
+        {
+            std::uint64_t generation = 0;               /**< generation of the cells */
+            std::vector<std::uint64_t> cells;           /**< alive cells, laid out as \a Engine::getChanges */
+        };
+
+        /*!
+         * \function SimThread
+         * \brief Takes the engine and publishes its current state. The thread is started by \a start.
+         * \param p_engine the engine to advance
+         * \param p_generationRate the number of generations per second (0 for as many as possible)
+         * \param p_telemetry the telemetry timing each generation (nullptr for none)
+         */
+        SimThread(std::unique_ptr<Engine> p_engine, const double p_generationRate, Telemetry* p_telemetry = nullptr);
+
+        /*!
+         * Stops the thread.
+         */
+        ~SimThread();
+
+        /*!
+         * Copy constructor is prohibited.
+         */
+        SimThread              (const SimThread& other)   = delete;
+
+        /*!
+         * Assignment constructor is prohibited.
+         */
+        SimThread& operator=   (const SimThread& other)   = delete;
+
+        /*!
+         * \function record
+         * \brief Records every generation computed from now on (see \a Recorder). To be called before \a start.
+         * \param p_file the recording file
+         * \param p_config the configuration of the engine
+         * \param p_keyframeInterval the number of generations between two keyframes
+         * \return true if the recording file was created.
+         */
+        bool record(const std::string& p_file, const SimConfig& p_config, const unsigned p_keyframeInterval);
+
+        /*!
+         * \function detectCycles
+         * \brief Detects that the grid reached a cycle (see \a CycleDetector). To be called before \a start.
+         * The thread stops computing once a cycle is found with the \a STOP or \a SKIP action
+         * (there is no generation to reach to skip periods to): the last generation stays displayed.
+         * \param p_action the action once a cycle is found
+         * \param p_history the number of generations whose hash is kept
+         */
+        void detectCycles(const CycleDetector::Action p_action, const unsigned p_history);
+
+        /*!
+         * \function start
+         * \brief Starts computing the generations (does nothing if already started).
+         */
+        void start();
+
+        /*!
+         * \function stop
+         * \brief Stops computing the generations, once the current one is done.
+         */
+        void stop();
+
+        /*!
+         * \function updateSnapshot
+         * \brief Takes the latest published snapshot (reader thread only).
+         * \return true if a newer snapshot was taken.
+         */
+        bool updateSnapshot() { return m_snapshots.update(); }
+
+        /*!
+         * Get the latest snapshot taken by \a updateSnapshot (reader thread only)
+         */
+        const Snapshot& getSnapshot() const { return m_snapshots.getReadBuffer(); }
+
+        /*!
+         * Get the number of generations computed so far
+         */
+        std::uint64_t getGeneration() const { return m_generation.load(std::memory_order_relaxed); }
+
+        /*!
+         * Get the number of words of a row of the snapshots
+         */
+        unsigned getWordsPerRow() const { return m_engine->getChangesWordsPerRow(); }
+
+    protected:
+        /*!
+         * \function run
+         * \brief Loop of the thread: computes the generations until \a stop is called.
+         */
+        void run();
+
+        /*!
+         * \function publish
+         * \brief Copies the state of the engine into the write buffer and publishes it.
+         */
+        void publish();
+
+    private:
+        std::unique_ptr<Engine> m_engine;               /**< engine advanced by the thread */
+        const double m_generationRate;                  /**< generations per second (0 for no limit) */
+        Telemetry* const m_pTelemetry;                  /**< telemetry of the generations (nullptr if disabled) */
+        std::unique_ptr<Recorder> m_recorder;           /**< recording of the generations (nullptr if none) */
+        CycleDetector::Action m_cycleAction = CycleDetector::OFF;   /**< action once a cycle is found */
+        std::unique_ptr<CycleDetector> m_cycleDetector; /**< detection of the cycles (nullptr if none) */
+        TripleBuffer<Snapshot> m_snapshots;             /**< snapshots handed to the reader */
+        std::atomic<bool> m_running { false };          /**< false to stop the thread */
+        std::atomic<std::uint64_t> m_generation { 0 };  /**< generations computed so far */
+        std::mutex m_mutex;                             /**< protects the wake up of a paced thread */
+        std::condition_variable m_wakeUp;               /**< wakes up a paced thread when stopped */
+        std::thread m_thread;                           /**< thread computing the generations */
+};
+
+#endif // SIMTHREAD_H
@@ -0,0 +1,331 @@
+#include "sparseEngine.h"
+#include "simConfig.h"
+#include "bitKernel.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+/**
+ * \file sparseEngine.cpp
+ * \brief Implementation of the functions defined in \a sparseEngine.h
+ * \author lhm
+ */
+
+namespace
+{
+    // Offsets of the neighbours of a chunk, the opposite of the neighbour i being 7 - i
+    const int NEIGHBOUR_DX[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+    const int NEIGHBOUR_DY[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+
+    enum Neighbour { NW, N, NE, W, E, SW, S, SE };
+
+    const int CHUNK_SHIFT = 6;
+    const std::uint64_t WEST_BIT = 1ULL;
+    const std::uint64_t EAST_BIT = 1ULL << 63;
+
+    // Freed chunks kept for the next allocations, the others are given back to the system
+    const std::size_t MAX_FREE_CHUNKS = 1024;
+}
+
+SparseEngine::SparseEngine(const SimConfig& p_config)
+    :   Engine  (p_config)
+{
+    static_assert(CHUNK_SIZE == 1 << CHUNK_SHIFT, "A chunk is one word wide");
+
+    if (p_config.getMiracleProb() > 0)
+    {
+        std::cout << "The sparse engine only supports deterministic rules: the miracles are ignored\n";
+    }
+}
+
+void SparseEngine::step(unsigned p_generations)
+{
+    if (m_trackChanges)
+    {
+        std::fill(m_changes.begin(), m_changes.end(), 0);
+    }
+
+    for (unsigned i = 0; i < p_generations; ++i)
+    {
+        update();
+        ++m_generation;
+    }
+}
+
+void SparseEngine::update()
+{
+    // Only the chunks that changed may have new alive cells on their border
+    const std::size_t count = m_chunks.size();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (m_chunks[i]->changed)
+        {
+            allocateNeighbours(*m_chunks[i]);
+        }
+    }
+
+    // A chunk whose neighbourhood did not change since the last generation holds the same
+    // state in both buffers: it is skipped
+    m_active.clear();
+    for (auto& chunk : m_chunks)
+    {
+        bool active = chunk->changed || !useActiveTiles();
+        for (unsigned n = 0; n < 8 && !active; ++n)
+        {
+            active = chunk->neighbours[n] && chunk->neighbours[n]->changed;
+        }
+        if (active)
+        {
+            m_active.push_back(chunk.get());
+        }
+    }
+
+    forEachBand((unsigned)m_active.size(), [this](unsigned p_begin, unsigned p_end)
+    {
+        for (unsigned i = p_begin; i < p_end; ++i)
+        {
+            updateChunk(*m_active[i]);
+        }
+    });
+    m_current ^= 1;
+
+    // Chunks are freed after two empty generations: both of their buffers are then dead
+    for (std::size_t i = 0; i < m_chunks.size(); )
+    {
+        Chunk& chunk = *m_chunks[i];
+        chunk.changed = chunk.nextChanged;
+        chunk.nextChanged = false;
+        chunk.emptyGenerations = chunk.alive ? 0 : chunk.emptyGenerations + 1;
+        if (chunk.emptyGenerations >= 2)
+        {
+            freeChunk(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+void SparseEngine::allocateNeighbours(Chunk& p_chunk)
+{
+    const std::uint64_t* rows = p_chunk.rows[m_current];
+    const std::uint64_t north = rows[0];
+    const std::uint64_t south = rows[CHUNK_SIZE - 1];
+    std::uint64_t west = 0, east = 0;
+    for (int y = 0; y < CHUNK_SIZE; ++y)
+    {
+        west |= rows[y] & WEST_BIT;
+        east |= rows[y] & EAST_BIT;
+    }
+
+    const bool needed[8] =
+    {
+        (north & WEST_BIT) != 0, north != 0, (north & EAST_BIT) != 0,
+        west != 0,                           east != 0,
+        (south & WEST_BIT) != 0, south != 0, (south & EAST_BIT) != 0
+    };
+    for (unsigned n = 0; n < 8; ++n)
+    {
+        if (needed[n] && !p_chunk.neighbours[n])
+        {
+            getChunk(p_chunk.cx + NEIGHBOUR_DX[n], p_chunk.cy + NEIGHBOUR_DY[n]);
+        }
+    }
+}
+
+void SparseEngine::updateChunk(Chunk& p_chunk)
+{
+    const unsigned current = m_current;
+    auto rowOf = [current](const Chunk* p_other, int p_y) -> std::uint64_t
+    {
+        return p_other ? p_other->rows[current][p_y] : 0;
+    };
+
+    // Columns west, centre and east of the chunk, from the row above to the row below
+    std::uint64_t west[CHUNK_SIZE + 2], centre[CHUNK_SIZE + 2], east[CHUNK_SIZE + 2];
+    Chunk* const* neighbours = p_chunk.neighbours;
+    west  [0] = rowOf(neighbours[NW], CHUNK_SIZE - 1);
+    centre[0] = rowOf(neighbours[N],  CHUNK_SIZE - 1);
+    east  [0] = rowOf(neighbours[NE], CHUNK_SIZE - 1);
+    for (int y = 0; y < CHUNK_SIZE; ++y)
+    {
+        west  [y + 1] = rowOf(neighbours[W], y);
+        centre[y + 1] = p_chunk.rows[current][y];
+        east  [y + 1] = rowOf(neighbours[E], y);
+    }
+    west  [CHUNK_SIZE + 1] = rowOf(neighbours[SW], 0);
+    centre[CHUNK_SIZE + 1] = rowOf(neighbours[S],  0);
+    east  [CHUNK_SIZE + 1] = rowOf(neighbours[SE], 0);
+
+    std::uint64_t* next = p_chunk.rows[current ^ 1];
+    std::uint64_t changed = 0, alive = 0;
+    for (int y = 0; y < CHUNK_SIZE; ++y)
+    {
+        next[y] = lifeWord(west[y],     centre[y],     east[y],
+                           west[y + 1], centre[y + 1], east[y + 1],
+                           west[y + 2], centre[y + 2], east[y + 2]);
+        changed |= next[y] ^ centre[y + 1];
+        alive   |= next[y];
+    }
+    p_chunk.nextChanged = changed != 0;
+    p_chunk.alive = alive != 0;
+
+    if (changed && m_trackChanges)
+    {
+        markChunkChanges(p_chunk);
+    }
+}
+
+void SparseEngine::markChunkChanges(const Chunk& p_chunk)
+{
+    // A chunk covers one word of the rows of the window it intersects
+    const std::int64_t x0 = (std::int64_t)p_chunk.cx * CHUNK_SIZE;
+    const std::int64_t y0 = (std::int64_t)p_chunk.cy * CHUNK_SIZE;
+    if (x0 < 0 || y0 < 0 || x0 >= m_simX || y0 >= m_simY)
+        return;
+
+    const std::uint64_t mask = m_simX - x0 < CHUNK_SIZE ? (1ULL << (m_simX - x0)) - 1 : ~0ULL;
+    const unsigned wordsPerRow = getChangesWordsPerRow();
+    const int yEnd = (int)std::min<std::int64_t>(CHUNK_SIZE, m_simY - y0);
+    for (int y = 0; y < yEnd; ++y)
+    {
+        m_changes[(std::size_t)(y0 + y) * wordsPerRow + p_chunk.cx] |=
+            (p_chunk.rows[0][y] ^ p_chunk.rows[1][y]) & mask;
+    }
+}
+
+SparseEngine::Chunk* SparseEngine::findChunk(std::int32_t p_cx, std::int32_t p_cy) const
+{
+    auto it = m_map.find(getKey(p_cx, p_cy));
+    return it != m_map.end() ? it->second : nullptr;
+}
+
+SparseEngine::Chunk* SparseEngine::getChunk(std::int32_t p_cx, std::int32_t p_cy)
+{
+    Chunk*& slot = m_map[getKey(p_cx, p_cy)];
+    if (slot)
+        return slot;
+
+    std::unique_ptr<Chunk> chunk;
+    if (m_free.empty())
+    {
+        chunk = std::make_unique<Chunk>();
+    }
+    else
+    {
+        chunk = std::move(m_free.back());
+        m_free.pop_back();
+    }
+    std::memset(chunk->rows, 0, sizeof(chunk->rows));
+    chunk->cx = p_cx;
+    chunk->cy = p_cy;
+    chunk->changed = false;
+    chunk->nextChanged = false;
+    chunk->alive = false;
+    chunk->emptyGenerations = 0;
+
+    for (unsigned n = 0; n < 8; ++n)
+    {
+        Chunk* neighbour = findChunk(p_cx + NEIGHBOUR_DX[n], p_cy + NEIGHBOUR_DY[n]);
+        chunk->neighbours[n] = neighbour;
+        if (neighbour)
+        {
+            neighbour->neighbours[7 - n] = chunk.get();
+        }
+    }
+
+    slot = chunk.get();
+    m_chunks.push_back(std::move(chunk));
+    return slot;
+}
+
+void SparseEngine::freeChunk(const std::size_t p_index)
+{
+    Chunk* chunk = m_chunks[p_index].get();
+    for (unsigned n = 0; n < 8; ++n)
+    {
+        if (chunk->neighbours[n])
+        {
+            chunk->neighbours[n]->neighbours[7 - n] = nullptr;
+        }
+    }
+    m_map.erase(getKey(chunk->cx, chunk->cy));
+
+    if (m_free.size() < MAX_FREE_CHUNKS)
+    {
+        m_free.push_back(std::move(m_chunks[p_index]));
+    }
+    m_chunks[p_index] = std::move(m_chunks.back());
+    m_chunks.pop_back();
+}
+
+Cell SparseEngine::getCell(const unsigned p_x, const unsigned p_y) const
+{
+    const Chunk* chunk = findChunk((std::int32_t)(p_x >> CHUNK_SHIFT), (std::int32_t)(p_y >> CHUNK_SHIFT));
+    if (!chunk)
+        return Cell::OFF;
+    return (chunk->rows[m_current][p_y % CHUNK_SIZE] >> (p_x % CHUNK_SIZE)) & 1 ? Cell::ON : Cell::OFF;
+}
+
+void SparseEngine::setCell(const unsigned p_x, const unsigned p_y, const Cell p_cell)
+{
+    Chunk* chunk = p_cell == Cell::ON
+                 ? getChunk((std::int32_t)(p_x >> CHUNK_SHIFT), (std::int32_t)(p_y >> CHUNK_SHIFT))
+                 : findChunk((std::int32_t)(p_x >> CHUNK_SHIFT), (std::int32_t)(p_y >> CHUNK_SHIFT));
+    if (!chunk)
+        return;
+
+    auto& word = chunk->rows[m_current][p_y % CHUNK_SIZE];
+    auto  bit  = 1ULL << (p_x % CHUNK_SIZE);
+    word = p_cell == Cell::ON ? word | bit : word & ~bit;
+
+    // Both buffers now differ: the chunk and its neighbours are computed at the next generation
+    chunk->changed = true;
+    if (p_cell == Cell::ON)
+    {
+        chunk->alive = true;
+        chunk->emptyGenerations = 0;
+    }
+}
+
+void SparseEngine::setCells(const std::uint64_t* p_bitmap)
+{
+    // A word of the bitmap is a row of a chunk: only the bits inside the window are replaced
+    const unsigned wordsPerRow = getChangesWordsPerRow();
+    for (unsigned y = 0; y < m_simY; ++y)
+    {
+        for (unsigned w = 0; w < wordsPerRow; ++w)
+        {
+            const std::uint64_t word = p_bitmap[(std::size_t)y * wordsPerRow + w];
+            Chunk* chunk = word ? getChunk((std::int32_t)w, (std::int32_t)(y >> CHUNK_SHIFT))
+                                : findChunk((std::int32_t)w, (std::int32_t)(y >> CHUNK_SHIFT));
+            if (!chunk)
+                continue;
+
+            const unsigned bits = std::min(m_simX - w * CHUNK_SIZE, (unsigned)CHUNK_SIZE);
+            const std::uint64_t mask = bits < (unsigned)CHUNK_SIZE ? (1ULL << bits) - 1 : ~0ULL;
+            auto& row = chunk->rows[m_current][y % CHUNK_SIZE];
+            row = (row & ~mask) | (word & mask);
+            chunk->changed = true;
+            if (word)
+            {
+                chunk->alive = true;
+                chunk->emptyGenerations = 0;
+            }
+        }
+    }
+}
+
+std::uint64_t SparseEngine::getUniversePopulation() const
+{
+    std::uint64_t population = 0;
+    for (auto& chunk : m_chunks)
+    {
+        for (int y = 0; y < CHUNK_SIZE; ++y)
+        {
+            population += (std::uint64_t)__builtin_popcountll(chunk->rows[m_current][y]);
+        }
+    }
+    return population;
+}
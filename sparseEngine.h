@@ -0,0 +1,146 @@
+#ifndef SPARSEENGINE_H
+#define SPARSEENGINE_H
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "engine.h"
+
+/**
+ * \file sparseEngine.h
+ * \brief Definition of a "Game of life" engine for an unbounded universe.
+ * \author lhm
+ */
+
+/*!
+ * \class SparseEngine
+ * \brief Engine only storing the occupied chunks of an unbounded universe.
+ * The universe is split into chunks of 64 x 64 cells, stored one bit per cell like \a BitEngine
+ * and kept in a hash map indexed by the coordinates of the chunk. A chunk is allocated when
+ * a cell of its neighbours reaches the border, and freed after two empty generations, so
+ * the memory follows the population instead of the bounding box of the pattern.
+ * <ul>
+ * <li> The simulation window is the region [0, simX) x [0, simY) of the universe,
+ *      the cells leaving it keep evolving.
+ * <li> A chunk is only computed if it, or one of its neighbours, changed during the last
+ *      generation (see \a useActiveTiles).
+ * <li> Only the deterministic rules are supported: the miracles are ignored.
+ * </ul>
+ */
+class SparseEngine : public Engine
+{
+    public:
+        static const int CHUNK_SIZE = 64;               /**< size of a chunk (one word per row) */
+
+        /*!
+         * \function SparseEngine
+         * \brief Creates the engine, with dead cells (see \a Engine::create).
+         * \param p_config The configuration of the simulation.
+         */
+        explicit SparseEngine(const SimConfig& p_config);
+
+        /*!
+         * \function step
+         * \brief Advances the universe by the requested number of generations.
+         * The activity is tracked per chunk: the tiles of the window are not used.
+         * \param p_generations the number of generations to compute.
+         */
+        void step(unsigned p_generations = 1) override;
+
+        Cell getCell(const unsigned p_x, const unsigned p_y) const override;
+
+        void setCell(const unsigned p_x, const unsigned p_y, const Cell p_cell) override;
+
+        void setCells(const std::uint64_t* p_bitmap) override;
+
+        /*!
+         * \function getUniversePopulation
+         * \brief Returns the number of alive cells of the whole universe.
+         */
+        std::uint64_t getUniversePopulation() const;
+
+        /*!
+         * Get the number of chunks currently allocated
+         */
+        std::size_t getChunkCount() const { return m_chunks.size(); }
+
+    protected:
+        /*!
+         * \function update
+         * \brief Allocates the chunks reached by the pattern, computes the active chunks,
+         * then frees the chunks that stayed empty.
+         */
+        void update() override;
+
+    private:
+        /*!
+         * \struct Chunk
+         * \brief Square of 64 x 64 cells, double buffered.
+         * The cell (x, y) of the chunk is the bit \a x of the word \a y (1 meaning alive).
+         */
+        struct Chunk
+        {
+            std::int32_t cx, cy;                        /**< coordinates of the chunk (in chunks) */
+            std::uint64_t rows[2][CHUNK_SIZE];          /**< both generations, see \a m_current */
+            Chunk* neighbours[8];                       /**< NW, N, NE, W, E, SW, S, SE (or nullptr) */
+            bool changed;                               /**< a cell changed during the last generation */
+            bool nextChanged;                           /**< a cell changes during the generation being computed */
+            bool alive;                                 /**< at least one cell is alive */
+            unsigned emptyGenerations;                  /**< number of generations the chunk stayed empty */
+        };
+
+        /*!
+         * \function getKey
+         * \brief Returns the key of a chunk in \a m_map.
+         */
+        static std::uint64_t getKey(std::int32_t p_cx, std::int32_t p_cy)
+        {
+            return ((std::uint64_t)(std::uint32_t)p_cx << 32) | (std::uint32_t)p_cy;
+        }
+
+        /*!
+         * \function findChunk
+         * \brief Returns the chunk of the requested coordinates, or nullptr if it is not allocated.
+         */
+        Chunk* findChunk(std::int32_t p_cx, std::int32_t p_cy) const;
+
+        /*!
+         * \function getChunk
+         * \brief Returns the chunk of the requested coordinates, allocating a dead one if needed.
+         */
+        Chunk* getChunk(std::int32_t p_cx, std::int32_t p_cy);
+
+        /*!
+         * \function freeChunk
+         * \brief Unlinks the chunk from its neighbours and gives it back to \a m_free.
+         * \param p_index the index of the chunk in \a m_chunks
+         */
+        void freeChunk(const std::size_t p_index);
+
+        /*!
+         * \function allocateNeighbours
+         * \brief Allocates the missing neighbours of a chunk whose border holds alive cells.
+         */
+        void allocateNeighbours(Chunk& p_chunk);
+
+        /*!
+         * \function updateChunk
+         * \brief Computes the next generation of a chunk.
+         */
+        void updateChunk(Chunk& p_chunk);
+
+        /*!
+         * \function markChunkChanges
+         * \brief Marks in the changes bitmap the cells of the window changed in a chunk.
+         */
+        void markChunkChanges(const Chunk& p_chunk);
+
+        std::unordered_map<std::uint64_t, Chunk*> m_map;    /**< allocated chunks, indexed by coordinates */
+        std::vector<std::unique_ptr<Chunk>> m_chunks;       /**< allocated chunks */
+        std::vector<std::unique_ptr<Chunk>> m_free;         /**< freed chunks, reused by the next allocations */
+        std::vector<Chunk*> m_active;                       /**< chunks computed by the current generation */
+        unsigned m_current = 0;                             /**< buffer of the current generation in the chunks */
+};
+
+#endif // SPARSEENGINE_H
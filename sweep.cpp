@@ -0,0 +1,408 @@
+#include "simConfig.h"
+#include "engine.h"
+#include "cycleDetector.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/*!
+ * \file sweep.cpp
+ * \brief main file of the parameter sweep runner.
+ * Runs many variants of a configuration (size of the grid, miracle probability, rule, seed, engine),
+ * each in its own process, \a jobs processes at a time, without any window.
+ * The variants are every combination of the values given on the command line, applied to each line
+ * of the variants file (or to the base configuration without variants file). A line of the variants
+ * file holds keys of the configuration file followed by their values, for instance
+ * <em> simx 512 simy 256 miracleProb 0.5 rule B36/S23 seed 7 </em>.
+ * Each run streams the statistics of every generation (population, births, deaths, density) to
+ * <em> prefix-index.csv </em>, and the settings and status of every run are written to <em> prefix.csv </em>.
+ * Without miracles, a run can detect that its grid reached a cycle (-C detect, see \a CycleDetector):
+ * the cycle is written to its file, and the run then stops (-C stop) or skips the whole periods left (-C skip).
+ * Usage: <em> sweep [-c config file] [-f variants file] [-g sizes] [-m miracle probabilities] [-r rules] [-s seeds]
+ * [-e engines] [-n generations] [-t threads] [-j jobs] [-C cycle action] [-o prefix] </em>
+ * where the lists are separated by commas, a size is \a N or \a WxH and seeds can be ranges,
+ * for instance <em> sweep -g 256,512x128 -m 0,0.1 -s 1-1000 -j 8 </em>.
+ * Linux only: the simulations are run by \a fork.
+ * \author lhm
+ */
+
+#ifdef _WIN32
+
+int main()
+{
+    std::cout << "The sweep runs each simulation in its own process: it runs on Linux only\n";
+    return 1;
+}
+
+#else
+
+namespace
+{
+    /*!
+     * Configuration of a run, read from a line of the variants file
+     */
+    class SweepConfig : public SimConfig
+    {
+        public:
+            /*!
+             * Reads the keys of a line and their values, returns false if a key is unknown
+             */
+            bool parseLine(const std::string& p_line)
+            {
+                std::istringstream in(p_line);
+                std::string key;
+                while (in >> key)
+                {
+                    if (!parseEntry(key, in) || in.fail())
+                    {
+                        std::cout << "Invalid variant \"" << key << "\" in: " << p_line << '\n';
+                        return false;
+                    }
+                }
+                return true;
+            }
+    };
+
+    /*!
+     * Statistics of a generation
+     */
+    struct Statistics
+    {
+        std::uint64_t population = 0;
+        std::uint64_t births = 0;
+        std::uint64_t deaths = 0;
+    };
+
+    void usage(const char* p_name)
+    {
+        std::cout << "Usage: " << p_name << " [-c config file] [-f variants file] [-g sizes] [-m miracle probabilities] [-r rules]"
+                     " [-s seeds] [-e engines] [-n generations] [-t threads] [-j jobs] [-C off|detect|stop|skip] [-o prefix]\n"
+                     "Lists are separated by commas, a size is N or WxH, seeds can be ranges (1-1000)\n";
+    }
+
+    std::vector<std::string> split(const std::string& p_list)
+    {
+        std::vector<std::string> items;
+        std::istringstream in(p_list);
+        std::string item;
+        while (std::getline(in, item, ','))
+        {
+            if (!item.empty())
+                items.push_back(item);
+        }
+        return items;
+    }
+
+    std::vector<double> splitReals(const std::string& p_list)
+    {
+        std::vector<double> reals;
+        for (auto& item : split(p_list))
+        {
+            reals.push_back(std::strtod(item.c_str(), nullptr));
+        }
+        return reals;
+    }
+
+    std::vector<std::uint64_t> splitSeeds(const std::string& p_list)
+    {
+        std::vector<std::uint64_t> seeds;
+        for (auto& item : split(p_list))
+        {
+            char* end = nullptr;
+            std::uint64_t first = std::strtoull(item.c_str(), &end, 10);
+            std::uint64_t last  = *end == '-' ? std::strtoull(end + 1, nullptr, 10) : first;
+            for (std::uint64_t seed = first; seed <= last; ++seed)
+            {
+                seeds.push_back(seed);
+            }
+        }
+        return seeds;
+    }
+
+    std::vector<std::pair<unsigned, unsigned>> splitSizes(const std::string& p_list)
+    {
+        std::vector<std::pair<unsigned, unsigned>> sizes;
+        for (auto& item : split(p_list))
+        {
+            char* end = nullptr;
+            const unsigned x = (unsigned)std::strtoul(item.c_str(), &end, 10);
+            const unsigned y = *end == 'x' ? (unsigned)std::strtoul(end + 1, nullptr, 10) : x;
+            sizes.emplace_back(x, y);
+        }
+        return sizes;
+    }
+
+    /*!
+     * Replaces each variant by one variant per value (does nothing without values)
+     */
+    template<typename T, typename Setter>
+    void expand(std::vector<SweepConfig>& p_variants, const std::vector<T>& p_values, Setter p_set)
+    {
+        if (p_values.empty())
+            return;
+
+        std::vector<SweepConfig> variants;
+        variants.reserve(p_variants.size() * p_values.size());
+        for (auto& variant : p_variants)
+        {
+            for (auto& value : p_values)
+            {
+                variants.push_back(variant);
+                p_set(variants.back(), value);
+            }
+        }
+        p_variants.swap(variants);
+    }
+
+    /*!
+     * Writes the settings of a run as CSV fields
+     */
+    void writeVariant(std::ostream& p_out, const SimConfig& p_conf)
+    {
+        p_out << p_conf.getSimX() << ',' << p_conf.getSimY() << ',' << p_conf.getMiracleProb() << ','
+              << p_conf.getRule() << ',' << p_conf.getSeed() << ',' << p_conf.getEngine();
+    }
+
+    /*!
+     * Counts the alive cells, and the births and deaths among the changed cells
+     */
+    Statistics getStatistics(const std::vector<std::uint64_t>& p_cells, const std::vector<std::uint64_t>& p_changes)
+    {
+        Statistics statistics;
+        for (std::size_t i = 0; i < p_cells.size(); ++i)
+        {
+            // Only the cells turning alive or dead are changes (see Engine::getChanges)
+            statistics.population   += (std::uint64_t)__builtin_popcountll(p_cells[i]);
+            statistics.births       += (std::uint64_t)__builtin_popcountll(p_changes[i] & p_cells[i]);
+            statistics.deaths       += (std::uint64_t)__builtin_popcountll(p_changes[i] & ~p_cells[i]);
+        }
+        return statistics;
+    }
+
+    /*!
+     * Runs a variant, and streams the statistics of its generations to a file
+     */
+    bool runVariant(const SimConfig& p_conf, const unsigned p_generations, const std::string& p_file)
+    {
+        std::ofstream out(p_file);
+        if (!out.is_open())
+        {
+            std::cout << "Unable to open " << p_file << '\n';
+            return false;
+        }
+        auto engine = Engine::create(p_conf);
+        if (!engine)
+            return false;
+
+        out << "# simX,simY,miracleProb,rule,seed,engine: ";
+        writeVariant(out, p_conf);
+        out << "\ngeneration,population,births,deaths,density\n";
+
+        std::vector<std::uint64_t> cells((std::size_t)engine->getChangesWordsPerRow() * engine->getSimY());
+        const std::vector<std::uint64_t> none(cells.size(), 0);
+        const double area = (double)engine->getSimX() * engine->getSimY();
+        const std::uint64_t last = engine->getGeneration() + p_generations;
+        engine->setTrackChanges(true);
+
+        CycleDetector::Action cycle = CycleDetector::getAction(p_conf);
+        CycleDetector detector(p_conf.getCycleHistory());
+        if (cycle != CycleDetector::OFF)
+            detector.reset(*engine);
+
+        for (bool first = true; ; first = false)
+        {
+            engine->getCells(cells.data());
+            const Statistics statistics = getStatistics(cells, first ? none : engine->getChanges());
+            out << engine->getGeneration() << ',' << statistics.population << ',' << statistics.births << ','
+                << statistics.deaths << ',' << (area > 0 ? statistics.population / area : 0) << '\n';
+            if (engine->getGeneration() >= last)
+                break;
+            engine->step();
+
+            if (cycle != CycleDetector::OFF && detector.update(*engine))
+            {
+                out << "# cycle: period " << detector.getPeriod() << " from generation " << detector.getCycleStart() << '\n';
+                if (cycle == CycleDetector::STOP)
+                    break;
+
+                // The statistics of the skipped periods repeat the ones of the last period
+                if (cycle == CycleDetector::SKIP)
+                {
+                    const std::uint64_t period = detector.getPeriod();
+                    engine->setGeneration(engine->getGeneration() + (last - engine->getGeneration()) / period * period);
+                }
+                cycle = CycleDetector::OFF;
+            }
+        }
+        out.flush();
+        return (bool)out;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const char* configFile  = nullptr;
+    const char* variantFile = nullptr;
+    std::vector<std::pair<unsigned, unsigned>> sizes;
+    std::vector<double> miracleProbs;
+    std::vector<std::string> rules;
+    std::vector<std::uint64_t> seeds;
+    std::vector<std::string> engines;
+    unsigned generations = 1000;
+    unsigned threads = 1;
+    unsigned jobs = std::thread::hardware_concurrency();
+    const char* cycle = nullptr;
+    std::string prefix = "sweep";
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (i + 1 < argc && !std::strcmp(argv[i], "-c"))
+            configFile = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-f"))
+            variantFile = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-g"))
+            sizes = splitSizes(argv[++i]);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-m"))
+            miracleProbs = splitReals(argv[++i]);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-r"))
+            rules = split(argv[++i]);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-s"))
+            seeds = splitSeeds(argv[++i]);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-e"))
+            engines = split(argv[++i]);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-n"))
+            generations = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-t"))
+            threads = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-j"))
+            jobs = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-C"))
+            cycle = argv[++i];
+        else if (i + 1 < argc && !std::strcmp(argv[i], "-o"))
+            prefix = argv[++i];
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // The runs share the cores: each one computes its generations on a single thread by default
+    SweepConfig base;
+    if (configFile)
+        base.loadConfig(configFile);
+    base.setThreadCount(threads);
+    if (cycle)
+        base.setCycle(cycle);
+
+    std::vector<SweepConfig> variants;
+    if (variantFile)
+    {
+        std::ifstream in(variantFile);
+        if (!in.is_open())
+        {
+            std::cout << "Unable to open " << variantFile << '\n';
+            return 1;
+        }
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+            variants.push_back(base);
+            if (!variants.back().parseLine(line))
+                return 1;
+        }
+    }
+    else
+    {
+        variants.push_back(base);
+    }
+    expand(variants, sizes,        [](SimConfig& p_conf, const std::pair<unsigned, unsigned>& p_size) { p_conf.setSimX(p_size.first); p_conf.setSimY(p_size.second); });
+    expand(variants, miracleProbs, [](SimConfig& p_conf, const double p_prob) { p_conf.setMiracleProb(p_prob); });
+    expand(variants, rules,        [](SimConfig& p_conf, const std::string& p_rule) { p_conf.setRule(p_rule); });
+    expand(variants, seeds,        [](SimConfig& p_conf, const std::uint64_t p_seed) { p_conf.setSeed(p_seed); });
+    expand(variants, engines,      [](SimConfig& p_conf, const std::string& p_engine) { p_conf.setEngine(p_engine); });
+
+    std::ofstream summary(prefix + ".csv");
+    if (!summary.is_open())
+    {
+        std::cout << "Unable to open " << prefix << ".csv\n";
+        return 1;
+    }
+    summary << "run,simX,simY,miracleProb,rule,seed,engine,generations,status,seconds,file\n";
+
+    // Runs the variants in child processes, starting a new one each time one ends
+    typedef std::chrono::steady_clock Clock;
+    std::map<pid_t, std::pair<std::size_t, Clock::time_point>> running;
+    std::size_t next = 0, failed = 0;
+    jobs = jobs ? jobs : 1;
+    while (next < variants.size() || !running.empty())
+    {
+        while (next < variants.size() && running.size() < jobs)
+        {
+            const std::string file = prefix + '-' + std::to_string(next) + ".csv";
+            std::cout.flush();
+            pid_t pid = fork();
+            if (pid == 0)
+            {
+                const bool done = runVariant(variants[next], generations, file);
+                std::cout.flush();
+                _exit(done ? 0 : 1);
+            }
+            if (pid < 0)
+            {
+                std::cout << "Unable to start run " << next << '\n';
+                break;
+            }
+            running[pid] = std::make_pair(next++, Clock::now());
+        }
+        if (running.empty())
+            return 1;
+
+        int status = 0;
+        const pid_t pid = waitpid(-1, &status, 0);
+        auto run = running.find(pid);
+        if (run == running.end())
+            continue;
+
+        const std::size_t index = run->second.first;
+        std::chrono::duration<double> elapsed = Clock::now() - run->second.second;
+        running.erase(run);
+
+        const bool done = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        failed += done ? 0 : 1;
+        summary << index << ',';
+        writeVariant(summary, variants[index]);
+        summary << ',' << generations << ',';
+        if (done)
+            summary << "done";
+        else if (WIFSIGNALED(status))
+            summary << "signal " << WTERMSIG(status);
+        else
+            summary << "failed";
+        summary << ',' << elapsed.count() << ',' << prefix << '-' << index << ".csv\n";
+        summary.flush();
+        std::cerr << "Run " << index << " " << (done ? "done" : "failed") << " ("
+                  << variants.size() - next + running.size() << " left)\n";
+    }
+
+    std::cout << "Runs:           " << variants.size() << " (" << failed << " failed)\n";
+    std::cout << "Summary:        " << prefix << ".csv\n";
+    return failed ? 1 : 0;
+}
+
+#endif // _WIN32
@@ -0,0 +1,109 @@
+#include "telemetry.h"
+#include <algorithm>
+
+/**
+ * \file telemetry.cpp
+ * \brief Implementation of the functions defined in \a telemetry.h
+ * \author lhm
+ */
+
+const char* Telemetry::getPhaseName(const Phase p_phase)
+{
+    static const char* const names[PHASE_COUNT] = { "input", "update", "colours", "draw", "events", "step", "publish" };
+    return names[p_phase];
+}
+
+void Telemetry::add(const Phase p_phase, const std::chrono::steady_clock::duration p_duration)
+{
+    m_rings[getChannel(p_phase)].nanos[p_phase] += (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(p_duration).count();
+}
+
+void Telemetry::commit(const Channel p_channel)
+{
+    Ring& ring = m_rings[p_channel];
+    const std::uint64_t index = ring.written.load(std::memory_order_relaxed);
+
+    Slot& slot = ring.slots[index % CAPACITY];
+    slot.index.store(index, std::memory_order_relaxed);
+    for (unsigned phase = 0; phase < PHASE_COUNT; ++phase)
+    {
+        slot.nanos[phase].store((std::uint32_t)std::min<std::uint64_t>(ring.nanos[phase], UINT32_MAX), std::memory_order_relaxed);
+        ring.nanos[phase] = 0;
+    }
+    ring.written.store(index + 1, std::memory_order_release);
+}
+
+unsigned Telemetry::getLatest(const Channel p_channel, Sample* p_samples, const unsigned p_count, const std::uint64_t p_from) const
+{
+    const Ring& ring = m_rings[p_channel];
+    const std::uint64_t written = ring.written.load(std::memory_order_acquire);
+    const std::uint64_t first   = std::min(written, std::max(p_from, written - std::min<std::uint64_t>(written, p_count < CAPACITY ? p_count : CAPACITY)));
+
+    for (std::uint64_t i = first; i < written; ++i)
+    {
+        const Slot& slot = ring.slots[i % CAPACITY];
+        Sample& sample = p_samples[i - first];
+        sample.index = slot.index.load(std::memory_order_relaxed);
+        for (unsigned phase = 0; phase < PHASE_COUNT; ++phase)
+        {
+            sample.nanos[phase] = slot.nanos[phase].load(std::memory_order_relaxed);
+        }
+    }
+
+    // The slots of the samples committed meanwhile, and the one being written, may have been overwritten
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const std::uint64_t after = ring.written.load(std::memory_order_relaxed);
+    std::uint64_t valid = first;
+    if (after + 1 > first + CAPACITY)
+    {
+        valid = std::min(written, after + 1 - CAPACITY);
+    }
+    std::copy(p_samples + (valid - first), p_samples + (written - first), p_samples);
+    return (unsigned)(written - valid);
+}
+
+bool Telemetry::openCsv(const std::string& p_file)
+{
+    m_csv.open(p_file);
+    if (!m_csv.is_open())
+        return false;
+
+    m_csv << "channel,index";
+    for (unsigned phase = 0; phase < PHASE_COUNT; ++phase)
+    {
+        m_csv << ',' << getPhaseName((Phase)phase) << "_ns";
+    }
+    m_csv << '\n';
+    m_csvSamples.resize(CAPACITY);
+    return true;
+}
+
+void Telemetry::writeCsv()
+{
+    if (!m_csv.is_open())
+        return;
+
+    // Only the samples committed since the last call are copied
+    for (unsigned channel = 0; channel < CHANNEL_COUNT; ++channel)
+    {
+        Ring& ring = m_rings[channel];
+        const unsigned count = getLatest((Channel)channel, m_csvSamples.data(), CAPACITY, ring.csvWritten);
+        for (unsigned i = 0; i < count; ++i)
+        {
+            const Sample& sample = m_csvSamples[i];
+
+            // Samples overwritten before this call
+            m_dropped += sample.index - ring.csvWritten;
+            ring.csvWritten = sample.index + 1;
+
+            m_csv << (channel == FRAME ? "frame" : "generation") << ',' << sample.index;
+            for (unsigned phase = 0; phase < PHASE_COUNT; ++phase)
+            {
+                m_csv << ',';
+                if (getChannel((Phase)phase) == channel)
+                    m_csv << sample.nanos[phase];
+            }
+            m_csv << '\n';
+        }
+    }
+}
@@ -0,0 +1,203 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * \file telemetry.h
+ * \brief Definition of the timers measuring each phase of the frames and of the generations.
+ * \author lhm
+ */
+
+/*!
+ * \class Telemetry
+ * \brief Durations of the phases of the main loop (one sample per frame) and of the simulation
+ * thread (one sample per generation), kept in a ring buffer per channel.
+ * Each channel has a single writer thread, which never waits: a sample is written in its slot
+ * and then published by a counter. The readers (overlay, CSV file) copy the latest samples from
+ * any thread, discarding the ones overwritten during the copy.
+ * <ul>
+ * <li> Writer: time the phases with \a Timer (or \a add), then call \a commit once per sample
+ * <li> Reader: \a getLatest, or \a writeCsv to append the new samples to the CSV file
+ * </ul>
+ */
+class Telemetry
+{
+    public:
+        /*!
+         * \enum Phase
+         * \brief Timed phases. The neighbours are counted and the rules applied by the same
+         * kernels, so both are timed together by \a STEP.
+         */
+        enum Phase
+        {
+            INPUT,                                      /**< keyboard input and view move */
+            UPDATE,                                     /**< take of the latest generation */
+            COLOURS,                                    /**< colour writes of the visible region, and upload */
+            DRAW,                                       /**< draw calls and display */
+            EVENTS,                                     /**< events polling */
+            STEP,                                       /**< computation of a generation (neighbours and rules) */
+            PUBLISH,                                    /**< copy of a generation for the renderer */
+            PHASE_COUNT
+        };
+
+        /*!
+         * \enum Channel
+         * \brief Sources of the samples, each written by its own thread.
+         */
+        enum Channel
+        {
+            FRAME,                                      /**< main loop: \a INPUT to \a EVENTS */
+            GENERATION,                                 /**< simulation thread: \a STEP and \a PUBLISH */
+            CHANNEL_COUNT
+        };
+
+        static const unsigned CAPACITY = 1024;          /**< number of samples kept per channel (a power of 2) */
+
+        /*!
+         * \struct Sample
+         * \brief Durations of the phases of a frame or of a generation.
+         */
+        struct Sample
+        {
+            std::uint64_t index = 0;                    /**< number of the sample in its channel */
+            std::uint32_t nanos[PHASE_COUNT] = {};      /**< duration of each phase (ns) */
+        };
+
+        /*!
+         * \class Timer
+         * \brief Adds the time elapsed between its creation and its destruction to a phase.
+         * Does nothing without telemetry.
+         */
+        class Timer
+        {
+            public:
+                Timer(Telemetry* p_telemetry, const Phase p_phase)
+                    :   m_pTelemetry    (p_telemetry)
+                    ,   m_phase         (p_phase)
+                {
+                    if (m_pTelemetry)
+                        m_start = std::chrono::steady_clock::now();
+                }
+
+                ~Timer()
+                {
+                    if (m_pTelemetry)
+                        m_pTelemetry->add(m_phase, std::chrono::steady_clock::now() - m_start);
+                }
+
+                Timer               (const Timer& other)    = delete;
+                Timer& operator=    (const Timer& other)    = delete;
+
+            private:
+                Telemetry* const m_pTelemetry;          /**< telemetry (nullptr if disabled) */
+                const Phase m_phase;                    /**< phase timed */
+                std::chrono::steady_clock::time_point m_start;  /**< creation date */
+        };
+
+        Telemetry() = default;
+
+        /*!
+         * Copy constructor is prohibited.
+         */
+        Telemetry              (const Telemetry& other)   = delete;
+
+        /*!
+         * Assignment constructor is prohibited.
+         */
+        Telemetry& operator=   (const Telemetry& other)   = delete;
+
+        /*!
+         * \function getPhaseName
+         * \brief Returns the name of a phase, as written in the CSV file.
+         */
+        static const char* getPhaseName(const Phase p_phase);
+
+        /*!
+         * \function getChannel
+         * \brief Returns the channel a phase is timed on.
+         */
+        static Channel getChannel(const Phase p_phase) { return p_phase >= STEP ? GENERATION : FRAME; }
+
+        /*!
+         * \function add
+         * \brief Adds a duration to a phase of the current sample (writer thread of the channel only).
+         */
+        void add(const Phase p_phase, const std::chrono::steady_clock::duration p_duration);
+
+        /*!
+         * \function commit
+         * \brief Publishes the current sample of a channel, and starts the next one (writer thread only).
+         */
+        void commit(const Channel p_channel);
+
+        /*!
+         * Get the number of samples committed to a channel so far
+         */
+        std::uint64_t getCount(const Channel p_channel) const { return m_rings[p_channel].written.load(std::memory_order_acquire); }
+
+        /*!
+         * \function getLatest
+         * \brief Copies the latest samples of a channel, oldest first.
+         * \param p_channel the channel
+         * \param p_samples the copied samples
+         * \param p_count the maximum number of samples to copy
+         * \param p_from the number of the first sample to copy, if it is still kept (the older ones are skipped)
+         * \return the number of samples copied.
+         */
+        unsigned getLatest(const Channel p_channel, Sample* p_samples, const unsigned p_count, const std::uint64_t p_from = 0) const;
+
+        /*!
+         * \function openCsv
+         * \brief Creates the CSV file the samples are written to (see \a writeCsv).
+         * \return true if the file is open.
+         */
+        bool openCsv(const std::string& p_file);
+
+        /*!
+         * \function writeCsv
+         * \brief Appends to the CSV file the samples committed since the last call (from a single thread).
+         * The samples overwritten before being written are counted in \a getDropped.
+         */
+        void writeCsv();
+
+        /*!
+         * Get the number of samples overwritten before being written to the CSV file
+         */
+        std::uint64_t getDropped() const { return m_dropped; }
+
+    private:
+        /*!
+         * \struct Slot
+         * \brief Sample of a ring, read while it may be written.
+         */
+        struct Slot
+        {
+            std::atomic<std::uint64_t> index { 0 };     /**< number of the sample */
+            std::atomic<std::uint32_t> nanos[PHASE_COUNT];  /**< duration of each phase (ns) */
+        };
+
+        /*!
+         * \struct Ring
+         * \brief Ring buffer of the samples of a channel.
+         */
+        struct Ring
+        {
+            Slot slots[CAPACITY];                       /**< latest samples, the sample i in the slot i % CAPACITY */
+            std::atomic<std::uint64_t> written { 0 };   /**< number of samples committed */
+            std::uint64_t nanos[PHASE_COUNT] = {};      /**< current sample (writer thread only) */
+            std::uint64_t csvWritten = 0;               /**< number of samples handled by \a writeCsv */
+        };
+
+        Ring m_rings[CHANNEL_COUNT];                    /**< samples of each channel */
+        std::ofstream m_csv;                            /**< CSV file */
+        std::vector<Sample> m_csvSamples;               /**< samples copied by \a writeCsv, allocated once */
+        std::uint64_t m_dropped = 0;                    /**< samples lost by the CSV file */
+};
+
+#endif // TELEMETRY_H
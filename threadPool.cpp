@@ -0,0 +1,103 @@
+#include "threadPool.h"
+#include <algorithm>
+
+/**
+ * \file threadPool.cpp
+ * \brief Implementation of the functions defined in \a threadPool.h
+ * \author lhm
+ */
+
+namespace
+{
+    // Each thread gets several bands, so that a slower band does not stall the others
+    const unsigned BANDS_PER_THREAD = 4;
+}
+
+ThreadPool::ThreadPool(unsigned p_threads)
+    :   m_nextBand  (0)
+{
+    for (unsigned i = 1; i < p_threads; ++i)
+    {
+        m_threads.emplace_back(&ThreadPool::loop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::run(unsigned p_count, const Task& p_task)
+{
+    if (m_threads.empty() || p_count < 2)
+    {
+        p_task(0, p_count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        unsigned bands = std::min(p_count, getThreadCount() * BANDS_PER_THREAD);
+        m_task      = &p_task;
+        m_count     = p_count;
+        m_bandSize  = (p_count + bands - 1) / bands;
+        m_nextBand  = 0;
+        m_busy      = (unsigned)m_threads.size();
+        ++m_taskId;
+    }
+    m_wake.notify_all();
+
+    work();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]{ return m_busy == 0; });
+    m_task = nullptr;
+}
+
+void ThreadPool::work()
+{
+    for (;;)
+    {
+        unsigned begin = m_nextBand.fetch_add(1) * m_bandSize;
+        if (begin >= m_count)
+            return;
+
+        (*m_task)(begin, std::min(begin + m_bandSize, m_count));
+    }
+}
+
+void ThreadPool::loop()
+{
+    unsigned long lastTask = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&]{ return m_stop || m_taskId != lastTask; });
+            if (m_stop)
+                return;
+            lastTask = m_taskId;
+        }
+
+        work();
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            last = --m_busy == 0;
+        }
+        if (last)
+        {
+            m_done.notify_one();
+        }
+    }
+}
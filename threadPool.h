@@ -0,0 +1,94 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * \file threadPool.h
+ * \brief Definition of the pool of threads used to compute a generation on several cores.
+ * \author lhm
+ */
+
+/*!
+ * \class ThreadPool
+ * \brief Persistent threads sharing the rows of the grid.
+ * The threads are created once and wait for work between two generations, so that
+ * running a task costs no thread creation.
+ */
+class ThreadPool
+{
+    public:
+        /*!
+         * \brief Range task: called with the first and the past-the-end index of a band.
+         */
+        typedef std::function<void(unsigned, unsigned)> Task;
+
+        /*!
+         * \function ThreadPool
+         * \brief Creates the pool.
+         * \param p_threads the number of threads working on a task, the calling thread included.
+         */
+        explicit ThreadPool(unsigned p_threads);
+
+        /*!
+         * Joins the threads.
+         */
+        ~ThreadPool();
+
+        /*!
+         * Copy constructor is prohibited.
+         */
+        ThreadPool              (const ThreadPool& other)   = delete;
+
+        /*!
+         * Assignment constructor is prohibited.
+         */
+        ThreadPool& operator=   (const ThreadPool& other)   = delete;
+
+        /*!
+         * Get the number of threads working on a task, the calling thread included
+         */
+        unsigned getThreadCount() const { return (unsigned)m_threads.size() + 1; }
+
+        /*!
+         * \function run
+         * \brief Splits [0, p_count) in bands and runs the task on every band.
+         * Returns once every band has been processed.
+         * \param p_count the number of indexes (rows of the grid) to process
+         * \param p_task the task processing a band
+         */
+        void run(unsigned p_count, const Task& p_task);
+
+    private:
+        /*!
+         * \function work
+         * \brief Processes bands of the current task until there is no band left.
+         */
+        void work();
+
+        /*!
+         * \function loop
+         * \brief Main loop of the threads of the pool.
+         */
+        void loop();
+
+        std::vector<std::thread> m_threads;             /**< threads of the pool */
+        std::mutex m_mutex;                             /**< protects the task and the counters */
+        std::condition_variable m_wake;                 /**< signals a new task (or the end of the pool) */
+        std::condition_variable m_done;                 /**< signals the end of a task */
+
+        const Task* m_task = nullptr;                   /**< current task */
+        unsigned m_count = 0;                           /**< number of indexes of the current task */
+        unsigned m_bandSize = 1;                        /**< number of indexes in a band */
+        std::atomic<unsigned> m_nextBand;               /**< next band to process */
+        unsigned m_busy = 0;                            /**< number of threads still working on the task */
+        unsigned long m_taskId = 0;                     /**< identifier of the current task */
+        bool m_stop = false;                            /**< true when the pool is destroyed */
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,94 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \file transport.h
+ * \brief Definition of the interface exchanging the messages of a distributed simulation.
+ * \author lhm
+ */
+
+/*!
+ * \class Transport
+ * \brief Channels between the processes of a distributed simulation (see \a DomainWorker):
+ * the workers, each computing a band of rows of the grid, and the coordinator.
+ * A worker exchanges the rows of the edges of its band with the workers of the bands above and
+ * below, and its statistics and cells with the coordinator. The messages are streams of words:
+ * the words sent to a peer are received in the same order, but not necessarily in the same calls.
+ * Sending may wait until the peer received enough words, and receiving waits for the words.
+ * Each process uses its own endpoint: see \a ShmTransport for processes of one machine.
+ */
+class Transport
+{
+    public:
+        /*!
+         * \enum Peer
+         * \brief Peers of a worker.
+         */
+        enum Peer
+        {
+            ABOVE,                                      /**< worker of the band above */
+            BELOW,                                      /**< worker of the band below */
+            COORDINATOR                                 /**< coordinator of the simulation */
+        };
+
+        /*!
+         * Default destructor
+         */
+        virtual ~Transport() = default;
+
+        /*!
+         * Get the number of workers
+         */
+        virtual unsigned getWorkerCount() const = 0;
+
+        /*!
+         * \function send
+         * \brief Sends words from a worker to one of its peers.
+         * \param p_peer the peer
+         * \param p_words the words
+         * \param p_count the number of words
+         * \return false if the simulation was aborted.
+         */
+        virtual bool send(const Peer p_peer, const std::uint64_t* p_words, const std::size_t p_count) = 0;
+
+        /*!
+         * \function receive
+         * \brief Receives on a worker words sent by one of its peers.
+         * \param p_peer the peer
+         * \param p_words the words received
+         * \param p_count the number of words
+         * \return false if the simulation was aborted.
+         */
+        virtual bool receive(const Peer p_peer, std::uint64_t* p_words, const std::size_t p_count) = 0;
+
+        /*!
+         * \function sendTo
+         * \brief Sends words from the coordinator to a worker.
+         * \param p_worker the worker
+         * \param p_words the words
+         * \param p_count the number of words
+         * \return false if the simulation was aborted.
+         */
+        virtual bool sendTo(const unsigned p_worker, const std::uint64_t* p_words, const std::size_t p_count) = 0;
+
+        /*!
+         * \function receiveFrom
+         * \brief Receives on the coordinator words sent by a worker.
+         * \param p_worker the worker
+         * \param p_words the words received
+         * \param p_count the number of words
+         * \return false if the simulation was aborted.
+         */
+        virtual bool receiveFrom(const unsigned p_worker, std::uint64_t* p_words, const std::size_t p_count) = 0;
+
+        /*!
+         * \function abort
+         * \brief Aborts the simulation: the calls waiting on every process return false.
+         */
+        virtual void abort() = 0;
+};
+
+#endif // TRANSPORT_H
@@ -0,0 +1,91 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+/**
+ * \file tripleBuffer.h
+ * \brief Definition of a lock-free triple buffer, handing values from one thread to another.
+ * \author lhm
+ */
+
+/*!
+ * \class TripleBuffer
+ * \brief Lock-free hand-off of the latest value written by one thread to one reading thread.
+ * The writer fills the back buffer then publishes it, the reader takes the latest published
+ * buffer: neither of them ever waits for the other, and values published while the reader
+ * was busy are simply replaced by the newer ones.
+ * <ul>
+ * <li> Writer: fill \a getWriteBuffer, then call \a publish
+ * <li> Reader: call \a update, then read \a getReadBuffer
+ * </ul>
+ */
+template<typename T>
+class TripleBuffer
+{
+    public:
+        TripleBuffer() = default;
+
+        /*!
+         * Copy constructor is prohibited.
+         */
+        TripleBuffer              (const TripleBuffer& other)   = delete;
+
+        /*!
+         * Assignment constructor is prohibited.
+         */
+        TripleBuffer& operator=   (const TripleBuffer& other)   = delete;
+
+        /*!
+         * Get the buffer the writer fills (writer thread only)
+         */
+        T& getWriteBuffer() { return m_buffers[m_back]; }
+
+        /*!
+         * \function publish
+         * \brief Makes the write buffer the latest value, and gets a new write buffer (writer thread only).
+         */
+        void publish()
+        {
+            m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) & INDEX;
+        }
+
+        /*!
+         * \function isConsumed
+         * \brief Returns true if the reader took the latest published value (writer thread only).
+         */
+        bool isConsumed() const
+        {
+            return !(m_middle.load(std::memory_order_relaxed) & FRESH);
+        }
+
+        /*!
+         * \function update
+         * \brief Takes the latest published value, if any (reader thread only).
+         * \return true if the read buffer changed.
+         */
+        bool update()
+        {
+            if (!(m_middle.load(std::memory_order_relaxed) & FRESH))
+                return false;
+
+            m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX;
+            return true;
+        }
+
+        /*!
+         * Get the buffer the reader reads (reader thread only)
+         */
+        const T& getReadBuffer() const { return m_buffers[m_front]; }
+
+    private:
+        static const unsigned INDEX = 3;                /**< bits of the index of a buffer */
+        static const unsigned FRESH = 4;                /**< the middle buffer was not read yet */
+
+        T m_buffers[3];                                 /**< back, middle and front buffers */
+        unsigned m_back = 0;                            /**< buffer filled by the writer */
+        std::atomic<unsigned> m_middle { 1 };           /**< latest published buffer, and the FRESH flag */
+        unsigned m_front = 2;                           /**< buffer read by the reader */
+};
+
+#endif // TRIPLEBUFFER_H